@@ -0,0 +1,54 @@
+#!/bin/bash
+#	Comparison of the three-address and the stack (-s) expression backend
+#	Author: Patrik Goldschmidt
+#
+#	Usage: backend_bench.sh <compiler> <interpreter> <program>...
+#	Every program is compiled with both backends into the code directory and
+#	numbers of printed instructions are reported.  Programs are run by the
+#	interpreter, if it is available, and their run times are compared.
+#	Programs which are not compiled (error tests) are skipped, runs are
+#	limited by TIMEOUT seconds, because some tests loop on empty input.
+
+COMPILER=$1
+INTERPRET=$2
+shift 2
+TIMEOUT=5
+
+mkdir -p code
+
+# Prints run time of the code in seconds, or "-" without interpreter
+run_time()
+{
+	if ! command -v "$INTERPRET" > /dev/null 2>&1
+	then
+		echo "-"
+		return
+	fi
+
+	local start=$(date +%s.%N)
+	timeout $TIMEOUT "$INTERPRET" "$1" < /dev/null > /dev/null 2>&1
+	local end=$(date +%s.%N)
+	echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+printf "%-32s %8s %8s %8s %8s\n" "program" "code" "code -s" "time" "time -s"
+
+for program in "$@"
+do
+	# Test directory is a part of the name, tests are numbered per directory
+	name=$(basename "$(dirname "$program")")_$(basename "$program" .txt)
+	tac="code/$name.code"
+	stack="code/${name}_stack.code"
+
+	"$COMPILER" < "$program" > "$tac" 2> /dev/null || continue
+	"$COMPILER" -s < "$program" > "$stack" 2> /dev/null || continue
+
+	printf "%-32s %8d %8d %8s %8s\n" "$name" \
+	       $(grep -vc '^\.' "$tac") $(grep -vc '^\.' "$stack") \
+	       $(run_time "$tac") $(run_time "$stack")
+done | tee code/results.txt
+
+# Totals of the compiled programs
+awk '{ code += $2; stack += $3; time += $4; time_s += $5 }
+     END { printf "%-32s %8d %8d %8.3f %8.3f\n", "total", code, stack,
+           time, time_s }' code/results.txt
@@ -0,0 +1,53 @@
+#!/bin/bash
+#	Benchmark of the batch mode of the compiler
+#	Author: Patrik Goldschmidt
+#
+#	Usage: batch_bench.sh <compiler> <program>...
+#	Programs are copied ROUNDS times and compiled by a new process for every
+#	program, by a single batch process, by batches of 2 and 4 workers and
+#	as a stream on stdin.  Total times of the runs are printed.
+
+COMPILER=$1
+shift
+
+ROUNDS=5
+
+rm -rf code
+mkdir -p code
+
+index=0
+for ((round = 0; round < ROUNDS; round++))
+do
+	for program in "$@"
+	do
+		index=$((index + 1))
+		cp "$program" "code/$index.ifj"
+		printf "%d\n" $(wc -c < "$program") >> code/input.stream
+		cat "$program" >> code/input.stream
+	done
+done
+
+# Prints run time of the command in seconds
+run()
+{
+	local start=$(date +%s.%N)
+	"$@" > /dev/null 2>&1
+	local end=$(date +%s.%N)
+	echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+single()
+{
+	for program in code/*.ifj
+	do
+		"$COMPILER" -O < "$program" > "${program%.ifj}.code"
+	done
+}
+
+printf "%-24s %8s\n" "mode ($index programs)" "time"
+printf "%-24s %8s\n" "process per program" $(run single)
+printf "%-24s %8s\n" "-b" $(run "$COMPILER" -O -b code/*.ifj)
+printf "%-24s %8s\n" "-b -j 2" $(run "$COMPILER" -O -b -j 2 code/*.ifj)
+printf "%-24s %8s\n" "-b -j 4" $(run "$COMPILER" -O -b -j 4 code/*.ifj)
+printf "%-24s %8s\n" "-b (stream)" \
+	$(run "$COMPILER" -O -b < code/input.stream)
@@ -0,0 +1,83 @@
+#!/bin/bash
+#	Tests of the batch mode of the compiler
+#	Author: Patrik Goldschmidt
+#
+#	Usage: batch_test.sh <compiler> <program>...
+#	Programs are compiled one by one, by a single batch, by a batch of 3
+#	workers and as a stream on stdin, with and without -O.  Every batch
+#	has to produce the same code and exit codes as the single runs.
+
+COMPILER=$1
+shift
+programs=("$@")
+
+failed=0
+
+rm -rf code
+mkdir -p code/single code/batch
+
+# Copies programs with unique names, so their outputs do not collide
+index=0
+for program in "$@"
+do
+	index=$((index + 1))
+	cp "$program" "code/batch/$index.ifj"
+done
+
+for flags in "" "-O"
+do
+	expected=code/expected.stream
+	stream=code/input.stream
+	: > "$expected"
+	: > "$stream"
+
+	for ((i = 1; i <= index; i++))
+	do
+		"$COMPILER" $flags < "code/batch/$i.ifj" > "code/single/$i.code" \
+			2> /dev/null
+		echo $? > "code/single/$i.rc"
+		[ "$(cat code/single/$i.rc)" = 0 ] || : > "code/single/$i.code"
+
+		printf "%d\n" $(wc -c < "code/batch/$i.ifj") >> "$stream"
+		cat "code/batch/$i.ifj" >> "$stream"
+		printf "%d %d\n" $(cat "code/single/$i.rc") \
+			$(wc -c < "code/single/$i.code") >> "$expected"
+		cat "code/single/$i.code" >> "$expected"
+	done
+
+	for workers in 1 3
+	do
+		rm -f code/batch/*.code
+		"$COMPILER" -b -j $workers $flags code/batch/*.ifj \
+			2> code/batch.err > /dev/null
+
+		for ((i = 1; i <= index; i++))
+		do
+			if [ "$(cat code/single/$i.rc)" = 0 ]
+			then
+				cmp -s "code/single/$i.code" "code/batch/$i.code"
+			else
+				# Messages of the workers can share a line
+				[ ! -e "code/batch/$i.code" ] &&
+				grep -q "code/batch/$i.ifj: error $(cat code/single/$i.rc)\$" \
+					code/batch.err
+			fi
+
+			if [ $? != 0 ]
+			then
+				echo "FAIL - ${programs[i - 1]} (-b -j $workers $flags)"
+				failed=1
+			fi
+		done
+	done
+
+	"$COMPILER" -b $flags < "$stream" 2> /dev/null | cmp -s - "$expected"
+	if [ $? != 0 ]
+	then
+		echo "FAIL - stream ($flags)"
+		failed=1
+	fi
+done
+
+[ $failed = 0 ] && echo "OK - $index programs"
+exit $failed
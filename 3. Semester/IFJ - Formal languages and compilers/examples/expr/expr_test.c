@@ -0,0 +1,183 @@
+/**
+ *  @file expr_test.c
+ *  @brief Precedence table test for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ *  @date 17.10.2026
+ *  @author Tomas Danis - xdanis05@stud.fit.vutbr.cz
+ *
+ *  Program checks the precedence table of the expression parser against
+ *  the original comparison chains for every pair of the top terminal and
+ *  the input token ID, and measures the time of both look-ups over the
+ *  terminals appearing in expressions.
+ */
+
+#include "../../src/expr.h"
+#include "../../src/ilist.h"
+#include "../../src/scanner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief Lowest tested token ID.  */
+#define TEST_ID_MIN -8
+
+/** @brief Highest tested token ID, covers all IDs defined in the sources. */
+#define TEST_ID_MAX 1100
+
+/** @brief Number of repetitions of the expression terminals in time
+ *         measuring.  */
+#define TEST_BENCH_ROUNDS 100000
+
+/** @brief Number of the expression terminals.  */
+#define TEST_TERMINALS 18
+
+ilist_t instructs;            ///< Instruction list
+ilist_t global_var_ilist;     ///< Global variables list
+ilist_t *code_list;           ///< Currently generated list
+
+/** @brief Terminals appearing in expressions, used for time measuring. */
+static const int terminals[TEST_TERMINALS] =
+{
+   PLUS_ID, MINUS_ID, ASTERISK_ID, SLASH_ID, BACKSLASH_ID, EQUALS_ID,
+   NOT_EQUAL_ID, LESS_ID, LESS_EQUAL_ID, GREATER_ID, GREATER_EQUAL_ID,
+   ID_ID, INTEGER_LITERAL_ID, DOUBLE_LITERAL_ID, STRING_LITERAL_ID,
+   LEFT_BRACKET_ID, RIGHT_BRACKET_ID, EXPR_END_ID
+};
+
+/*
+ * Original consult_table() decision, with the error messages replaced by
+ * the error actions.
+ */
+static int reference_action(int topTerm, int input)
+{
+   if(input == PLUS_ID || input == MINUS_ID)
+   {
+      if(topTerm == PLUS_ID || topTerm == MINUS_ID || topTerm == ID_ID ||
+       topTerm == INTEGER_LITERAL_ID || topTerm == DOUBLE_LITERAL_ID ||
+       topTerm == STRING_LITERAL_ID || topTerm == RIGHT_BRACKET_ID ||
+       topTerm == ASTERISK_ID || topTerm == SLASH_ID ||
+       topTerm == BACKSLASH_ID)
+         return REDUCE_ACTION;
+      else
+         return RULE_START_SHIFT_ACTION;
+   }
+   else if(input == ASTERISK_ID || input == SLASH_ID)
+   {
+      if(topTerm == ASTERISK_ID || topTerm == SLASH_ID || topTerm == ID_ID ||
+       topTerm == INTEGER_LITERAL_ID || topTerm == DOUBLE_LITERAL_ID ||
+       topTerm == STRING_LITERAL_ID || topTerm == RIGHT_BRACKET_ID)
+         return REDUCE_ACTION;
+      else
+         return RULE_START_SHIFT_ACTION;
+   }
+   else if(input == BACKSLASH_ID)
+   {
+      if(topTerm == ASTERISK_ID || topTerm == SLASH_ID || 
+         topTerm == BACKSLASH_ID || topTerm == ID_ID || 
+         topTerm == INTEGER_LITERAL_ID || topTerm == DOUBLE_LITERAL_ID || 
+         topTerm == STRING_LITERAL_ID || topTerm == RIGHT_BRACKET_ID)
+         return REDUCE_ACTION;
+      else
+         return RULE_START_SHIFT_ACTION;
+   }
+   else if(input == EQUALS_ID || input == NOT_EQUAL_ID || 
+           input == GREATER_ID || input == GREATER_EQUAL_ID || 
+           input == LESS_ID || input == LESS_EQUAL_ID)
+   {
+      if(topTerm == LEFT_BRACKET_ID || topTerm == EXPR_END_ID)
+         return RULE_START_SHIFT_ACTION;
+      else if(topTerm == EQUALS_ID || topTerm == NOT_EQUAL_ID ||
+         topTerm == GREATER_ID || topTerm == GREATER_EQUAL_ID ||
+         topTerm == LESS_ID || topTerm == LESS_EQUAL_ID)
+         return CHAINING_ERROR_ACTION;
+      else
+         return REDUCE_ACTION;
+   }
+   else if(input == ID_ID || input == INTEGER_LITERAL_ID || 
+           input == DOUBLE_LITERAL_ID || input == STRING_LITERAL_ID || 
+           input == LEFT_BRACKET_ID)
+   {
+      if(topTerm == ID_ID || topTerm == INTEGER_LITERAL_ID ||
+       topTerm == DOUBLE_LITERAL_ID || topTerm == STRING_LITERAL_ID)
+         return MISSING_OPERATOR_ERROR_ACTION;
+      else
+         return RULE_START_SHIFT_ACTION;
+   }
+   else if(input == RIGHT_BRACKET_ID)
+   {
+      if(topTerm == LEFT_BRACKET_ID)
+         return SHIFT_ACTION;
+      else if(topTerm == EXPR_END_ID)
+         return END_ACTION;
+      else
+         return REDUCE_ACTION;
+   }
+   else if(input == EXPR_END_ID)
+   {
+      if(topTerm == LEFT_BRACKET_ID)
+         return UNMATCHED_BRACKET_ERROR_ACTION;
+      else
+         return REDUCE_ACTION;
+   }
+
+   return CONTINUATION_ERROR_ACTION;
+}
+
+/*
+ * Measures time of the look-up function over all pairs of the expression
+ * terminals.
+ */
+static double bench_action(int (*action)(int, int), long *checksum)
+{
+   clock_t start = clock();
+
+   for(int round = 0; round < TEST_BENCH_ROUNDS; round++)
+      for(int top = 0; top < TEST_TERMINALS; top++)
+         for(int input = 0; input < TEST_TERMINALS; input++)
+            *checksum += action(terminals[top], terminals[input]);
+
+   return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+   long pairs = 0;
+   long mismatches = 0;
+
+   for(int top = TEST_ID_MIN; top <= TEST_ID_MAX; top++)
+   {
+      for(int input = TEST_ID_MIN; input <= TEST_ID_MAX; input++)
+      {
+         int expected = reference_action(top, input);
+         int actual = table_action(top, input);
+
+         pairs++;
+         if(expected != actual)
+         {
+            mismatches++;
+            printf("Mismatch: top %d, input %d: expected %d, got %d\n",
+                   top, input, expected, actual);
+         }
+      }
+   }
+
+   printf("Checked %ld pairs of token IDs, %ld mismatches.\n", pairs,
+          mismatches);
+
+   long checksum_reference = 0;
+   long checksum_table = 0;
+   double time_reference = bench_action(reference_action, &checksum_reference);
+   double time_table = bench_action(table_action, &checksum_table);
+
+   printf("Comparison chains: %.3f s, table: %.3f s (%ld look-ups).\n",
+          time_reference, time_table,
+          (long)TEST_BENCH_ROUNDS * TEST_TERMINALS * TEST_TERMINALS);
+
+   if(mismatches != 0 || checksum_reference != checksum_table)
+   {
+      printf("FAILED\n");
+      return EXIT_FAILURE;
+   }
+
+   printf("OK\n");
+   return EXIT_SUCCESS;
+}
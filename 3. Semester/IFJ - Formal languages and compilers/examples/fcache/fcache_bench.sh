@@ -0,0 +1,79 @@
+#!/bin/bash
+#	Benchmark of the function cache of the compiler
+#	Author: Patrik Goldschmidt
+#
+#	Usage: fcache_bench.sh <compiler>
+#	Program with FUNCTIONS functions is compiled without the cache, with an
+#	empty cache, with the filled cache and with the filled cache after one
+#	of its functions was edited (differently in every round, so every run
+#	misses one entry).  Times of ROUNDS compilations are printed.
+
+COMPILER=$1
+
+FUNCTIONS=400
+ROUNDS=10
+
+rm -rf code
+mkdir -p code
+
+# Generates the program, $1 is added to the first function
+generate()
+{
+	for ((f = 0; f < FUNCTIONS; f++))
+	do
+		echo "function f$f(a as integer) as integer"
+		echo "dim i as integer"
+		echo "dim r as integer"
+		[ $f = 0 ] && echo "$1"
+		echo "for i = 1 to a"
+		echo "if i > $f then"
+		echo "r = r + i * $f - (a + $f) * 2"
+		echo "else"
+		echo "r = r - i + $f"
+		echo "end if"
+		echo "next"
+		echo "return r"
+		echo "end function"
+	done
+	echo "scope"
+	echo "print f0(3);"
+	echo "end scope"
+}
+
+# Prints time of ROUNDS compilations in seconds, %d in the name of the
+# input stands for the number of the round
+run()
+{
+	local input=$1
+	shift
+
+	local start=$(date +%s.%N)
+	for ((round = 0; round < ROUNDS; round++))
+	do
+		"$@" < "$(printf "$input" $round)" > /dev/null 2>&1
+	done
+	local end=$(date +%s.%N)
+	echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+# Compiles the program with an empty cache every time
+cold()
+{
+	rm -rf code/cache
+	"$COMPILER" -c code/cache
+}
+
+generate "" > code/program.ifj
+for ((round = 0; round < ROUNDS; round++))
+do
+	generate "r = a + $round" > "code/edited$round.ifj"
+done
+
+printf "%-24s %8s\n" "mode ($ROUNDS runs)" "time"
+printf "%-24s %8s\n" "no cache" $(run code/program.ifj "$COMPILER")
+printf "%-24s %8s\n" "empty cache" $(run code/program.ifj cold)
+"$COMPILER" -c code/cache < code/program.ifj > /dev/null
+printf "%-24s %8s\n" "filled cache" \
+	$(run code/program.ifj "$COMPILER" -c code/cache)
+printf "%-24s %8s\n" "one function edited" \
+	$(run "code/edited%d.ifj" "$COMPILER" -c code/cache)
@@ -0,0 +1,104 @@
+#!/bin/bash
+#	Tests of the function cache of the compiler
+#	Author: Patrik Goldschmidt
+#
+#	Usage: fcache_test.sh <compiler> <program>...
+#	Programs are compiled without the cache, with an empty cache and with
+#	the filled one, with all combinations of -O and -s.  Then a function of
+#	a program with several functions is edited, so its entry is missed and
+#	names of the following cached functions have to be moved.  Every run has
+#	to produce the same code and exit code as the run without the cache.
+
+COMPILER=$1
+shift
+
+failed=0
+count=0
+
+rm -rf code
+mkdir -p code
+
+# Compiles the program with the flags without and twice with the cache
+check()
+{
+	local program=$1
+	shift
+
+	"$COMPILER" "$@" < "$program" > code/expected.code 2> /dev/null
+	local expected=$?
+
+	for run in cold warm
+	do
+		"$COMPILER" "$@" -c code/cache < "$program" > "code/$run.code" \
+			2> /dev/null
+		if [ $? != $expected ] || ! cmp -s code/expected.code "code/$run.code"
+		then
+			echo "FAIL - $program ($run cache $*)"
+			failed=1
+		fi
+	done
+	count=$((count + 1))
+}
+
+# Program with loops, conditions and calls in every function, $1 is the
+# body of the first one
+program()
+{
+	cat << END
+declare function twice(n as integer) as integer
+dim shared calls as integer
+function first(a as integer) as integer
+dim x as integer
+$1
+return x
+end function
+function count(s as string) as integer
+dim i as integer
+dim r as integer
+for i = 1 to length(s)
+if asc(s, i) > 96 then
+r = r + 1
+elseif asc(s, i) > 64 then
+r = r + 2
+else
+r = r - 1
+end if
+next
+do while r > 10
+r = r - 3
+loop
+print substr(s, 1, 2);
+return r + twice(r)
+end function
+function twice(n as integer) as integer
+static c as integer
+c = c + n
+return c * 2
+end function
+scope
+dim k as integer
+k = count(!"Hello world") + first(3)
+print k;
+end scope
+END
+}
+
+for flags in "" "-O" "-s" "-O -s"
+do
+	rm -rf code/cache
+	for program in "$@"
+	do
+		check "$program" $flags
+	done
+
+	program "x = a * 2" > code/edit.ifj
+	check code/edit.ifj $flags
+	program "x = a * 2 + a * 3
+if x > 3 then
+x = x - 1
+end if" > code/edit.ifj
+	check code/edit.ifj $flags
+done
+
+[ $failed = 0 ] && echo "OK - $count compilations"
+exit $failed
@@ -0,0 +1,141 @@
+/**
+ * @file ilist_bench.c
+ * @brief Benchmark of instruction list for IFJ Project 2017.
+ * @date 17.10.2026
+ * @author Patrik Goldschmidt - xgolds00@fit.vutbr.cz
+ *
+ * Micro-benchmark of code generation back-end.  Program generates 1M
+ * instructions made of loops with variable definitions, hoists definitions
+ * out of the loops by order_ilist() and prints the code by
+ * instruction_print() to stdout, or to the file given as the second
+ * argument.  Times of the phases are reported to stderr, so the printed code
+ * can be redirected to /dev/null.
+ */
+
+#include "../../src/emit.h"
+#include "../../src/generator.h"
+#include "../../src/ilist.h"
+#include "../../src/intern.h"
+#include "../../src/safe_malloc.h"
+#include "../../src/scanner.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief Default number of generated instructions.  */
+#define BENCH_DEFAULT_COUNT 1000000
+
+/** @brief Number of instructions in the loop body.   */
+#define BENCH_LOOP_BODY 64
+
+ilist_t instructs;            ///< Instruction list
+ilist_t global_var_ilist;     ///< Global variables list
+ilist_t *code_list;           ///< Currently generated list
+
+/*
+ * Returns time in seconds.
+ */
+static double bench_time()
+{
+   return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*
+ * Returns variable operand.
+ */
+static token_t bench_var(char *name)
+{
+   token_t token = {0};
+
+   token.a.str = name;
+   token.type = INTEGER_ID;
+
+   return token;
+}
+
+/*
+ * Generates loop with its body, which defines variables.
+ */
+static long bench_loop(int depth)
+{
+   token_t label = {0};
+   token_t one = {0};
+   token_t var = bench_var("LF@x");
+   token_t tmp = bench_var("TF@T1");
+
+   one.type = INTEGER_ID;
+   one.is_const = true;
+   one.a.val_int = 1;
+
+   label.id = LOOP_BEGIN_ID;
+   label.type = depth;
+   label.a.str = "$loop_begin";
+   generate_instruction(code_list, LABEL_INS_ID, 1, label);
+
+   for(int i = 0; i < BENCH_LOOP_BODY / 2; i++)
+   {
+      generate_instruction(code_list, DEFVAR_INS_ID, 1, (i % 2) ? var : tmp);
+      generate_instruction(code_list, ADD_INS_ID, 3, one, var, var);
+   }
+
+   label.id = LOOP_END_ID;
+   label.a.str = "$loop_end";
+   generate_instruction(code_list, LABEL_INS_ID, 1, label);
+
+   return BENCH_LOOP_BODY + 2;
+}
+
+int main(int argc, char **argv)
+{
+   long count = BENCH_DEFAULT_COUNT;
+   long generated = 0;
+
+   if(argc > 1)
+      count = strtol(argv[1], NULL, 10);
+
+   if(count <= 0 || memman_init() != MEMMAN_SUCCESS ||
+      intern_init() != INTERN_SUCCESS)
+      return EXIT_FAILURE;
+
+   ilist_init(&instructs);
+   ilist_init(&global_var_ilist);
+   code_list = &instructs;
+
+   double start = bench_time();
+
+   generate_instruction(code_list, LABEL_MAIN, 0);
+
+   for(int depth = 0; generated < count; depth++)
+      generated += bench_loop(depth);
+
+   double generated_time = bench_time();
+
+   if(ilist_size(&instructs) != generated + 1)
+   {
+      fprintf(stderr, "Generated %d instructions instead of %ld!\n",
+              ilist_size(&instructs), generated + 1);
+      return EXIT_FAILURE;
+   }
+
+   order_ilist(&instructs);
+
+   double ordered_time = bench_time();
+
+   if(emit_open((argc > 2) ? argv[2] : NULL) != EMIT_SUCCESS)
+      return EXIT_FAILURE;
+   instruction_print(&instructs);
+   if(emit_close() != EMIT_SUCCESS)
+      return EXIT_FAILURE;
+
+   double end = bench_time();
+
+   fprintf(stderr, "%ld instructions: generate %.3f s, order %.3f s, "
+           "print %.3f s\n", generated, generated_time - start,
+           ordered_time - generated_time, end - ordered_time);
+
+   ilist_free(&instructs);
+   ilist_free(&global_var_ilist);
+   memman_free_all();
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#!/bin/bash
+#	Benchmark of string scanning loops compiled without and with -O
+#	Author: Patrik Goldschmidt
+#
+#	Usage: optimizer_bench.sh <compiler> <interpreter> <program>...
+#	Every program is compiled twice, number of printed instructions and
+#	instructions between the loop labels is reported.  Programs are run by
+#	the interpreter, if it is available, and their run times are compared.
+
+COMPILER=$1
+INTERPRET=$2
+shift 2
+
+# Counts instructions inside of the $LOOP_BEGIN_ and $LOOP_END_ labels
+loop_size()
+{
+	awk '/^LABEL \$LOOP_BEGIN_/ { depth++; next }
+	     /^LABEL \$LOOP_END_/ { depth--; next }
+	     depth > 0 { n++ }
+	     END { print n + 0 }' "$1"
+}
+
+# Prints run time of the code in seconds, or "-" without interpreter
+run_time()
+{
+	if ! command -v "$INTERPRET" > /dev/null 2>&1
+	then
+		echo "-"
+		return
+	fi
+
+	local start=$(date +%s.%N)
+	"$INTERPRET" "$1" < /dev/null > /dev/null
+	local end=$(date +%s.%N)
+	echo "$start $end" | awk '{ printf "%.3f", $2 - $1 }'
+}
+
+printf "%-20s %10s %10s %10s %10s %8s %8s\n" "program" "code" "code -O" \
+       "loops" "loops -O" "time" "time -O"
+
+for program in "$@"
+do
+	base=${program%.ifj}
+
+	"$COMPILER" < "$program" > "$base.code" || exit 1
+	"$COMPILER" -O < "$program" > "${base}_opt.code" 2> /dev/null || exit 1
+
+	printf "%-20s %10d %10d %10d %10d %8s %8s\n" "$program" \
+	       $(grep -vc '^\.' "$base.code") $(grep -vc '^\.' "${base}_opt.code") \
+	       $(loop_size "$base.code") $(loop_size "${base}_opt.code") \
+	       $(run_time "$base.code") $(run_time "${base}_opt.code")
+done
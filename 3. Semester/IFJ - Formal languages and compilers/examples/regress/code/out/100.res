@@ -0,0 +1 @@
+8 -1 8 2
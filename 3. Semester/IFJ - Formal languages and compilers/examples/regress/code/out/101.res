@@ -0,0 +1 @@
+11 11 513 82
@@ -0,0 +1 @@
+611 33 7 0 3.5 ...ab ab ...ab
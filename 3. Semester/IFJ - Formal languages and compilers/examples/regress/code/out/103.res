@@ -0,0 +1,4 @@
+6 2.5 9 1 2
+-85 14.25 22
+abc<abd 3.5>=3.5 eq
+5 4.75 8 8.125 13 13.1875 
@@ -0,0 +1,2 @@
+Zadejte cislo pro vypocet faktorialu? 
+Vysledek je:1
@@ -0,0 +1,5 @@
+9 13000
+42 4.1
+2 Hello Fucking World GENERUJEME BOHA
+true false true false true true
+true true falsetrueabc je vacsie ako dfg: false
\ No newline at end of file
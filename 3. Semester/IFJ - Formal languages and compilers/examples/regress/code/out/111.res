@@ -0,0 +1,6 @@
+abc is less than afg: true
+abc is less or equal than afg: true
+abc is equals afg: false
+abc is not equals afg: true
+abc is greater than afg: false
+abc is greater or equal than afg: false
@@ -0,0 +1 @@
+? Rejected
@@ -0,0 +1,3 @@
+545.645
+5451
+0
@@ -0,0 +1 @@
+ahoj, vypisujem cislo a: 5
\ No newline at end of file
@@ -0,0 +1,4 @@
+1 5 2.50443 2.67702
+2 9 4.18326 6.09594
+3 10 6.2863 11.3983
+80 70.6531 66.2918
@@ -0,0 +1,4 @@
+Toto je nejaky text
+Toto je nejaky text, ktery jeste trochu obohatime
+4 znaky od 16. znaku v "Toto je nejaky text, ktery jeste trochu obohatime":text
+Zadejte serazenou posloupnost vsech malych pismen a-h, pricemz se pismena nesmeji v posloupnosti opakovat? 
\ No newline at end of file
@@ -0,0 +1 @@
+hello worldno ok/128
\ No newline at end of file
@@ -0,0 +1,2 @@
+11
+0.00537109abcdef6
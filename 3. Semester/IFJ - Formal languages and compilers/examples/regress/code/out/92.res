@@ -0,0 +1 @@
+12117 192
@@ -0,0 +1,5 @@
+	b |b c\d|| c\d|||3
+9 92 0 9 AB
+7.5 10
+4
+4 2.5
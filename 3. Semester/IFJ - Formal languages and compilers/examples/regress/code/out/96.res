@@ -0,0 +1 @@
+1390 40
@@ -0,0 +1,2 @@
+? ? 6 1 0 0
+n=x 10 10
@@ -0,0 +1,2 @@
+46.3836 AaDbGcJdMePf 25
+-62.7 -68.1458
@@ -0,0 +1,5 @@
+6 65 121 0 A\y|z|"z|Q"|
+A\y" 2
+2 6 122
+65 A\ 92 A\y 121 A\y" 
+8 F
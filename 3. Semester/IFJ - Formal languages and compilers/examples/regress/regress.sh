@@ -0,0 +1,216 @@
+#!/bin/bash
+#	Parallel regression and performance tests of the compiler
+#	Author: Patrik Goldschmidt
+#
+#	Usage: regress.sh [-j jobs] [-r runs] [-t percent] [-b baseline] [-s]
+#	                  [-u] [-v interpreter] <compiler> <list>
+#	Every program of the list is compiled with its options by regress_run
+#	and its exit code is compared with the expected one.  Code of a program
+#	compiled without error is compared with golden/<program>.code.  With -v,
+#	the code is also run by the IFJcode17 interpreter with golden/<program>.in
+#	as input (or empty input) and its exit code and output are compared with
+#	golden/<program>.out, which starts by the "# exit N" line.  Programs
+#	without the .out file are not run.  Programs are divided among the jobs,
+#	one per core by default.
+#
+#	Shortest compile time of the runs and peak memory of every program are
+#	written to code/perf and compared with the baseline file, if it exists.
+#	Programs slower by more than the percentage (and by more than 2 ms) or
+#	using more memory by more than the percentage are reported as
+#	regressions.  Option -s stores code/perf as the baseline, option -u
+#	stores the outputs as the golden files, interpreter outputs of programs
+#	which do not stop in VM_TIMEOUT seconds are not stored.
+#
+#	Exits with 1 if a program failed or regressed.
+
+RUN=./regress_run
+GOLDEN=golden
+VM_TIMEOUT=5
+CC_TIMEOUT=10
+# Time differences under this number of microseconds are noise
+TIME_FLOOR=2000
+
+jobs=$(nproc 2> /dev/null || echo 1)
+runs=5
+tolerance=25
+baseline=
+save=0
+update=0
+interpreter=
+
+while getopts "j:r:t:b:suv:" option
+do
+	case $option in
+		j) jobs=$OPTARG ;;
+		r) runs=$OPTARG ;;
+		t) tolerance=$OPTARG ;;
+		b) baseline=$OPTARG ;;
+		s) save=1 ;;
+		u) update=1 ;;
+		v) interpreter=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# != 2 ]
+then
+	echo "Usage: $0 [-j jobs] [-r runs] [-t percent] [-b baseline] [-s]" \
+	     "[-u] [-v interpreter] <compiler> <list>" >&2
+	exit 2
+fi
+
+COMPILER=$1
+LIST=$2
+
+rm -rf code
+mkdir -p code/out code/results
+
+# Program, expected exit code and options of every test
+programs=()
+expected=()
+options=()
+while read -r program code flags
+do
+	case $program in
+		""|\#*) continue ;;
+	esac
+	programs+=("$program")
+	expected+=("$code")
+	options+=("$flags")
+done < "$LIST"
+
+# Name of the program in the golden directory and in the reports
+test_name()
+{
+	local name=$1
+
+	while [ "${name#../}" != "$name" ]
+	do
+		name=${name#../}
+	done
+	echo "$name"
+}
+
+# Compiles and checks the i-th program, writes its line of results
+run_test()
+{
+	local i=$1
+	local name=$(test_name "${programs[i]}")
+	local golden="$GOLDEN/$name"
+	local out="code/out/$i"
+	local message=
+	local status measured code time memory
+
+	# Options are split to words on purpose
+	measured=$($RUN "$runs" $CC_TIMEOUT "${programs[i]}" "$out.code" \
+	           "$COMPILER" ${options[i]})
+	status=$?
+	read -r code time memory <<< "$measured"
+
+	if [ $status != 0 ]
+	then
+		message="cannot run the compiler"
+	elif [ "$code" != "${expected[i]}" ]
+	then
+		message="exit code $code, expected ${expected[i]}"
+	elif [ "$code" = 0 ] && [ $update = 1 ]
+	then
+		mkdir -p "$(dirname "$golden")"
+		cp "$out.code" "$golden.code"
+	elif [ "$code" = 0 ] && ! cmp -s "$out.code" "$golden.code"
+	then
+		message="code differs from $golden.code"
+	fi
+
+	if [ -z "$message" ] && [ "$code" = 0 ] && [ -n "$interpreter" ] &&
+	   [ $update = 1 -o -f "$golden.out" ]
+	then
+		local input=/dev/null
+		[ -f "$golden.in" ] && input="$golden.in"
+
+		measured=$($RUN 1 $VM_TIMEOUT "$input" "$out.res" \
+		           "$interpreter" "$out.code")
+		read -r code _ <<< "$measured"
+		{ echo "# exit $code"; cat "$out.res"; } > "$out.out"
+
+		if [ $update = 1 ]
+		then
+			# Programs waiting for input forever are left out
+			if [ "$code" -lt 128 ]
+			then
+				cp "$out.out" "$golden.out"
+			else
+				rm -f "$golden.out"
+			fi
+		elif ! cmp -s "$out.out" "$golden.out"
+		then
+			message="interpreter output differs from $golden.out"
+		fi
+	fi
+
+	echo "$name ${time:-0} ${memory:-0} $message" > "code/results/$i"
+}
+
+# Programs are divided among the jobs by their indices
+for ((job = 0; job < jobs; job++))
+do
+	(
+		for ((i = job; i < ${#programs[@]}; i += jobs))
+		do
+			run_test $i
+		done
+	) &
+done
+wait
+
+failed=0
+regressed=0
+: > code/perf
+
+for ((i = 0; i < ${#programs[@]}; i++))
+do
+	read -r name time memory message < "code/results/$i"
+	echo "$name $time $memory" >> code/perf
+
+	if [ -n "$message" ]
+	then
+		echo "FAIL - $name: $message"
+		failed=$((failed + 1))
+	fi
+done
+
+if [ $save = 1 ] && [ -n "$baseline" ]
+then
+	cp code/perf "$baseline"
+elif [ -n "$baseline" ] && [ -f "$baseline" ]
+then
+	regressed=$(awk -v tolerance="$tolerance" -v floor="$TIME_FLOOR" '
+		NR == FNR { time[$1] = $2; memory[$1] = $3; next }
+		!($1 in time) { next }
+		$2 - time[$1] > floor && $2 > time[$1] * (100 + tolerance) / 100 {
+			printf "SLOWER - %s: %d us, baseline %d us\n", $1, $2, time[$1]
+			worse = 1
+		}
+		$3 > memory[$1] * (100 + tolerance) / 100 {
+			printf "LARGER - %s: %d kB, baseline %d kB\n", $1, $3, memory[$1]
+			worse = 1
+		}
+		{ n += worse; worse = 0 }
+		END { print n + 0 > "code/regressed" }' "$baseline" code/perf)
+	[ -n "$regressed" ] && echo "$regressed"
+	regressed=$(cat code/regressed)
+fi
+
+awk '{ time += $2; if($3 > memory) memory = $3 }
+     END { printf "compile time %.1f ms, peak memory %d kB\n",
+                  time / 1000, memory }' code/perf
+
+if [ $failed = 0 ] && [ "$regressed" = 0 ]
+then
+	echo "OK - ${#programs[@]} programs"
+	exit 0
+fi
+
+echo "$failed failed, $regressed regressed of ${#programs[@]} programs"
+exit 1
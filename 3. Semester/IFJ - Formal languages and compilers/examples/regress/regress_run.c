@@ -0,0 +1,132 @@
+/**
+ * @file regress_run.c
+ * @brief Measured run of a program for the regression tests of IFJ Project
+ *        2017.
+ * @date 17.10.2026
+ * @author Patrik Goldschmidt - xgolds00@fit.vutbr.cz
+ *
+ * Usage: regress_run <runs> <timeout> <input> <output> <program> [arg]...
+ *
+ * Runs the program the given number of times with stdin read from the input
+ * file, stdout written to the output file and stderr discarded.  Every run
+ * is killed after the timeout in seconds (0 for none).  Prints the exit code
+ * of the last run (128 + signal number for a killed program), the shortest
+ * wall time in microseconds and the peak resident set size in kilobytes of
+ * all runs to stdout.  Exits with 0 unless the program could not be run.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Exit code of a child which could not execute the program.  */
+#define RUN_EXEC_FAILED 127
+
+/*
+ * Returns monotonic time in microseconds.
+ */
+static long long run_time()
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (long long)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/*
+ * Redirects the descriptor to the file, returns -1 on error.
+ */
+static int run_redirect(int fd, const char *path, int flags)
+{
+   int file = open(path, flags, 0666);
+
+   if(file < 0)
+      return -1;
+   if(dup2(file, fd) < 0)
+   {
+      close(file);
+      return -1;
+   }
+
+   return close(file);
+}
+
+/*
+ * Runs the program once, returns its exit code or -1 if it was not started.
+ */
+static int run_once(char **argv, unsigned timeout, const char *input,
+                    const char *output)
+{
+   int status;
+   pid_t pid = fork();
+
+   if(pid < 0)
+      return -1;
+
+   if(pid == 0)
+   {
+      if(run_redirect(STDIN_FILENO, input, O_RDONLY) < 0 ||
+         run_redirect(STDOUT_FILENO, output, O_WRONLY | O_CREAT | O_TRUNC) < 0 ||
+         run_redirect(STDERR_FILENO, "/dev/null", O_WRONLY) < 0)
+         _exit(RUN_EXEC_FAILED);
+
+      /* Pending alarm is kept by exec, it kills the program by SIGALRM.  */
+      alarm(timeout);
+      execvp(argv[0], argv);
+      _exit(RUN_EXEC_FAILED);
+   }
+
+   if(waitpid(pid, &status, 0) < 0)
+      return -1;
+   if(WIFSIGNALED(status))
+      return 128 + WTERMSIG(status);
+
+   return WEXITSTATUS(status);
+}
+
+int main(int argc, char *argv[])
+{
+   struct rusage usage;
+   long long best = -1;
+   int runs;
+   int timeout;
+   int code = 0;
+
+   if(argc < 6 || (runs = atoi(argv[1])) < 1 || (timeout = atoi(argv[2])) < 0)
+   {
+      fprintf(stderr, "Usage: %s <runs> <timeout> <input> <output> "
+                      "<program> [arg]...\n", argv[0]);
+      return 1;
+   }
+
+   for(int i = 0; i < runs; i++)
+   {
+      long long start = run_time();
+      long long elapsed;
+
+      code = run_once(&argv[5], timeout, argv[3], argv[4]);
+      elapsed = run_time() - start;
+      if(code < 0)
+      {
+         perror(argv[5]);
+         return 1;
+      }
+
+      if(best < 0 || elapsed < best)
+         best = elapsed;
+   }
+
+   /* Resources of the waited children, ru_maxrss is their maximum.  */
+   getrusage(RUSAGE_CHILDREN, &usage);
+   printf("%d %lld %ld\n", code, best, usage.ru_maxrss);
+
+   return 0;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file safe_malloc_bench.c
+ * @brief Benchmark of safe malloc module for IFJ Project 2017.
+ * @date 17.10.2026
+ * @author Patrik Goldschmidt - xgolds00@fit.vutbr.cz
+ *
+ * Micro-benchmark, which allocates and frees given number of small objects
+ * (1M by default) through the memory management module.  Objects are freed
+ * in the allocation order, which is the worst case for linear search.
+ */
+
+#include "../../src/safe_malloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief Default number of allocated objects. */
+#define BENCH_DEFAULT_COUNT 1000000
+
+/** @brief Size of a single allocated object. */
+#define BENCH_OBJ_SIZ 16
+
+static double elapsed(clock_t start)
+{
+   return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[])
+{
+   long count = BENCH_DEFAULT_COUNT;
+
+   if(argc > 1)
+      count = strtol(argv[1], NULL, 10);
+
+   if(count <= 0 || memman_init() != MEMMAN_SUCCESS)
+      return EXIT_FAILURE;
+
+   void **objs = malloc(count * sizeof(void *));
+
+   if(objs == NULL)
+      return EXIT_FAILURE;
+
+   /* Allocate all objects. */
+   clock_t start = clock();
+
+   for(long i = 0; i < count; i++)
+      objs[i] = smalloc(BENCH_OBJ_SIZ);
+
+   printf("smalloc   %ld objects: %.3f s\n", count, elapsed(start));
+
+   /* Grow every object once. */
+   start = clock();
+
+   for(long i = 0; i < count; i++)
+      objs[i] = srealloc(objs[i], 2 * BENCH_OBJ_SIZ);
+
+   printf("srealloc  %ld objects: %.3f s\n", count, elapsed(start));
+
+   /* Free all objects in the allocation order. */
+   start = clock();
+
+   for(long i = 0; i < count; i++)
+      sfree(objs[i]);
+
+   printf("sfree     %ld objects: %.3f s\n", count, elapsed(start));
+
+   /* One-call teardown of the same number of objects. */
+   for(long i = 0; i < count; i++)
+      smalloc(BENCH_OBJ_SIZ);
+
+   start = clock();
+   memman_free_all();
+   printf("free_all  %ld objects: %.3f s\n", count, elapsed(start));
+
+   free(objs);
+
+   return EXIT_SUCCESS;
+}
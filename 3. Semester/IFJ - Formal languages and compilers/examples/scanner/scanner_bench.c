@@ -0,0 +1,162 @@
+/**
+ * @file scanner_bench.c
+ * @brief Benchmark of lexical analyzer for IFJ Project 2017.
+ * @date 17.10.2026
+ * @author Patrik Goldschmidt - xgolds00@fit.vutbr.cz
+ *
+ * Micro-benchmark of keyword and identifier lexing.  Program writes a source
+ * made of keywords mixed with identifiers to a temporary file, lexes it with
+ * get_next_token() and reports number of tokens per second.  It also checks
+ * every keyword is recognized with its proper ID, in any letter case.
+ */
+
+#include "../../src/intern.h"
+#include "../../src/safe_malloc.h"
+#include "../../src/scanner.h"
+#include "../../src/str.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief Default number of repetitions of the source line set.  */
+#define BENCH_DEFAULT_COUNT 200000
+
+/** @brief Number of keywords checked.  */
+#define KEYWORD_COUNT 38
+
+extern string_t str;
+
+/** @brief Keywords and their expected token IDs.  */
+static const struct
+{
+   const char *name;
+   int id;
+} keyword_ids[KEYWORD_COUNT] = {
+   {AND, AND_ID}, {AS, AS_ID}, {ASC, ASC_ID}, {BOOLEANN, BOOLEAN_ID},
+   {CHR, CHR_ID}, {CONTINUE, CONTINUE_ID}, {DECLARE, DECLARE_ID},
+   {DIM, DIM_ID}, {DO, DO_ID}, {DOUBLE, DOUBLE_ID}, {ELSE, ELSE_ID},
+   {ELSEIF, ELSEIF_ID}, {END, END_ID}, {EXIT, EXIT_ID}, {FALSEE, FALSE_ID},
+   {FOR, FOR_ID}, {FUNCTION, FUNCTION_ID}, {IF, IF_ID}, {INPUT, INPUT_ID},
+   {INTEGER, INTEGER_ID}, {LENGTH, LENGTH_ID}, {LOOP, LOOP_ID},
+   {NEXT, NEXT_ID}, {NOT, NOT_ID}, {OR, OR_ID}, {PRINT, PRINT_ID},
+   {RETURN, RETURN_ID}, {SCOPE, SCOPE_ID}, {SHARED, SHARED_ID},
+   {STATIC, STATIC_ID}, {STEP, STEP_ID}, {STRING, STRING_ID},
+   {SUBSTR, SUBSTR_ID}, {THEN, THEN_ID}, {TO, TO_ID}, {TRUEE, TRUE_ID},
+   {UNTIL, UNTIL_ID}, {WHILE, WHILE_ID},
+};
+
+/** @brief Identifiers similar to keywords, which must not match any.  */
+static const char *near_misses[] = {
+   "a", "ass", "andd", "dimm", "elsif", "forr", "funct", "iff", "integers",
+   "nxt", "scopes", "str", "strin", "tru", "untl", "whle", "x_1", "_",
+};
+
+/*
+ * Lexes the whole file and returns number of read tokens.
+ */
+static long lex_file(FILE *f)
+{
+   token_t token;
+   long count = 0;
+
+   rewind(f);
+
+   if(set_source_file(f) != SOURCE_SUCCESS)
+      return -1;
+
+   do
+   {
+      get_next_token(&token);
+      count++;
+   } while(token.id != EOF);
+
+   return count;
+}
+
+/*
+ * Lexes a single word, upper-cased if upper is set, and returns its token ID.
+ */
+static int lex_word(const char *word, int upper)
+{
+   FILE *f = tmpfile();
+   token_t token;
+
+   if(f == NULL)
+      return LEX_ERR_TOK_VAL;
+
+   for(const char *c = word; *c != '\0'; c++)
+      fputc(upper ? toupper(*c) : *c, f);
+
+   fputc('\n', f);
+   rewind(f);
+   set_source_file(f);
+   get_next_token(&token);
+   fclose(f);
+
+   return token.id;
+}
+
+int main(int argc, char *argv[])
+{
+   long count = BENCH_DEFAULT_COUNT;
+   int failures = 0;
+
+   if(argc > 1)
+      count = strtol(argv[1], NULL, 10);
+
+   if(count <= 0 || memman_init() != MEMMAN_SUCCESS ||
+      intern_init() != INTERN_SUCCESS || str_init(&str))
+      return EXIT_FAILURE;
+
+   /* Check keyword recognition.  */
+   for(int i = 0; i < KEYWORD_COUNT; i++)
+   {
+      if(lex_word(keyword_ids[i].name, 0) != keyword_ids[i].id ||
+         lex_word(keyword_ids[i].name, 1) != keyword_ids[i].id)
+      {
+         fprintf(stderr, "Keyword '%s' not recognized\n", keyword_ids[i].name);
+         failures++;
+      }
+   }
+
+   for(unsigned i = 0; i < sizeof(near_misses) / sizeof(*near_misses); i++)
+   {
+      if(lex_word(near_misses[i], 0) != ID_ID)
+      {
+         fprintf(stderr, "Identifier '%s' taken as keyword\n", near_misses[i]);
+         failures++;
+      }
+   }
+
+   /* Write benchmark source - every keyword followed by an identifier.  */
+   FILE *f = tmpfile();
+
+   if(f == NULL)
+      return EXIT_FAILURE;
+
+   for(long i = 0; i < count; i++)
+   {
+      for(int j = 0; j < KEYWORD_COUNT; j++)
+         fprintf(f, "%s Var_%d%s ", keyword_ids[j].name, j, 
+                 near_misses[j % (sizeof(near_misses) / sizeof(*near_misses))]);
+
+      fputc('\n', f);
+   }
+
+   /* Lex the source.   */
+   clock_t start = clock();
+   long tokens = lex_file(f);
+   double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   printf("Lexed %ld tokens in %.3f s (%.1f Mtokens/s)\n", tokens, secs,
+          secs > 0 ? tokens / secs / 1e6 : 0.0);
+
+   fclose(f);
+   memman_free_all();
+
+   if(failures)
+      printf("%d keyword check(s) failed\n", failures);
+
+   return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file symtable_bench.c
+ * @brief Benchmark of symbol table for IFJ Project 2017.
+ * @date 17.10.2026
+ * @author Patrik Goldschmidt - xgolds00@fit.vutbr.cz
+ *
+ * Micro-benchmark simulating the parser workload on synthetic programs with
+ * 10k and 100k symbols.  Global table is filled with functions, which are
+ * then looked up repeatedly.  Local table gets variables declared in nested
+ * blocks, which are taken back by scope rollback at every block exit.  All
+ * results are checked, so the benchmark also serves as a regression test.
+ */
+
+#include "../../src/intern.h"
+#include "../../src/safe_malloc.h"
+#include "../../src/symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** @brief Number of lookups of every global symbol.  */
+#define BENCH_LOOKUPS 10
+
+/** @brief Number of variables declared in every block.  */
+#define BENCH_BLOCK_VARS 8
+
+/** @brief Nesting depth of the blocks.  */
+#define BENCH_BLOCK_DEPTH 4
+
+/*
+ * Returns time in seconds.
+ */
+static double bench_time()
+{
+   return (double)clock() / CLOCKS_PER_SEC;
+}
+
+/*
+ * Interns "<prefix><number>" the way scanner does it.
+ */
+static char *bench_name(const char *prefix, int number)
+{
+   char buffer[32];
+
+   snprintf(buffer, sizeof(buffer), "%s%d", prefix, number);
+
+   return intern_cstring(buffer);
+}
+
+/*
+ * Fills global table with functions and looks them up.
+ */
+static int bench_global(int count, char **names)
+{
+   symtab_t tab;
+   symbol_t symbol = {0};
+   double start = bench_time();
+
+   stab_init(&tab);
+
+   for(int i = 0; i < count; i++)
+   {
+      symbol.id = names[i];
+      symbol.type = i;
+
+      if(stab_insert(&tab, &symbol) != STAB_INSERT_OK)
+         return EXIT_FAILURE;
+   }
+
+   double inserted = bench_time();
+
+   for(int j = 0; j < BENCH_LOOKUPS; j++)
+   {
+      for(int i = 0; i < count; i++)
+      {
+         symbol_t *found = stab_get_data(&tab, names[i]);
+
+         if(found == NULL || found->type != i)
+         {
+            fprintf(stderr, "Symbol '%s' not found!\n", names[i]);
+            return EXIT_FAILURE;
+         }
+      }
+   }
+
+   double end = bench_time();
+
+   printf("%7d symbols: insert %6.1f ns/op, lookup %6.1f ns/op\n", count,
+          1e9 * (inserted - start) / count,
+          1e9 * (end - inserted) / ((double)count * BENCH_LOOKUPS));
+
+   stab_clear(&tab);
+
+   return EXIT_SUCCESS;
+}
+
+/*
+ * Declares variables in nested blocks and leaves the blocks again.
+ */
+static int bench_blocks(symtab_t *tab, char **names, int depth, int *base)
+{
+   stab_mark_t mark = stab_scope_mark(tab);
+   symbol_t symbol = {0};
+
+   for(int i = 0; i < BENCH_BLOCK_VARS; i++)
+   {
+      symbol.id = names[*base + i];
+
+      if(stab_insert(tab, &symbol) != STAB_INSERT_OK ||
+         stab_scope_log(tab, symbol.id) != STAB_INSERT_OK)
+         return EXIT_FAILURE;
+   }
+
+   *base += BENCH_BLOCK_VARS;
+
+   if(depth > 1 && bench_blocks(tab, names, depth - 1, base) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+
+   /* Leave the block, table must forget exactly its variables.  */
+   symbol_t *removed;
+   int removed_count = 0;
+
+   while((removed = stab_scope_rollback(tab, mark)) != NULL)
+   {
+      stab_delete_symbol(tab, removed->id);
+      removed_count++;
+   }
+
+   return (removed_count == BENCH_BLOCK_VARS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Runs nested blocks in a local table already containing count symbols.
+ */
+static int bench_local(int count, char **names, char **vars)
+{
+   symtab_t tab;
+   symbol_t symbol = {0};
+   int blocks = count / (BENCH_BLOCK_VARS * BENCH_BLOCK_DEPTH);
+
+   stab_init(&tab);
+
+   for(int i = 0; i < count; i++)
+   {
+      symbol.id = names[i];
+
+      if(stab_insert(&tab, &symbol) != STAB_INSERT_OK)
+         return EXIT_FAILURE;
+   }
+
+   double start = bench_time();
+
+   for(int i = 0; i < blocks; i++)
+   {
+      int base = 0;
+
+      if(bench_blocks(&tab, vars, BENCH_BLOCK_DEPTH, &base) != EXIT_SUCCESS ||
+         tab.count != (unsigned int)count)
+      {
+         fprintf(stderr, "Scope rollback failed!\n");
+         return EXIT_FAILURE;
+      }
+   }
+
+   double end = bench_time();
+
+   printf("%7d symbols: block enter + %d declarations + exit %6.1f ns\n",
+          count, BENCH_BLOCK_VARS, 1e9 * (end - start) / 
+          ((double)blocks * BENCH_BLOCK_DEPTH));
+
+   stab_clear(&tab);
+
+   return EXIT_SUCCESS;
+}
+
+int main()
+{
+   const int counts[] = {10000, 100000};
+   char *vars[BENCH_BLOCK_VARS * BENCH_BLOCK_DEPTH];
+
+   if(memman_init() != MEMMAN_SUCCESS || intern_init() != INTERN_SUCCESS)
+      return EXIT_FAILURE;
+
+   for(int i = 0; i < BENCH_BLOCK_VARS * BENCH_BLOCK_DEPTH; i++)
+      vars[i] = bench_name("v", i);
+
+   for(unsigned int c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+   {
+      char **names = smalloc(counts[c] * sizeof(char *));
+
+      if(names == NULL)
+         return EXIT_FAILURE;
+
+      for(int i = 0; i < counts[c]; i++)
+         names[i] = bench_name("f", i);
+
+      if(bench_global(counts[c], names) != EXIT_SUCCESS ||
+         bench_local(counts[c], names, vars) != EXIT_SUCCESS)
+      {
+         memman_free_all();
+         return EXIT_FAILURE;
+      }
+
+      sfree(names);
+   }
+
+   memman_free_all();
+
+   return EXIT_SUCCESS;
+}
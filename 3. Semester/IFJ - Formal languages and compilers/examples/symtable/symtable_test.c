@@ -7,6 +7,8 @@
  *  Module tests symbol tab library functions for a compiler project AT vutbr.
  */
 
+#include "../../src/intern.h"
+#include "../../src/safe_malloc.h"
 #include "../../src/symtable.h"
 #include <stdbool.h>
 #include <stdio.h>
@@ -20,6 +22,9 @@ int main()
     char *sym_id_dynamic = calloc(20, sizeof(char));
     symbol_t symb;
 
+    if(memman_init() != MEMMAN_SUCCESS || intern_init() != INTERN_SUCCESS)
+        return EXIT_FAILURE;
+
     printf("--------------------  Fresh table test:  ---------------------\n");
     /*  Create and initialize table.   */
     symtab_t symbols;
@@ -104,34 +109,23 @@ int main()
 
     /*  Free dynamically allocated string.  */
     free(sym_id_dynamic);
+    memman_free_all();
 
     return EXIT_SUCCESS;
 }
 
 void print_stab(symtab_t *tab)
 {
-    stab_item_t *item;
-    bool printed = false;
+    stab_iterator_t it;
 
-    for(int i = 0; i < SYMTAB_SIZE; i++)
+    if(stab_iterate_set(tab, &it) != SYMTAB_ITERATOR_SET)
     {
-        item = (*tab)[i];
-
-        if((*tab)[i])
-            printf("[%d]: ", i);
-
-        for(; item; item = item->item_next)
-        {
-            printed = true;
-            printf("\"%s\" --> ", item->data.id);
-        }
-
-        if((*tab)[i])
-            printf("NULL\n");
+        printf("Table is empty.\n");
+        return;
     }
 
-    if(!printed)
-        printf("Table is empty.\n");
+    for(; it.item; stab_iterate_next(tab, &it))
+        printf("[%d]: \"%s\"\n", it.row - 1, it.item->data.id);
 
     return;
 }
@@ -141,32 +141,23 @@ int main()
    /* Free stack and check. */
    tstack_free(&tokenst);
 
-   printf("Stack bottom\t\t: \t %p\n", (void *) tokenst.bot);
-   printf("Stack top\t\t: \t %p\n", (void *) tokenst.top);
-   printf("Stack top terminal\t: \t %p\n", (void *) tokenst.top_term);
+   printf("Stack items\t\t: \t %p\n", (void *) tokenst.items);
+   printf("Stack top\t\t: \t %d\n", tokenst.top);
+   printf("Stack top terminal\t: \t %d\n", tokenst.top_term);
 
    return EXIT_SUCCESS;
 }
 
 void tstack_print(tstack *tst)
 {
-   titem *tmp = tst->bot;
+   for(int i = 0; i < tst->top; i++)
+      printf("%d -> ", tst->items[i].data.id);
 
-   while(tmp != tst->top)
-   {
-      printf("%d -> ", tmp->data.id);
-      tmp = tmp->next;
-   }
-
-   printf("%d -> END\n", tmp->data.id);
+   printf("%d -> END\n", tst->items[tst->top].data.id);
 }
 
 int tstack_count_alloc(tstack *tst)
 {
-   int count = 0;
-
-   for(titem *tmp = tst->bot->next; tmp != NULL; tmp = tmp->next)
-      count++;
-
-   return count;
+   /* Sentinel item is not counted.   */
+   return tst->size - 1;
 }
@@ -0,0 +1,40 @@
+#!/bin/bash
+#	Benchmark of optimizer passes and expression backends on the virtual
+#	machine
+#	Author: Patrik Goldschmidt
+#
+#	Usage: vm_bench.sh <compiler> <vm> <program>...
+#	Every program is compiled without options, with -O, with -s and with
+#	-s -O.  Compiled programs are run by the virtual machine, which reports
+#	the number of executed instructions, and their run times are measured.
+
+COMPILER=$1
+VM=$2
+shift 2
+
+mkdir -p code
+
+# Prints number of executed instructions and run time in seconds
+run()
+{
+	local start=$(date +%s.%N)
+	local steps=$("$VM" -c "$1" < /dev/null 2>&1 > /dev/null |
+	              sed -n 's/^steps //p')
+	local end=$(date +%s.%N)
+	echo "$steps $start $end" | awk '{ printf "%d %.3f", $1, $3 - $2 }'
+}
+
+printf "%-20s %-6s %12s %8s\n" "program" "flags" "executed" "time"
+
+for program in "$@"
+do
+	name=$(basename "$program" .ifj)
+
+	for flags in "" "-O" "-s" "-s -O"
+	do
+		code="code/$name$(echo $flags | tr -d ' -').code"
+
+		"$COMPILER" $flags < "$program" > "$code" 2> /dev/null || continue
+		printf "%-20s %-6s %12d %8s\n" "$name" "${flags:--}" $(run "$code")
+	done
+done
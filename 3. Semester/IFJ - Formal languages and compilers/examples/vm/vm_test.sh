@@ -0,0 +1,36 @@
+#!/bin/bash
+#	Tests of the IFJcode17 virtual machine
+#	Author: Patrik Goldschmidt
+#
+#	Usage: vm_test.sh <vm> <program>...
+#	Every program is run with its .in file as input (or empty input) and its
+#	output is compared with the .out file.  Expected exit code is given by
+#	the "# exit N" comment on the first line of the program.
+
+VM=$1
+shift
+
+failed=0
+
+for program in "$@"
+do
+	base=${program%.ifjc}
+	input=/dev/null
+	[ -f "$base.in" ] && input="$base.in"
+	expected=$(sed -n '1s/^# exit //p' "$program")
+
+	"$VM" "$program" < "$input" > "$base.res" 2> /dev/null
+	code=$?
+
+	if [ "$code" = "$expected" ] && cmp -s "$base.res" "$base.out"
+	then
+		echo "OK     $program"
+	else
+		echo "FAILED $program (exit code $code, expected $expected)"
+		failed=$((failed + 1))
+	fi
+	rm -f "$base.res"
+done
+
+echo "$failed of $# tests failed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,99 @@
+#!/bin/bash
+#	Scaling benchmark of the compiler on generated programs
+#	Author: Patrik Goldschmidt
+#
+#	Usage: workload_bench.sh <compiler> <generator> <runner> <option>
+#	                         <values> [generator option]...
+#	For every value, a program is generated with the option set to the value
+#	and the other generator options, and compiled by the runner of the
+#	regression tests.  Size of the program, the shortest compile time of RUNS
+#	runs and peak memory are written to code/workload.dat and plotted by bars.
+#	Growth is the exponent of the time between the previous and the current
+#	size, about 1 for linear and 2 for quadratic parts of the compiler.
+#	Plot is also drawn to code/workload.png, if gnuplot is installed.
+
+COMPILER=$1
+GENERATOR=$2
+RUNNER=$3
+OPTION=$4
+VALUES=$5
+shift 5
+
+RUNS=3
+# Width of the longest bar
+WIDTH=40
+
+rm -rf code
+mkdir -p code
+
+echo "# $OPTION bytes time_ms memory_kB" > code/workload.dat
+for value in $VALUES
+do
+	program="code/program$value.ifj"
+
+	"$GENERATOR" "$@" "$OPTION" "$value" > "$program" || exit 1
+	read -r code time memory <<< \
+		"$("$RUNNER" $RUNS 0 "$program" /dev/null "$COMPILER")"
+	if [ "$code" != 0 ]
+	then
+		echo "Program $program failed with exit code $code"
+		exit 1
+	fi
+
+	echo "$value $(wc -c < "$program") $(awk -v t="$time" \
+		'BEGIN { printf "%.2f", t / 1000 }') $memory" >> code/workload.dat
+done
+
+awk -v width=$WIDTH -v option="$OPTION" '
+	# Bar of the value scaled to the maximum
+	function bar(x, max,    len, s) {
+		len = (max > 0) ? int(x / max * width + 0.5) : 0
+		for(s = ""; len > 0; len--)
+			s = s "#"
+		return s
+	}
+	BEGIN { n = 0 }
+	/^#/ { next }
+	{
+		value[n] = $1; size[n] = $2; time[n] = $3; memory[n] = $4
+		if($3 > max_time) max_time = $3
+		if($4 > max_memory) max_memory = $4
+		n++
+	}
+	END {
+		printf "%-8s %10s %10s %7s %10s\n", option, "bytes", "time ms",
+		       "growth", "memory kB"
+		for(i = 0; i < n; i++)
+		{
+			growth = "-"
+			if(i > 0 && time[i - 1] > 0 && time[i] > 0 && size[i] > size[i - 1])
+			{
+				ratio = log(size[i] / size[i - 1])
+				growth = sprintf("%.2f", log(time[i] / time[i - 1]) / ratio)
+			}
+			printf "%-8s %10d %10.2f %7s %10d\n", value[i], size[i], time[i],
+			       growth, memory[i]
+		}
+		print "\ncompile time"
+		for(i = 0; i < n; i++)
+			printf "%10d |%s\n", size[i], bar(time[i], max_time)
+		print "\npeak memory"
+		for(i = 0; i < n; i++)
+			printf "%10d |%s\n", size[i], bar(memory[i], max_memory)
+	}' code/workload.dat
+
+if command -v gnuplot > /dev/null 2>&1
+then
+	gnuplot <<- EOF
+		set terminal png size 900,400
+		set output "code/workload.png"
+		set multiplot layout 1,2
+		set xlabel "program size [bytes]"
+		set ylabel "compile time [ms]"
+		plot "code/workload.dat" using 2:3 with linespoints notitle
+		set ylabel "peak memory [kB]"
+		plot "code/workload.dat" using 2:4 with linespoints notitle
+		unset multiplot
+	EOF
+	echo "Plot drawn to code/workload.png"
+fi
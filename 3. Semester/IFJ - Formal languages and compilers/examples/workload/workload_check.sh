@@ -0,0 +1,87 @@
+#!/bin/bash
+#	Differential test of the compiler modes on generated programs
+#	Author: Patrik Goldschmidt
+#
+#	Usage: workload_check.sh <compiler> <interpreter> <generator> <seeds>
+#	                         [generator option]...
+#	For every seed, a program is generated with the other generator options
+#	and compiled in every mode of MODES.  Code of every mode is run by the
+#	IFJcode17 interpreter with empty input.  Compilation and run of the
+#	plain mode have to succeed and every other mode has to give the same
+#	exit code and output.  Programs of failed seeds are kept in code/check/.
+#
+#	Exits with 1 if a program failed in any mode.
+
+COMPILER=$1
+INTERPRETER=$2
+GENERATOR=$3
+SEEDS=$4
+shift 4
+
+# Options of the compared modes, the first one is the reference
+MODES=("" "-O" "-O -i 0" "-O -i 32" "-s" "-O -s")
+VM_TIMEOUT=10
+DIR=code/check
+
+rm -rf $DIR
+mkdir -p $DIR
+
+# Compiles the program in the mode and runs it, prints the exit code of the
+# compiler or of the interpreter and the output
+run_mode()
+{
+	local program=$1
+	local mode=$2
+
+	if ! "$COMPILER" $mode < "$program" > $DIR/check.code 2> /dev/null
+	then
+		echo "compiler failed"
+		return
+	fi
+	timeout $VM_TIMEOUT "$INTERPRETER" $DIR/check.code < /dev/null \
+		2> /dev/null
+	echo "# exit $?"
+}
+
+failed=0
+count=0
+for seed in $SEEDS
+do
+	program="$DIR/program$seed.ifj"
+
+	"$GENERATOR" "$@" -r "$seed" > "$program" || exit 1
+	count=$((count + 1))
+	reference=$(run_mode "$program" "${MODES[0]}")
+
+	if [ "$(tail -n 1 <<< "$reference")" != "# exit 0" ]
+	then
+		echo "FAIL   $program: $(tail -n 1 <<< "$reference") without options"
+		failed=$((failed + 1))
+		continue
+	fi
+
+	ok=1
+	for mode in "${MODES[@]:1}"
+	do
+		if [ "$(run_mode "$program" "$mode")" != "$reference" ]
+		then
+			echo "FAIL   $program: output with $mode differs"
+			ok=0
+		fi
+	done
+
+	if [ $ok = 1 ]
+	then
+		rm -f "$program"
+	else
+		failed=$((failed + 1))
+	fi
+done
+rm -f $DIR/check.code
+
+if [ $failed != 0 ]
+then
+	echo "FAILED - $failed of $count programs"
+	exit 1
+fi
+echo "OK - $count programs, ${#MODES[@]} modes"
@@ -0,0 +1,325 @@
+/**
+ * @file workload_gen.c
+ * @brief Generator of synthetic IFJ17 programs for IFJ Project 2017.
+ * @date 17.10.2026
+ * @author Patrik Goldschmidt - xgolds00@fit.vutbr.cz
+ *
+ * Usage: workload_gen [-f functions] [-d depth] [-e length] [-s strings]
+ *                     [-S length] [-l percent] [-b statements] [-r seed]
+ *
+ * Prints a valid IFJ17 program to stdout.  Every function has a body of
+ * blocks nested up to the given depth, every block has the given number of
+ * statements with expressions of the given number of operands, the given
+ * number of statements concatenating string literals of the given length
+ * and one nested block.  Nested block is a loop with the given probability
+ * in percent, a condition with ElseIf and Else branches otherwise.  Every
+ * function calls the previous one once and the main body calls the last
+ * one, so the program can also be run.  Loops run twice, run time of a
+ * function therefore grows with 2^depth only.  Calls of functions take terms
+ * only and stand alone on the right side of an assignment, as IFJ17
+ * requires.  The same options and seed always give the same program.
+ */
+
+/* getopt() is POSIX.  */
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/** @brief Default number of functions.  */
+#define GEN_DEFAULT_FUNCTIONS 10
+
+/** @brief Default depth of nested blocks.  */
+#define GEN_DEFAULT_DEPTH 3
+
+/** @brief Default number of operands of an expression.  */
+#define GEN_DEFAULT_EXPR_LEN 4
+
+/** @brief Default number of string statements in a block.  */
+#define GEN_DEFAULT_STRINGS 1
+
+/** @brief Default length of string literals.  */
+#define GEN_DEFAULT_STRING_LEN 16
+
+/** @brief Default probability of loops in percent.  */
+#define GEN_DEFAULT_LOOPS 50
+
+/** @brief Default number of statements in a block.  */
+#define GEN_DEFAULT_STATEMENTS 4
+
+/** @brief Strings are cut to this length, so loops do not grow them.  */
+#define GEN_STRING_MAX 64
+
+/** @brief Maximal depth of nested blocks.  */
+#define GEN_MAX_DEPTH 64
+
+/** @brief Settings of the generated program.  */
+typedef struct gen_config
+{
+   int functions;                   ///< Number of functions
+   int depth;                       ///< Depth of nested blocks
+   int expr_len;                    ///< Number of operands of expressions
+   int strings;                     ///< String statements in a block
+   int string_len;                  ///< Length of string literals
+   int loops;                       ///< Probability of loops in percent
+   int statements;                  ///< Statements in a block
+} gen_config_t;
+
+/** @brief State of the random generator.  */
+static unsigned long long gen_state;
+
+/** @brief Counters of the loops around the generated statement.  */
+static int gen_loops[GEN_MAX_DEPTH];
+static int gen_loop_count = 0;
+
+/*
+ * Returns random number from 0 to n - 1.  Own generator gives the same
+ * programs with every C library.
+ */
+static int gen_random(int n)
+{
+   gen_state = gen_state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+   return (int)((gen_state >> 33) % (unsigned long long)n);
+}
+
+static void gen_indent(int level)
+{
+   for(int i = 0; i < level; i++)
+      putchar('\t');
+}
+
+/*
+ * Prints integer operand.  Only counters of the loops around are read, a
+ * For loop gives its counter a new name in the compiler, which is not set
+ * in the other branches.
+ */
+static void gen_int_operand()
+{
+   switch(gen_random(5))
+   {
+      case 0:
+         printf("a");
+         break;
+      case 1:
+         if(gen_loop_count > 0)
+            printf("i%d", gen_loops[gen_random(gen_loop_count)]);
+         else
+            printf("x");
+         break;
+      case 2:
+         printf("%d", gen_random(100));
+         break;
+      case 3:
+         /* Multiplication does not grow the value.  */
+         printf("(x * %d \\ %d)", 1 + gen_random(4), 4 + gen_random(4));
+         break;
+      default:
+         printf("x");
+   }
+}
+
+static void gen_int_expr(const gen_config_t *config)
+{
+   gen_int_operand();
+   for(int i = 1; i < config->expr_len; i++)
+   {
+      printf(gen_random(2) ? " + " : " - ");
+      gen_int_operand();
+   }
+}
+
+static void gen_double_expr(const gen_config_t *config)
+{
+   static const char *operands[] = {"y", "b", "(y * 0.5)", "1.25", "2.5e1"};
+
+   printf("%s", operands[gen_random(5)]);
+   for(int i = 1; i < config->expr_len; i++)
+      printf("%s%s", gen_random(2) ? " + " : " - ", operands[gen_random(5)]);
+}
+
+/*
+ * Prints string literal with escape sequences.
+ */
+static void gen_string_literal(const gen_config_t *config)
+{
+   printf("!\"");
+   for(int i = 0; i < config->string_len; i++)
+   {
+      int c = gen_random(32);
+
+      if(c < 26)
+         putchar('a' + c);
+      else if(c < 29)
+         putchar(' ');
+      else if(c == 29)
+         printf("\\n");
+      else if(c == 30)
+         printf("\\\"");
+      else
+         printf("\\%03d", 33 + gen_random(90));
+   }
+   putchar('"');
+}
+
+static void gen_statement(const gen_config_t *config, int level)
+{
+   gen_indent(level);
+   switch(gen_random(5))
+   {
+      case 0:
+         printf("y = ");
+         gen_double_expr(config);
+         break;
+      case 1:
+         printf("x = Length(t)");
+         break;
+      case 2:
+         printf("x = Asc(t, %d)", 1 + gen_random(8));
+         break;
+      default:
+         printf("x = ");
+         gen_int_expr(config);
+   }
+   putchar('\n');
+}
+
+static void gen_string_statement(const gen_config_t *config, int level)
+{
+   gen_indent(level);
+   printf("t = t + ");
+   gen_string_literal(config);
+   putchar('\n');
+   gen_indent(level);
+   printf("t = SubStr(t, 1, %d)\n", GEN_STRING_MAX);
+}
+
+/*
+ * Prints block of statements, its nested block is printed to the given
+ * depth.
+ */
+static void gen_block(const gen_config_t *config, int level, int depth)
+{
+   for(int i = 0; i < config->statements; i++)
+      gen_statement(config, level);
+   for(int i = 0; i < config->strings; i++)
+      gen_string_statement(config, level);
+
+   if(depth >= config->depth)
+      return;
+
+   if(gen_random(100) < config->loops)
+   {
+      /* Loops run twice, so the program stops soon.  */
+      gen_loops[gen_loop_count++] = depth;
+      if(gen_random(2))
+      {
+         gen_indent(level);
+         printf("for i%d = 1 to 2\n", depth);
+         gen_block(config, level + 1, depth + 1);
+         gen_indent(level);
+         printf("next\n");
+      }
+      else
+      {
+         gen_indent(level);
+         printf("i%d = 0\n", depth);
+         gen_indent(level);
+         printf("do while i%d < 2\n", depth);
+         gen_block(config, level + 1, depth + 1);
+         gen_indent(level + 1);
+         printf("i%d = i%d + 1\n", depth, depth);
+         gen_indent(level);
+         printf("loop\n");
+      }
+      gen_loop_count--;
+   }
+   else
+   {
+      gen_indent(level);
+      printf("if x > %d then\n", gen_random(100));
+      gen_block(config, level + 1, depth + 1);
+      gen_indent(level);
+      printf("elseif y < %d.5 then\n", gen_random(100));
+      gen_statement(config, level + 1);
+      gen_indent(level);
+      printf("else\n");
+      gen_string_statement(config, level + 1);
+      gen_indent(level);
+      printf("end if\n");
+   }
+}
+
+static void gen_function(const gen_config_t *config, int index)
+{
+   printf("function f%d(a as integer, b as double, s as string) "
+          "as integer\n", index);
+   for(int i = 0; i < config->depth; i++)
+      printf("\tdim i%d as integer\n", i);
+   printf("\tdim x as integer\n");
+   printf("\tdim y as double\n");
+   printf("\tdim t as string\n");
+   printf("\tx = a\n");
+   printf("\ty = b\n");
+   printf("\tt = s\n");
+   if(index > 0)
+      printf("\tx = f%d(x, y, t)\n", index - 1);
+
+   gen_block(config, 1, 0);
+
+   printf("\treturn x\n");
+   printf("end function\n\n");
+}
+
+int main(int argc, char *argv[])
+{
+   gen_config_t config = {GEN_DEFAULT_FUNCTIONS, GEN_DEFAULT_DEPTH,
+                          GEN_DEFAULT_EXPR_LEN, GEN_DEFAULT_STRINGS,
+                          GEN_DEFAULT_STRING_LEN, GEN_DEFAULT_LOOPS,
+                          GEN_DEFAULT_STATEMENTS};
+   unsigned long long seed = 1;
+   int option;
+
+   while((option = getopt(argc, argv, "f:d:e:s:S:l:b:r:")) != -1)
+   {
+      switch(option)
+      {
+         case 'f': config.functions = atoi(optarg); break;
+         case 'd': config.depth = atoi(optarg); break;
+         case 'e': config.expr_len = atoi(optarg); break;
+         case 's': config.strings = atoi(optarg); break;
+         case 'S': config.string_len = atoi(optarg); break;
+         case 'l': config.loops = atoi(optarg); break;
+         case 'b': config.statements = atoi(optarg); break;
+         case 'r': seed = strtoull(optarg, NULL, 10); break;
+         default:
+            fprintf(stderr, "Usage: %s [-f functions] [-d depth] "
+                    "[-e length] [-s strings] [-S length] [-l percent] "
+                    "[-b statements] [-r seed]\n", argv[0]);
+            return 1;
+      }
+   }
+
+   if(config.functions < 1 || config.depth < 0 ||
+      config.depth > GEN_MAX_DEPTH || config.expr_len < 1 ||
+      config.strings < 0 || config.string_len < 0 || config.loops < 0 ||
+      config.statements < 0)
+   {
+      fprintf(stderr, "%s: invalid option value\n", argv[0]);
+      return 1;
+   }
+
+   gen_state = seed;
+   for(int i = 0; i < config.functions; i++)
+      gen_function(&config, i);
+
+   printf("scope\n");
+   printf("\tdim r as integer\n");
+   printf("\tr = f%d(%d, 1.5, !\"seed\")\n", config.functions - 1,
+          config.functions);
+   printf("\tprint r; !\"\\n\";\n");
+   printf("end scope\n");
+
+   return 0;
+}
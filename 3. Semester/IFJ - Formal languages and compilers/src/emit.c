@@ -0,0 +1,238 @@
+/**
+ * @file emit.c
+ * @brief Buffered output writer for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module writes generated IFJcode17 into one large reusable buffer, which is
+ * passed to the output by a single fwrite() call whenever it gets full.
+ * Integers are formatted by hand, as well as integral floating point values,
+ * which are the most common float constants.  Output goes to stdout, to a
+ * file given by its path or to a stream opened by the caller.
+ */
+
+#include "emit.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/** @brief Largest integral value printed by %g without an exponent.  */
+#define EMIT_G_INT_MAX 999999.0
+
+/** @brief Output buffer.  */
+static char buffer[EMIT_BUFFER_SIZ];
+
+/** @brief Number of used bytes of the buffer.  */
+static size_t buffer_used = 0;
+
+/** @brief Output stream.  */
+static FILE *output = NULL;
+
+/** @brief Output was opened by emit_open() and gets closed by emit_close(). */
+static bool output_owned = false;
+
+/** @brief Write error flag.  */
+static int output_error = EMIT_SUCCESS;
+
+/*
+ * Makes sure that at least size bytes are free in the buffer.
+ */
+static inline void emit_reserve(size_t size)
+{
+   if(EMIT_BUFFER_SIZ - buffer_used < size)
+      emit_flush();
+}
+
+/*
+ * Formats unsigned number from the end of the temporary array.  Returns
+ * pointer to the first digit.
+ */
+static char *emit_format_unsigned(char *end, unsigned long value)
+{
+   do
+   {
+      *--end = '0' + value % 10;
+      value /= 10;
+   } while(value != 0);
+
+   return end;
+}
+
+int emit_open(const char *path)
+{
+   buffer_used = 0;
+   output_error = EMIT_SUCCESS;
+
+   if(path == NULL)
+      output = stdout;
+   else
+      output = fopen(path, "w");
+   output_owned = (path != NULL);
+
+   return (output != NULL) ? EMIT_SUCCESS : EMIT_FAILURE;
+}
+
+int emit_open_stream(FILE *stream)
+{
+   buffer_used = 0;
+   output_error = EMIT_SUCCESS;
+   output = stream;
+   output_owned = false;
+
+   return (output != NULL) ? EMIT_SUCCESS : EMIT_FAILURE;
+}
+
+int emit_close()
+{
+   if(output == NULL)
+      return EMIT_FAILURE;
+
+   emit_flush();
+
+   if(!output_owned)
+   {
+      if(fflush(output))
+         output_error = EMIT_FAILURE;
+   }
+   else if(fclose(output))
+      output_error = EMIT_FAILURE;
+
+   output = NULL;
+
+   return output_error;
+}
+
+int emit_flush()
+{
+   if(buffer_used != 0 && output != NULL &&
+      fwrite(buffer, 1, buffer_used, output) != buffer_used)
+      output_error = EMIT_FAILURE;
+
+   buffer_used = 0;
+
+   return output_error;
+}
+
+void emit_char(char c)
+{
+   emit_reserve(1);
+   buffer[buffer_used++] = c;
+}
+
+void emit_string(const char *str)
+{
+   emit_data(str, strlen(str));
+}
+
+void emit_data(const char *data, size_t len)
+{
+   /* Data longer than the buffer are written directly.  */
+   if(len > EMIT_BUFFER_SIZ)
+   {
+      emit_flush();
+      if(output != NULL && fwrite(data, 1, len, output) != len)
+         output_error = EMIT_FAILURE;
+      return;
+   }
+
+   emit_reserve(len);
+   memcpy(buffer + buffer_used, data, len);
+   buffer_used += len;
+}
+
+void emit_int(int value)
+{
+   char number[EMIT_NUMBER_SIZ];
+   char *end = number + EMIT_NUMBER_SIZ;
+   /* Negate in unsigned arithmetic, INT_MIN has no positive counterpart. */
+   unsigned long magnitude = (value < 0) ? 0UL - (unsigned long)value
+                                         : (unsigned long)value;
+   char *start = emit_format_unsigned(end, magnitude);
+
+   if(value < 0)
+      *--start = '-';
+
+   emit_reserve(end - start);
+   memcpy(buffer + buffer_used, start, end - start);
+   buffer_used += end - start;
+}
+
+void emit_double(double value)
+{
+   /* Integral values within 6 digits are printed by %g without decimals. */
+   if(value >= -EMIT_G_INT_MAX && value <= EMIT_G_INT_MAX &&
+      value == (double)(int)value && (value != 0.0 || !signbit(value)))
+   {
+      emit_int((int)value);
+      return;
+   }
+
+   emit_reserve(EMIT_NUMBER_SIZ);
+   buffer_used += snprintf(buffer + buffer_used, EMIT_NUMBER_SIZ, "%g", value);
+}
+
+void emit_format(const char *format, ...)
+{
+   va_list args;
+   const char *chunk = format;
+
+   va_start(args, format);
+
+   while(*format != '\0')
+   {
+      if(*format != '%')
+      {
+         format++;
+         continue;
+      }
+
+      /* Emit literal text preceding the conversion.  */
+      emit_reserve(format - chunk);
+      memcpy(buffer + buffer_used, chunk, format - chunk);
+      buffer_used += format - chunk;
+
+      format++;
+      switch(*format)
+      {
+         case 's':
+            emit_string(va_arg(args, const char *));
+            break;
+         case 'd':
+            emit_int(va_arg(args, int));
+            break;
+         case 'u':
+         {
+            char number[EMIT_NUMBER_SIZ];
+            char *end = number + EMIT_NUMBER_SIZ;
+            char *start = emit_format_unsigned(end, va_arg(args, unsigned));
+
+            emit_reserve(end - start);
+            memcpy(buffer + buffer_used, start, end - start);
+            buffer_used += end - start;
+            break;
+         }
+         case 'g':
+            emit_double(va_arg(args, double));
+            break;
+         case '%':
+            emit_char('%');
+            break;
+         default:
+            /* Unsupported conversion is emitted as it is.  */
+            emit_char('%');
+            format--;
+            break;
+      }
+
+      format++;
+      chunk = format;
+   }
+
+   emit_reserve(format - chunk);
+   memcpy(buffer + buffer_used, chunk, format - chunk);
+   buffer_used += format - chunk;
+
+   va_end(args);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file emit.h
+ * @brief Buffered output writer for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module writes generated IFJcode17 into one large reusable buffer, which is
+ * passed to the output by a single fwrite() call whenever it gets full.
+ * Integers are formatted by hand, as well as integral floating point values,
+ * which are the most common float constants.  Output goes to stdout, to a
+ * file given by its path or to a stream opened by the caller.
+ */
+
+#ifndef EMIT_H_INCLUDED
+#define EMIT_H_INCLUDED
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** @brief Emit module success identifier.  */
+#define EMIT_SUCCESS 0
+
+/** @brief Emit module failure identifier.  */
+#define EMIT_FAILURE 1
+
+/** @brief Size of the output buffer.  */
+#define EMIT_BUFFER_SIZ 65536
+
+/**
+ * @brief Longest text emitted by a single conversion (number or format
+ *        directive other than %s).
+ */
+#define EMIT_NUMBER_SIZ 64
+
+/**
+ * @brief Opens the output.  Output has to be closed by emit_close() to get
+ *        all the data written.
+ *
+ * @param *path Path to the output file or NULL for stdout.
+ * @return EMIT_SUCCESS if the output was opened, EMIT_FAILURE otherwise.
+ */
+int emit_open(const char *path);
+
+/**
+ * @brief Opens already opened stream as the output.  emit_close() only
+ *        flushes the stream, it stays open.
+ *
+ * @param *stream Output stream.
+ * @return EMIT_SUCCESS if the stream is not NULL, EMIT_FAILURE otherwise.
+ */
+int emit_open_stream(FILE *stream);
+
+/**
+ * @brief Flushes the buffer and closes the output file (stdout and streams
+ *        of emit_open_stream() are only flushed).
+ *
+ * @return EMIT_SUCCESS if all the data were written, EMIT_FAILURE otherwise.
+ */
+int emit_close();
+
+/**
+ * @brief Writes contents of the buffer to the output.
+ *
+ * @return EMIT_SUCCESS if all the data were written, EMIT_FAILURE otherwise.
+ */
+int emit_flush();
+
+/**
+ * @brief Emits a single character.
+ *
+ * @param c Character to be emitted.
+ * @return void.
+ */
+void emit_char(char c);
+
+/**
+ * @brief Emits a C-string.
+ *
+ * @param *str String to be emitted.
+ * @return void.
+ */
+void emit_string(const char *str);
+
+/**
+ * @brief Emits len bytes, which can contain NUL characters.
+ *
+ * @param *data Bytes to be emitted.
+ * @param len Number of the bytes.
+ * @return void.
+ */
+void emit_data(const char *data, size_t len);
+
+/**
+ * @brief Emits an integer in decimal notation, same as printf("%d").
+ *
+ * @param value Integer to be emitted.
+ * @return void.
+ */
+void emit_int(int value);
+
+/**
+ * @brief Emits a floating point number, same as printf("%g").
+ *
+ * @param value Number to be emitted.
+ * @return void.
+ */
+void emit_double(double value);
+
+/**
+ * @brief Emits formatted text.  Only conversions %s, %d, %u, %g and %% are
+ *        supported, without flags, width or precision.
+ *
+ * @param *format Format string.
+ * @return void.
+ */
+void emit_format(const char *format, ...);
+
+#endif
@@ -13,6 +13,7 @@
 #include "parser.h"
 #include "safe_malloc.h"
 #include "scanner.h"
+#include "stats.h"
 #include "tokenstack.h"
 
 #include <string.h>
@@ -24,6 +25,83 @@
 #define R_OP_EXPRESSION_OP 4
 #define R_FINISH 5
 
+/* Maximal number of parameters of a built-in function.  */
+#define BUILT_IN_MAX_PARAMS 3
+
+/* Largest value accepted by chr().  */
+#define CHR_MAX_VALUE 255
+
+/* Terminal classes of the precedence table.  Terminals within one class
+   behave the same both on the top of the stack and on the input.  */
+#define PREC_OTHER 0          // Terminals not allowed in expressions
+#define PREC_ADD 1            // + -
+#define PREC_MUL 2            // * /
+#define PREC_IDIV 3           // \ (integer division)
+#define PREC_REL 4            // = <> < <= > >=
+#define PREC_OPERAND 5        // Identifier and literals
+#define PREC_LEFT_BRACKET 6   // (
+#define PREC_RIGHT_BRACKET 7  // )
+#define PREC_END 8            // End of expression ($)
+#define PREC_CLASS_COUNT 9
+
+/* Upper bound of token IDs mapped to terminal classes.  */
+#define PREC_TOKEN_COUNT 128
+
+/* Terminal class of the token ID, IDs out of the range are PREC_OTHER.  */
+#define PREC_CLASS(id) \
+   (((unsigned)(id) < PREC_TOKEN_COUNT) ? prec_class[(id)] : PREC_OTHER)
+
+/* Shorter action names to keep the table readable.  */
+#define S_ SHIFT_ACTION
+#define RS RULE_START_SHIFT_ACTION
+#define R_ REDUCE_ACTION
+#define E_ END_ACTION
+#define CH CHAINING_ERROR_ACTION
+#define MO MISSING_OPERATOR_ERROR_ACTION
+#define UB UNMATCHED_BRACKET_ERROR_ACTION
+#define CO CONTINUATION_ERROR_ACTION
+
+/* Terminal class of every token ID.  */
+static const unsigned char prec_class[PREC_TOKEN_COUNT] = 
+{
+   [PLUS_ID] = PREC_ADD,                  [MINUS_ID] = PREC_ADD,
+   [ASTERISK_ID] = PREC_MUL,              [SLASH_ID] = PREC_MUL,
+   [BACKSLASH_ID] = PREC_IDIV,
+   [EQUALS_ID] = PREC_REL,                [NOT_EQUAL_ID] = PREC_REL,
+   [LESS_ID] = PREC_REL,                  [LESS_EQUAL_ID] = PREC_REL,
+   [GREATER_ID] = PREC_REL,               [GREATER_EQUAL_ID] = PREC_REL,
+   [ID_ID] = PREC_OPERAND,                [INTEGER_LITERAL_ID] = PREC_OPERAND,
+   [DOUBLE_LITERAL_ID] = PREC_OPERAND,    [STRING_LITERAL_ID] = PREC_OPERAND,
+   [LEFT_BRACKET_ID] = PREC_LEFT_BRACKET,
+   [RIGHT_BRACKET_ID] = PREC_RIGHT_BRACKET,
+   [EXPR_END_ID] = PREC_END
+};
+
+/* Precedence table, indexed by the class of the topmost terminal on the 
+   stack and by the class of the input terminal.  */
+static const unsigned char prec_table[PREC_CLASS_COUNT][PREC_CLASS_COUNT] =
+{
+/* input:    oth   + -   * /   \     rel   opnd  (     )     $ */
+/* oth   */ { CO,   RS,   RS,   RS,   R_,   RS,   RS,   R_,   R_ },
+/* + -   */ { CO,   R_,   RS,   RS,   R_,   RS,   RS,   R_,   R_ },
+/* * /   */ { CO,   R_,   R_,   R_,   R_,   RS,   RS,   R_,   R_ },
+/* \     */ { CO,   R_,   RS,   R_,   R_,   RS,   RS,   R_,   R_ },
+/* rel   */ { CO,   RS,   RS,   RS,   CH,   RS,   RS,   R_,   R_ },
+/* opnd  */ { CO,   R_,   R_,   R_,   R_,   MO,   MO,   R_,   R_ },
+/* (     */ { CO,   RS,   RS,   RS,   RS,   RS,   RS,   S_,   UB },
+/* )     */ { CO,   R_,   R_,   R_,   R_,   RS,   RS,   R_,   R_ },
+/* $     */ { CO,   RS,   RS,   RS,   RS,   RS,   RS,   E_,   R_ }
+};
+
+#undef S_
+#undef RS
+#undef R_
+#undef E_
+#undef CH
+#undef MO
+#undef UB
+#undef CO
+
 bool consult_table(int topTerm, int input, int *action);
 bool reduce(tstack *stack);
 bool shift(tstack *stack, token_t *t);
@@ -37,12 +115,24 @@ bool check_type_compabitility(int *op1_type,
 bool evaluate_expr(token_t *op1, token_t *op2, int operator,  token_t *result);
 void convert_literal(token_t *lit, token_t *conv);
 void backslash_literal_evaluate(token_t *lit);
+bool built_in_foldable(char *name, token_t *params);
 int evaluate_length(char *str);
+char *evaluate_char_at(char *str, int position);
 char *evaluate_substr(char *str, int start, int length);
 int evaluate_asc(char *str, int position);
 char *evaluate_chr(int char_val);
+bool expr_analysis();
 
 bool expr()
+{
+   STATS_START(STATS_PHASE_EXPR);
+   bool success = expr_analysis();
+   STATS_STOP(STATS_PHASE_EXPR);
+
+   return success;
+}
+
+bool expr_analysis()
 {
    bool success = true;
    int input;
@@ -237,6 +327,14 @@ bool expr()
    while(input != EXPR_END_ID || top != EXPR_END_ID);
 
    token_t final_expr = tstack_toppop(&exprStack);
+
+   /* Result left on the data stack is stored to variable */
+   if(success && is_stack_result(&final_expr))
+   {
+      SAFE_PUSH(instr_stack, final_expr);
+      final_expr.a.str = generate(&instr_stack, STACK_RESULT_ID);
+   }
+
    SAFE_PUSH(semStack, final_expr);
    tstack_free(&exprStack);
 
@@ -444,8 +542,6 @@ bool built_in_func_call()
       /* <built-in-func-call> -> substr <func-call> simulation */
       name.a.str = "substr";
 
-      all_params_const = false;
-
       GET_TOKEN(token);
       if(!func_call()) HANDLE_ERROR(SYNT_ERR, success);
    }
@@ -485,6 +581,8 @@ bool built_in_func_call()
       HANDLE_ERROR(TYPE_COMP_ERR, success);
    }
 
+   /* Converted arguments, kept for evaluation in code */
+   token_t params[BUILT_IN_MAX_PARAMS];
    for(int i = param_num.a.val_int-1; i >= 0; i--)
    {
       token_t param_token = tstack_toppop(&semStack);
@@ -509,6 +607,7 @@ bool built_in_func_call()
          all_params_const = false;
       }
 
+      params[i] = param_token;
       SAFE_PUSH(instr_stack, param_token);
       SAFE_PUSH(instr_stack, conv);
    }
@@ -517,19 +616,23 @@ bool built_in_func_call()
    funcExpr.id = EXPR_ID;
    funcExpr.type = function_entry->s.func.returnType;
    
-   if(all_params_const)
+   /* Calls which would end with a runtime error are left to the runtime */
+   if(all_params_const && built_in_foldable(name.a.str, params))
    {
-      if(strcmp(name.a.str, "length") == 0)
+      /* Drop the arguments and their conversions */
+      for(int i = 0; i < param_num.a.val_int; i++)
       {
          tstack_pop(&instr_stack);
-         token_t str_token = tstack_toppop(&instr_stack);
-         funcExpr.a.val_int = evaluate_length(str_token.a.str);
+         tstack_pop(&instr_stack);
+      }
+
+      if(strcmp(name.a.str, "length") == 0)
+      {
+         funcExpr.a.val_int = evaluate_length(params[0].a.str);
       }
       else if(strcmp(name.a.str, "chr") == 0)
       {
-         tstack_pop(&instr_stack);
-         token_t char_val = tstack_toppop(&instr_stack);
-         funcExpr.a.str = evaluate_chr(char_val.a.val_int);
+         funcExpr.a.str = evaluate_chr(params[0].a.val_int);
          if(funcExpr.a.str == NULL)
          {
             internal_error_msg("Failed to allocate memory!\n");
@@ -538,27 +641,14 @@ bool built_in_func_call()
       }
       else if(strcmp(name.a.str, "asc") == 0)
       {
-         tstack_pop(&instr_stack);
-         token_t str_token = tstack_toppop(&instr_stack);
-         
-         tstack_pop(&instr_stack);
-         token_t char_pos = tstack_toppop(&instr_stack);
-         funcExpr.a.val_int = evaluate_asc(str_token.a.str,
-                                           char_pos.a.val_int);
+         funcExpr.a.val_int = evaluate_asc(params[0].a.str,
+                                           params[1].a.val_int);
       }
       else if(strcmp(name.a.str, "substr") == 0)
       {
-         tstack_pop(&instr_stack);
-         token_t str_token = tstack_toppop(&instr_stack);
-         
-         tstack_pop(&instr_stack);
-         token_t start_token = tstack_toppop(&instr_stack);
-
-         tstack_pop(&instr_stack);
-         token_t length_token = tstack_toppop(&instr_stack);
-         funcExpr.a.str = evaluate_substr(str_token.a.str, 
-                                              start_token.a.val_int, 
-                                              length_token.a.val_int);
+         funcExpr.a.str = evaluate_substr(params[0].a.str, 
+                                          params[1].a.val_int, 
+                                          params[2].a.val_int);
          if(funcExpr.a.str == NULL)
          {
             internal_error_msg("Failed to allocate memory!\n");
@@ -636,9 +726,10 @@ bool reduce(tstack *stack)
             exprToken.type = var->type;
 
             /* If the variable is constant and the code structure
-               allows it, optimise by not using the variable */
-            if(var->is_const && code_structure == 
-               CODE_STRUCTURE_LINEAR)
+               allows it, optimise by not using the variable. Branches
+               see the values known before them, writes in a branch make
+               the variable non-constant */
+            if(var->is_const && code_structure != CODE_STRUCTURE_JUMP)
             {
                cp_val_to_token(&exprToken, var);
                exprToken.is_const = true;
@@ -878,7 +969,12 @@ bool reduce(tstack *stack)
                SAFE_PUSH(instr_stack, conv2);
                SAFE_PUSH(instr_stack, conv1);
 
-               exprToken.a.str = generate(&instr_stack, operator);
+               /* Concatenation has no stack instruction */
+               if(expr_backend == EXPR_BACKEND_STACK &&
+                  exprToken.type != STRING_ID)
+                  exprToken.a.str = generate_stack(&instr_stack, operator);
+               else
+                  exprToken.a.str = generate(&instr_stack, operator);
                exprToken.is_const = false;
             }
          }
@@ -937,125 +1033,34 @@ bool rule_start_shift(tstack *stack, token_t *t)
    return success;
 }
 
+int table_action(int topTerm, int input)
+{
+   return prec_table[PREC_CLASS(topTerm)][PREC_CLASS(input)];
+}
+
 bool consult_table(int topTerm, int input, int *action)
 {
-   *action = -1;
-   if(input == PLUS_ID || input == MINUS_ID)
-   {
-      if(topTerm == PLUS_ID || topTerm == MINUS_ID || topTerm == ID_ID ||
-       topTerm == INTEGER_LITERAL_ID || topTerm == DOUBLE_LITERAL_ID ||
-       topTerm == STRING_LITERAL_ID || topTerm == RIGHT_BRACKET_ID ||
-       topTerm == ASTERISK_ID || topTerm == SLASH_ID ||
-       topTerm == BACKSLASH_ID)
-      {
-         *action = REDUCE_ACTION;
-      }
-      else
-      {
-         *action = RULE_START_SHIFT_ACTION;
-      }
-   }
-   else if(input == ASTERISK_ID || input == SLASH_ID)
-   {
-      if(topTerm == ASTERISK_ID || topTerm == SLASH_ID || topTerm == ID_ID ||
-       topTerm == INTEGER_LITERAL_ID || topTerm == DOUBLE_LITERAL_ID ||
-       topTerm == STRING_LITERAL_ID || topTerm == RIGHT_BRACKET_ID)
-      {
-         *action = REDUCE_ACTION;
-      }
-      else
-      {
-         *action = RULE_START_SHIFT_ACTION;
-      }
-   }
-   else if(input == BACKSLASH_ID)
-   {
-      if(topTerm == ASTERISK_ID || topTerm == SLASH_ID || 
-         topTerm == BACKSLASH_ID || topTerm == ID_ID || 
-         topTerm == INTEGER_LITERAL_ID || topTerm == DOUBLE_LITERAL_ID || 
-         topTerm == STRING_LITERAL_ID || topTerm == RIGHT_BRACKET_ID)
-      {
-         *action = REDUCE_ACTION;
-      }
-      else
-      {
-         *action = RULE_START_SHIFT_ACTION;
-      }
-   }
-   else if(input == EQUALS_ID || input == NOT_EQUAL_ID || 
-           input == GREATER_ID || input == GREATER_EQUAL_ID || 
-           input == LESS_ID || input == LESS_EQUAL_ID)
+   *action = table_action(topTerm, input);
+   switch(*action)
    {
-      if(topTerm == LEFT_BRACKET_ID || topTerm == EXPR_END_ID)
-      {
-         *action = RULE_START_SHIFT_ACTION;
-      }
-      else if(topTerm == EQUALS_ID || topTerm == NOT_EQUAL_ID ||
-         topTerm == GREATER_ID || topTerm == GREATER_EQUAL_ID ||
-         topTerm == LESS_ID || topTerm == LESS_EQUAL_ID)
-      {
+      case CHAINING_ERROR_ACTION:
          error_msg(line_counter, "Relational operator chaining is not"
          " allowed!\n");
          return false;
-      }
-      else
-      {
-         *action = REDUCE_ACTION;
-      }
-   }
-   else if(input == ID_ID || input == INTEGER_LITERAL_ID || 
-           input == DOUBLE_LITERAL_ID || input == STRING_LITERAL_ID || 
-           input == LEFT_BRACKET_ID)
-   {
-      if(topTerm == ID_ID || topTerm == INTEGER_LITERAL_ID ||
-       topTerm == DOUBLE_LITERAL_ID || topTerm == STRING_LITERAL_ID)
-      {
+      case MISSING_OPERATOR_ERROR_ACTION:
          error_msg(line_counter, "Missing operator between '%s' and '%s'"
             "!\n", token_to_string(topTerm), token_to_string(input));
          return false;
-      }
-      else
-      {
-         *action = RULE_START_SHIFT_ACTION;
-      }
-   }
-   else if(input == RIGHT_BRACKET_ID)
-   {
-      if(topTerm == LEFT_BRACKET_ID)
-      {
-         *action = SHIFT_ACTION;
-      }
-      else if(topTerm == EXPR_END_ID)
-      {
-         /*Special case for arguments in function calls, 
-         in this case, ) is no longer part of the expression */
-         *action = END_ACTION; 
-      }
-      else
-      {
-         *action = REDUCE_ACTION;
-      }
-   }
-   else if(input == EXPR_END_ID)
-   {
-      if(topTerm == LEFT_BRACKET_ID)
-      {
+      case UNMATCHED_BRACKET_ERROR_ACTION:
          error_msg(line_counter, "Unmatched left bracket detected!\n");
          return false;
-      }
-      else
-      {
-         *action = REDUCE_ACTION;
-      }
-   }
-   else
-   {
-      error_msg(line_counter, "Expected continuation of expression, "
-                "received '%s'!\n", token_to_string(input));
-      return false;
+      case CONTINUATION_ERROR_ACTION:
+         error_msg(line_counter, "Expected continuation of expression, "
+                   "received '%s'!\n", token_to_string(input));
+         return false;
+      default:
+         return true;
    }
-
-   return true;
 }
 
 /**
@@ -1541,35 +1546,73 @@ int evaluate_length(char *str)
    return len;
 }
 
-char *evaluate_substr(char *str, int start, int length)
+/**
+ * Returns pointer to the character on the position (counted from 0) of the
+ * string, escape sequence \ddd is a single character
+ */
+char *evaluate_char_at(char *str, int position)
 {
-   int len = evaluate_length(str);
-   char *ret_val;
-   int mal_size;
-   if(start <= 0 || start > len || len == 0)
+   for(; position > 0 && *str != 0; position--)
    {
-      mal_size = 1;
+      if(*str == '\\')
+         str += 3;
+      str++;
    }
-   else if(length < 0 || length > len)
+
+   return str;
+}
+
+/**
+ * Decides if the built-in function with constant arguments can be evaluated
+ * in code.  It cannot, when the generated code would end with a runtime
+ * error, which has to be kept.
+ */
+bool built_in_foldable(char *name, token_t *params)
+{
+   if(strcmp(name, "chr") == 0)
    {
-      mal_size = len - start + 1;
+      /* INT2CHAR fails out of the char range */
+      return params[0].a.val_int >= 0 && params[0].a.val_int <= CHR_MAX_VALUE;
    }
-   else 
+   else if(strcmp(name, "asc") == 0)
    {
-      mal_size = length+1;
+      /* STRI2INT fails before the first character */
+      return params[1].a.val_int >= 1;
    }
+   else if(strcmp(name, "substr") == 0)
+   {
+      int len = evaluate_length(params[0].a.str);
 
-   ret_val = smalloc(mal_size);
-   if(ret_val == NULL) return NULL;
+      /* GETCHAR fails right after the last character */
+      return len == 0 || params[2].a.val_int == 0 ||
+             params[1].a.val_int != len + 1;
+   }
+
+   return true;
+}
+
+char *evaluate_substr(char *str, int start, int length)
+{
+   int len = evaluate_length(str);
+   char *begin = str;
+   char *end = str;
 
-   if(mal_size == 1)
+   if(len != 0 && start >= 1 && start <= len && length != 0)
    {
-      ret_val[0] = 0;
-      return ret_val;
+      begin = evaluate_char_at(str, start - 1);
+
+      /* Too long or negative length takes the rest of the string */
+      if(length < 0 || length > len - start + 1)
+         end = begin + strlen(begin);
+      else
+         end = evaluate_char_at(begin, length);
    }
 
-   strncpy(ret_val, str+start, mal_size-2);
-   ret_val[mal_size-1] = 0;
+   char *ret_val = smalloc(end - begin + 1);
+   if(ret_val == NULL) return NULL;
+
+   memcpy(ret_val, begin, end - begin);
+   ret_val[end - begin] = 0;
 
    return ret_val;
 }
@@ -1580,25 +1623,16 @@ int evaluate_asc(char *str, int position)
    if(position-1 < 0 || position-1 >= len)
       return 0;
 
-   int i = 0;
-   while(i+1 != position)
-   {
-      if(str[i] == '\\')
-      {
-         i -= 3;
-      }
-      i++;
-   }
-
+   char *c = evaluate_char_at(str, position-1);
    int ret_val = 0;
 
-   if(str[i] == '\\')
+   if(c[0] == '\\')
    {
-      ret_val = 100*(str[i+1]-'0') + 10*(str[i+2]-'0') + str[i+3] - '0'; 
+      ret_val = 100*(c[1]-'0') + 10*(c[2]-'0') + c[3] - '0'; 
    }
    else
    {
-      ret_val = str[i];
+      ret_val = (unsigned char)c[0];
    }
 
    return ret_val;
@@ -8,8 +8,13 @@
 #define RULE_START_SHIFT_ACTION 1
 #define REDUCE_ACTION 2
 #define END_ACTION 3
+#define CHAINING_ERROR_ACTION 4
+#define MISSING_OPERATOR_ERROR_ACTION 5
+#define UNMATCHED_BRACKET_ERROR_ACTION 6
+#define CONTINUATION_ERROR_ACTION 7
 
 bool expr();
+int table_action(int topTerm, int input);
 bool func_call();
 bool built_in_func_call();
 bool arg_list();
@@ -0,0 +1,785 @@
+/**
+ * @file fcache.c
+ * @brief Function cache for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Entry of a function is a binary file named by the hash of the function.
+ * It starts with fcache_header_t followed by the instructions of the body
+ * appended to instructs and global_var_ilist (fcache_code_t) and by the area
+ * of strings their operands point to, as instruction_print() would read
+ * them.  Size of the records and the area (the payload) and a checksum of
+ * the whole entry are kept in the header, a damaged or truncated entry is
+ * missed.  Entry is read by a single fread() and the strings are used right
+ * from the area, only names moved by rebasing are created again.  Entries
+ * are only read by the compiler which wrote them, its build is a part of the
+ * key.
+ */
+
+/* mkdir() and getpid() are POSIX.  */
+#define _POSIX_C_SOURCE 200112L
+
+#include "error.h"
+#include "fcache.h"
+#include "generator.h"
+#include "ilist.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "safe_malloc.h"
+#include "scanner.h"
+#include "stats.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/** @brief Number of instruction lists a function body is appended to.  */
+#define FCACHE_LISTS 2
+
+/** @brief Operand is stored as the raw value of the token.  */
+#define FCACHE_OPERAND_RAW 0
+
+/** @brief Operand is stored as the string it points to.  */
+#define FCACHE_OPERAND_STR 1
+
+/** @brief Space for the longer counter of a rebased name.  */
+#define FCACHE_REBASE_SIZ 24
+
+/** @brief Offset basis of the 64-bit FNV-1a hash.  */
+#define FCACHE_FNV_OFFSET 14695981039346656037ULL
+
+/** @brief Prime of the 64-bit FNV-1a hash.  */
+#define FCACHE_FNV_PRIME 1099511628211ULL
+
+/*
+ * Identity of the build, the Makefile passes the checksum of the sources of
+ * the compiler.  Time of the compilation is used without it.
+ */
+#ifndef FCACHE_BUILD
+#define FCACHE_BUILD __DATE__ " " __TIME__
+#endif
+
+/** @brief Label prefix with the counter in the middle of the name.  */
+#define FCACHE_ELSE_IF_PREFIX "$ELSE_IF_"
+
+/** @brief Token read ahead by fcache_function_start().  */
+typedef struct fcache_token
+{
+   token_t token;                   ///< Token returned by the scanner
+   int result;                      ///< Return value of get_next_token()
+   int line;                        ///< Line counter after the token
+} fcache_token_t;
+
+/** @brief Header of an entry file.  */
+typedef struct fcache_header
+{
+   int version;                     ///< FCACHE_VERSION
+   uint64_t key;                    ///< Hash of the function
+   gen_counters_t start;            ///< Counters at the 'function' keyword
+   gen_counters_t end;              ///< Counters after the body
+   int code_structure;              ///< Code structure after the body
+   int counts[FCACHE_LISTS];        ///< Number of instructions of the lists
+   int strings_size;                ///< Size of the area of strings
+   int payload_size;                ///< Size of the records and of the area
+   uint64_t checksum;               ///< Hash of the entry, counted as 0 here
+} fcache_header_t;
+
+/** @brief Instruction of an entry.  */
+typedef struct fcache_code
+{
+   code_t code;                     ///< Instruction, string pointers cleared
+   int strings[3];                  ///< Offset + 1 of the operand strings in
+                                    ///< the area, 0 for raw or NULL operands
+} fcache_code_t;
+
+/** @brief Lists the body is appended to, in the order of the entry.  */
+static ilist_t *const lists[FCACHE_LISTS] = {&instructs, &global_var_ilist};
+
+/** @brief Directory of the entries, NULL if the cache is disabled.  */
+static const char *cache_dir = NULL;
+
+/** @brief Tokens read ahead, returned by fcache_next_token().  */
+static fcache_token_t *queue = NULL;
+static int queue_size = 0;
+static int queue_count = 0;
+static int queue_pos = 0;
+
+/** @brief Hash of the current function, valid if key_valid is true.  */
+static uint64_t key = 0;
+static bool key_valid = false;
+
+/** @brief Body of the current function was spliced from its entry.  */
+static bool body_hit = false;
+
+/** @brief Counters of the generator at the 'function' keyword.  */
+static gen_counters_t start_counters;
+
+/** @brief Last instructions of the lists before the body.  */
+static int body_marks[FCACHE_LISTS];
+
+int fcache_open(const char *dir)
+{
+   struct stat info;
+
+   if(mkdir(dir, 0777) != 0 && errno != EEXIST)
+      return FCACHE_FAILURE;
+   if(stat(dir, &info) != 0 || !S_ISDIR(info.st_mode) ||
+      access(dir, R_OK | W_OK | X_OK) != 0)
+      return FCACHE_FAILURE;
+
+   cache_dir = dir;
+
+   return FCACHE_SUCCESS;
+}
+
+void fcache_reinit()
+{
+   queue = NULL;
+   queue_size = 0;
+   queue_count = 0;
+   queue_pos = 0;
+   key_valid = false;
+   body_hit = false;
+}
+
+int fcache_next_token(token_t *token)
+{
+   if(queue_pos < queue_count)
+   {
+      fcache_token_t *ahead = &queue[queue_pos++];
+
+      token->id = ahead->token.id;
+      token->a = ahead->token.a;
+      line_counter = ahead->line;
+
+      return ahead->result;
+   }
+
+   return get_next_token(token);
+}
+
+/*
+ * Reads tokens up to 'function' of 'end function' to the queue.  Returns
+ * true if the end of the function was found, false on lexical error or at
+ * the end of the input.
+ */
+static bool fcache_read_ahead()
+{
+   token_t ahead = token;           //Fields not set by scanner are kept
+   bool end = false;
+
+   queue_count = 0;
+   queue_pos = 0;
+
+   while(true)
+   {
+      if(queue_count == queue_size)
+      {
+         int new_size = (queue_size > 0) ? 2 * queue_size : FCACHE_INIT_SIZ;
+         fcache_token_t *new_queue = srealloc(queue,
+                                              new_size * sizeof(*queue));
+
+         if(new_queue == NULL)
+            return false;
+
+         queue = new_queue;
+         queue_size = new_size;
+      }
+
+      queue[queue_count].result = get_next_token(&ahead);
+      queue[queue_count].token = ahead;
+      queue[queue_count].line = line_counter;
+      queue_count++;
+
+      if(queue[queue_count - 1].result == LEX_ERR || ahead.id == EOF)
+         return false;
+      if(end && ahead.id == FUNCTION_ID)
+         return true;
+
+      end = (ahead.id == END_ID);
+   }
+}
+
+/*
+ * Adds the bytes to the FNV-1a hash.
+ */
+static uint64_t fcache_hash_bytes(uint64_t hash, const void *data, size_t len)
+{
+   const unsigned char *bytes = data;
+
+   for(size_t i = 0; i < len; i++)
+   {
+      hash ^= bytes[i];
+      hash *= FCACHE_FNV_PRIME;
+   }
+
+   return hash;
+}
+
+static uint64_t fcache_hash_int(uint64_t hash, int value)
+{
+   return fcache_hash_bytes(hash, &value, sizeof(value));
+}
+
+/*
+ * Adds the string including its terminating NUL, so concatenated strings
+ * cannot collide, NULL is hashed as a lone NUL.
+ */
+static uint64_t fcache_hash_str(uint64_t hash, const char *str)
+{
+   if(str == NULL)
+      return fcache_hash_bytes(hash, "", 1);
+
+   return fcache_hash_bytes(hash, str, strlen(str) + 1);
+}
+
+/*
+ * Adds the global symbol of the identifier, the code of the body depends on
+ * it: signatures and labels of functions, names and types of variables.
+ */
+static uint64_t fcache_hash_symbol(uint64_t hash, char *id)
+{
+   symbol_t *symbol = stab_get_data(&global_table, id);
+
+   if(symbol == NULL)
+      return fcache_hash_int(hash, 0);
+
+   hash = fcache_hash_int(hash, symbol->type);
+   if(symbol->type == SYMB_FUNC)
+   {
+      struct func_info *func = &(symbol->s.func);
+
+      hash = fcache_hash_int(hash, func->state);
+      hash = fcache_hash_int(hash, func->returnType);
+      hash = fcache_hash_int(hash, func->param_count);
+      for(int i = 0; i < func->param_count; i++)
+      {
+         hash = fcache_hash_int(hash, func->params[i].type);
+         hash = fcache_hash_str(hash, func->params[i].code_name);
+      }
+      hash = fcache_hash_str(hash, func->code_label);
+   }
+   else
+   {
+      struct var_info *var = vdstack_top(&(symbol->s.var_stack));
+
+      if(var == NULL)
+         return fcache_hash_int(hash, 0);
+
+      hash = fcache_hash_int(hash, var->type);
+      hash = fcache_hash_int(hash, var->scope_modifier);
+      hash = fcache_hash_int(hash, var->is_const);
+      hash = fcache_hash_str(hash, var->code_name);
+      if(var->is_const && var->type == INTEGER_ID)
+         hash = fcache_hash_int(hash, var->value.int_value);
+      else if(var->is_const && var->type == DOUBLE_ID)
+         hash = fcache_hash_bytes(hash, &(var->value.double_value),
+                                  sizeof(double));
+      else if(var->is_const && var->type == STRING_ID)
+         hash = fcache_hash_str(hash, var->value.string_value);
+   }
+
+   return hash;
+}
+
+/*
+ * Computes hash of the function from the tokens in the queue and the global
+ * symbols they refer to.  Line numbers are left out, so a moved function
+ * keeps its entry.  The build of the compiler is hashed too, a changed
+ * generator does not read entries of the old one.
+ */
+static uint64_t fcache_hash_function()
+{
+   uint64_t hash = FCACHE_FNV_OFFSET;
+
+   hash = fcache_hash_int(hash, FCACHE_VERSION);
+   hash = fcache_hash_str(hash, FCACHE_BUILD);
+   hash = fcache_hash_int(hash, expr_backend);
+   hash = fcache_hash_int(hash, start_counters.elsif);
+
+   for(int i = 0; i < queue_count; i++)
+   {
+      token_t *ahead = &(queue[i].token);
+
+      hash = fcache_hash_int(hash, ahead->id);
+      if(ahead->id == ID_ID)
+      {
+         hash = fcache_hash_str(hash, ahead->a.str);
+         hash = fcache_hash_symbol(hash, ahead->a.str);
+      }
+      else if(ahead->id == STRING_LITERAL_ID)
+         hash = fcache_hash_str(hash, ahead->a.str);
+      else if(ahead->id == INTEGER_LITERAL_ID)
+         hash = fcache_hash_int(hash, ahead->a.val_int);
+      else if(ahead->id == DOUBLE_LITERAL_ID)
+         hash = fcache_hash_bytes(hash, &(ahead->a.val_real), sizeof(double));
+   }
+
+   return hash;
+}
+
+/*
+ * Computes the checksum of the entry: the header with the checksum counted
+ * as 0, including its padding, and the payload, which can be split in two
+ * parts.
+ */
+static uint64_t fcache_checksum(const fcache_header_t *header,
+                                const void *records, size_t records_size,
+                                const void *area, size_t area_size)
+{
+   fcache_header_t copy;
+   uint64_t hash;
+
+   memcpy(&copy, header, sizeof(copy));
+   copy.checksum = 0;
+   hash = fcache_hash_bytes(FCACHE_FNV_OFFSET, &copy, sizeof(copy));
+   hash = fcache_hash_bytes(hash, records, records_size);
+
+   return fcache_hash_bytes(hash, area, area_size);
+}
+
+/*
+ * Fills the path of the entry, suffix distinguishes temporary files.
+ */
+static char *fcache_path(const char *suffix)
+{
+   size_t len = strlen(cache_dir) + strlen(suffix) + 2 * sizeof(key) +
+                sizeof("/" FCACHE_EXTENSION);
+   char *path = smalloc(len);
+
+   if(path != NULL)
+      snprintf(path, len, "%s/%016llx%s%s", cache_dir,
+               (unsigned long long)key, FCACHE_EXTENSION, suffix);
+
+   return path;
+}
+
+/*
+ * Determines how the operand is stored, the same way as instruction_print()
+ * reads it.
+ */
+static int fcache_operand_kind(code_t *code, int operand, token_t *token)
+{
+   int role = opt_role(code->operation_type, operand);
+
+   if(role == OPT_ROLE_NONE)
+      return FCACHE_OPERAND_RAW;
+   if(role != OPT_ROLE_READ)
+      return FCACHE_OPERAND_STR;
+   if(token->id == TOKEN_TRUE_ID)
+      return FCACHE_OPERAND_RAW;
+   if(token->is_const && (token->type == INTEGER_ID ||
+      token->type == DOUBLE_ID || token->type == BOOLEAN_ID))
+      return FCACHE_OPERAND_RAW;
+
+   return FCACHE_OPERAND_STR;
+}
+
+static token_t *fcache_operand(code_t *code, int operand)
+{
+   if(operand == 0)
+      return &(code->first_operand);
+   else if(operand == 1)
+      return &(code->second_operand);
+   else
+      return &(code->third_operand);
+}
+
+/*
+ * Returns the string the operand of the stored instruction points to, NULL
+ * for raw operands.
+ */
+static char *fcache_operand_str(code_t *code, int operand)
+{
+   token_t *token = fcache_operand(code, operand);
+
+   if(fcache_operand_kind(code, operand, token) == FCACHE_OPERAND_RAW)
+      return NULL;
+
+   return token->a.str;
+}
+
+/*
+ * Stores the instruction to the record and its strings to the area, which
+ * is large enough.  Padding of the record is zeroed, so entries of the same
+ * function are identical.
+ */
+static void fcache_write_code(fcache_code_t *record, code_t *code,
+                              char *area, int *area_len)
+{
+   memset(record, 0, sizeof(*record));
+   record->code.operation_type = code->operation_type;
+
+   for(int i = 0; i < 3; i++)
+   {
+      token_t *token = fcache_operand(code, i);
+      token_t *stored = fcache_operand(&(record->code), i);
+      char *str = fcache_operand_str(code, i);
+
+      stored->id = token->id;
+      stored->type = token->type;
+      stored->is_const = token->is_const;
+
+      if(fcache_operand_kind(code, i, token) == FCACHE_OPERAND_RAW)
+         stored->a = token->a;
+      else if(str != NULL)
+      {
+         size_t len = strlen(str) + 1;
+
+         memcpy(area + *area_len, str, len);
+         record->strings[i] = *area_len + 1;
+         *area_len += len;
+      }
+   }
+}
+
+/*
+ * Stores the body appended to the lists since fcache_function_body().  The
+ * entry is written to a temporary file first, so readers never see a
+ * partially written entry.
+ */
+static void fcache_store()
+{
+   char suffix[32];
+   fcache_header_t header;
+   fcache_code_t *records;
+   char *area;
+   char *tmp_path;
+   char *path;
+   FILE *entry;
+   size_t strings_size = 0;
+   int count;
+   int area_len = 0;
+   int i = 0;
+   bool ok;
+
+   /* Padding is zeroed, entries of the same function are identical.  */
+   memset(&header, 0, sizeof(header));
+   header.version = FCACHE_VERSION;
+   header.key = key;
+   header.start = start_counters;
+   generator_get_counters(&header.end);
+   header.code_structure = code_structure;
+   for(int l = 0; l < FCACHE_LISTS; l++)
+   {
+      int index = (body_marks[l] != ILIST_NULL) ?
+                  ilist_index_next(body_marks[l]) : lists[l]->first;
+
+      for(; index != ILIST_NULL; index = ilist_index_next(index))
+      {
+         header.counts[l]++;
+         for(int op = 0; op < 3; op++)
+         {
+            char *str = fcache_operand_str(ilist_at(index), op);
+
+            if(str != NULL)
+               strings_size += strlen(str) + 1;
+         }
+      }
+   }
+
+   count = header.counts[0] + header.counts[1];
+   if(strings_size > INT_MAX / 2 ||
+      (size_t)count > (INT_MAX / 2) / sizeof(*records))
+      return;
+   header.strings_size = strings_size;
+   header.payload_size = count * sizeof(*records) + strings_size;
+
+   /* Entry is built in memory and written at once.  */
+   records = smalloc(count * sizeof(*records) + strings_size + 1);
+   if(records == NULL)
+      return;
+   area = (char *)(records + count);
+
+   for(int l = 0; l < FCACHE_LISTS; l++)
+   {
+      int index = (body_marks[l] != ILIST_NULL) ?
+                  ilist_index_next(body_marks[l]) : lists[l]->first;
+
+      for(; index != ILIST_NULL; index = ilist_index_next(index))
+         fcache_write_code(&records[i++], ilist_at(index), area, &area_len);
+   }
+   header.checksum = fcache_checksum(&header, records, header.payload_size,
+                                     NULL, 0);
+
+   snprintf(suffix, sizeof(suffix), ".%ld", (long)getpid());
+   tmp_path = fcache_path(suffix);
+   path = fcache_path("");
+   entry = (tmp_path != NULL && path != NULL) ? fopen(tmp_path, "wb") : NULL;
+   if(entry != NULL)
+   {
+      ok = fwrite(&header, sizeof(header), 1, entry) == 1 &&
+           fwrite(records, 1, header.payload_size, entry) ==
+           (size_t)header.payload_size;
+
+      if(fclose(entry) != 0)
+         ok = false;
+      if(!ok || rename(tmp_path, path) != 0)
+         remove(tmp_path);
+   }
+
+   sfree(records);
+   sfree(tmp_path);
+   sfree(path);
+}
+
+/*
+ * Moves the counter in the name created by the generator from the start of
+ * the cached function to the start of the current one.  Counters below the
+ * start belong to names created before the function (shared variables,
+ * parameters of a declaration) and are kept.  Moved name is written to the
+ * space at *free_space, which is advanced past it.  Returns the name to be
+ * used.
+ */
+static char *fcache_rebase_name(char *name, const gen_counters_t *from,
+                                const gen_counters_t *to, char **free_space)
+{
+   char *digits = NULL;             //Start of the counter in the name
+   char *rest;
+   long base;
+   long shift;
+   long counter;
+   size_t len = strlen(name);
+   char *result;
+
+   if(!strncmp(name, FCACHE_ELSE_IF_PREFIX, strlen(FCACHE_ELSE_IF_PREFIX)))
+      digits = name + strlen(FCACHE_ELSE_IF_PREFIX);
+   else if(name[0] == '$' && (name[1] == '$' || isupper((unsigned char)name[1])))
+      digits = name + len;
+   else if(len > 3 && name[1] == 'F' && name[2] == '@')
+   {
+      digits = strrchr(name, '&');
+      if(digits != NULL)
+         digits++;
+      else if(name[3] == '%' || name[3] == '*')
+         digits = name + len;
+   }
+
+   if(digits == NULL)
+      return name;
+
+   /* Trailing counter is found from the end of the name.  */
+   if(digits == name + len)
+   {
+      while(digits > name && isdigit((unsigned char)digits[-1]))
+         digits--;
+   }
+
+   if(name[0] == '$')
+   {
+      base = from->label;
+      shift = (long)to->label - (long)from->label;
+   }
+   else
+   {
+      base = from->unique;
+      shift = (long)to->unique - (long)from->unique;
+   }
+
+   if(!isdigit((unsigned char)*digits))
+      return name;
+   counter = strtol(digits, &rest, 10);
+   if(counter < base || shift == 0)
+      return name;
+
+   result = *free_space;
+   *free_space += sprintf(result, "%.*s%ld%s", (int)(digits - name), name,
+                          counter + shift, rest) + 1;
+
+   return result;
+}
+
+/*
+ * Restores the stored instruction: points its string operands to the area
+ * and rebases their names, rebased names are written to *free_space, which
+ * is NULL if the counters did not move.  Returns false for a damaged record.
+ */
+static bool fcache_read_code(fcache_code_t *record, char *area,
+                             int strings_size, const gen_counters_t *from,
+                             const gen_counters_t *to, char **free_space)
+{
+   code_t *code = &(record->code);
+
+   for(int i = 0; i < 3; i++)
+   {
+      token_t *token = fcache_operand(code, i);
+      int offset = record->strings[i];
+
+      /* Loop labels carry their counter in the type.  */
+      if((token->id == LOOP_BEGIN_ID || token->id == LOOP_END_ID) &&
+         token->type >= (long)from->label)
+         token->type += (long)to->label - (long)from->label;
+
+      if(fcache_operand_kind(code, i, token) == FCACHE_OPERAND_RAW)
+         continue;
+      if(offset <= 0)
+      {
+         token->a.str = NULL;
+         continue;
+      }
+      if(offset > strings_size)
+         return false;
+
+      token->a.str = area + offset - 1;
+      if(*free_space != NULL)
+         token->a.str = fcache_rebase_name(token->a.str, from, to, free_space);
+   }
+
+   return true;
+}
+
+/*
+ * Splices the body stored in the entry to the lists and moves the counters
+ * of the generator after it.  Returns FCACHE_SUCCESS on hit, FCACHE_FAILURE
+ * if the entry is missing, short or its checksum does not match, lists are
+ * not changed then.  Strings
+ * of the body stay in the area read from the entry until memman_clear().
+ */
+static int fcache_load()
+{
+   char *path = fcache_path("");
+   FILE *entry = (path != NULL) ? fopen(path, "rb") : NULL;
+   fcache_header_t header;
+   gen_counters_t counters;
+   fcache_code_t *records = NULL;
+   char *area = NULL;
+   char *rebased = NULL;
+   char *free_space = NULL;
+   size_t records_size = 0;
+   int count = 0;
+   bool ok;
+
+   sfree(path);
+   if(entry == NULL)
+      return FCACHE_FAILURE;
+
+   ok = fread(&header, sizeof(header), 1, entry) == 1 &&
+        header.version == FCACHE_VERSION && header.key == key &&
+        header.counts[0] >= 0 && header.counts[1] >= 0 &&
+        header.strings_size >= 0 && header.payload_size >= header.strings_size;
+
+   /* Counts have to fill the payload before the area exactly.  */
+   if(ok)
+   {
+      records_size = header.payload_size - header.strings_size;
+      count = records_size / sizeof(*records);
+      ok = records_size % sizeof(*records) == 0 &&
+           (long)header.counts[0] + header.counts[1] == count;
+   }
+   if(ok)
+   {
+      records = smalloc(records_size + 1);
+      area = smalloc(header.strings_size + 1);
+      ok = records != NULL && area != NULL &&
+           fread(records, sizeof(*records), count, entry) == (size_t)count &&
+           fread(area, 1, header.strings_size, entry) ==
+           (size_t)header.strings_size;
+   }
+
+   /* Whole entry has to be read, the area ends by a string.  */
+   ok = ok && getc(entry) == EOF &&
+        (header.strings_size == 0 || area[header.strings_size - 1] == '\0') &&
+        fcache_checksum(&header, records, records_size, area,
+                        header.strings_size) == header.checksum;
+   fclose(entry);
+
+   /* Space for names moved by rebasing, if any of the counters moved.  */
+   if(ok && (header.start.unique != start_counters.unique ||
+             header.start.label != start_counters.label))
+   {
+      rebased = smalloc(header.strings_size +
+                        3 * (size_t)count * FCACHE_REBASE_SIZ + 1);
+      free_space = rebased;
+      ok = rebased != NULL;
+   }
+
+   for(int i = 0; i < count && ok; i++)
+      ok = fcache_read_code(&records[i], area, header.strings_size,
+                            &header.start, &start_counters, &free_space);
+
+   for(int i = 0; i < count && ok; i++)
+   {
+      ilist_t *list = lists[(i < header.counts[0]) ? 0 : 1];
+
+      if(ilist_insert_last(list, &(records[i].code)) != ILIST_INSERT_SUCCESS)
+      {
+         internal_error_msg("Failed to allocate memory!\n");
+         RegisterError(INTERNAL_ERR);
+         break;
+      }
+   }
+
+   sfree(records);
+   if(!ok)
+   {
+      sfree(area);
+      sfree(rebased);
+      return FCACHE_FAILURE;
+   }
+
+   counters.unique = start_counters.unique +
+                     (header.end.unique - header.start.unique);
+   counters.label = start_counters.label +
+                    (header.end.label - header.start.label);
+   counters.elsif = header.end.elsif;
+   generator_set_counters(&counters);
+   code_structure = header.code_structure;
+
+   return FCACHE_SUCCESS;
+}
+
+void fcache_function_start()
+{
+   key_valid = false;
+   body_hit = false;
+
+   /* Tokens of the previous function are always consumed.  */
+   if(cache_dir == NULL || queue_pos < queue_count)
+      return;
+
+   generator_get_counters(&start_counters);
+
+   STATS_START(STATS_PHASE_SCANNER);
+   key_valid = fcache_read_ahead();
+   STATS_STOP(STATS_PHASE_SCANNER);
+
+   if(key_valid)
+      key = fcache_hash_function();
+}
+
+void fcache_function_body()
+{
+   if(!key_valid)
+      return;
+
+   for(int l = 0; l < FCACHE_LISTS; l++)
+      body_marks[l] = lists[l]->last;
+
+   if(fcache_load() != FCACHE_SUCCESS)
+   {
+      STATS_COUNT(STATS_FCACHE_MISSES, 1);
+      return;
+   }
+
+   STATS_COUNT(STATS_FCACHE_HITS, 1);
+   body_hit = true;
+
+   /* Parser continues by 'end' of 'end function'.  */
+   queue_pos = queue_count - 2;
+   fcache_next_token(&token);
+}
+
+void fcache_function_end()
+{
+   if(key_valid && !body_hit && status == 0)
+      fcache_store();
+
+   key_valid = false;
+   body_hit = false;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file fcache.h
+ * @brief Function cache for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module keeps generated code of function bodies in a directory, so a
+ * function, which did not change since an earlier compilation, is neither
+ * parsed nor generated again.  When the parser reaches a function definition,
+ * tokens up to its 'end function' are read ahead and hashed together with
+ * everything the body depends on: global symbols referred by its identifiers
+ * (signatures of functions from func_info, shared variables), the expression
+ * backend, the state of the generator and the build of the compiler.  Parser then receives the read
+ * tokens again, so the header of the function is processed as usual.  On a
+ * hit, instructions of the body are spliced to the instruction lists and the
+ * parser continues right by 'end function'.  Entries are stored before the
+ * optimizer runs, so one cache serves both optimized and plain compilation.
+ *
+ * Numbers of temporary variables and labels are rebased from the counters at
+ * the start of the cached function to the current ones.  An edited function
+ * therefore does not invalidate the functions following it and the output is
+ * the same as the output of a compilation without the cache.  Entries are
+ * written to temporary files renamed to their place, so workers of the batch
+ * mode can share the directory.
+ */
+
+#ifndef FCACHE_H_INCLUDED
+#define FCACHE_H_INCLUDED
+
+#include "ifj17_api.h"
+
+/** @brief Function cache success identifier.  */
+#define FCACHE_SUCCESS 0
+
+/** @brief Function cache failure identifier.  */
+#define FCACHE_FAILURE 1
+
+/** @brief Version of the entries, entries of other versions are missed.  */
+#define FCACHE_VERSION 2
+
+/** @brief Extension of the entry files.  */
+#define FCACHE_EXTENSION ".fc"
+
+/** @brief Initial size of the token queue and of the buffers.  */
+#define FCACHE_INIT_SIZ 256
+
+/**
+ * @brief Enables the cache stored in the directory, which is created if it
+ *        does not exist.
+ *
+ * @param *dir Path to the directory, it has to stay valid.
+ * @return FCACHE_SUCCESS or FCACHE_FAILURE if the directory cannot be used.
+ */
+int fcache_open(const char *dir);
+
+/**
+ * @brief Drops the state kept for the current input.  Used between inputs
+ *        of the batch mode, after their memory was released by
+ *        memman_clear().
+ *
+ * @return void.
+ */
+void fcache_reinit();
+
+/**
+ * @brief Returns the next token for the parser, either one read ahead by
+ *        fcache_function_start() or a new one from get_next_token().
+ *
+ * @param *token Token to be filled, fields not set by the scanner are kept.
+ * @return Same as get_next_token().
+ */
+int fcache_next_token(token_t *token);
+
+/**
+ * @brief Called by the parser on the 'function' keyword of a definition.
+ *        Reads the function ahead and looks up its entry.
+ *
+ * @return void.
+ */
+void fcache_function_start();
+
+/**
+ * @brief Called by the parser after the header of the function was
+ *        generated.  On a hit, splices the cached body and skips its tokens,
+ *        the next token is 'end' of 'end function'.
+ *
+ * @return void.
+ */
+void fcache_function_body();
+
+/**
+ * @brief Called by the parser after 'end function' was accepted.  Stores the
+ *        code of a missed body, restores the parser state after a hit.
+ *
+ * @return void.
+ */
+void fcache_function_end();
+
+#endif
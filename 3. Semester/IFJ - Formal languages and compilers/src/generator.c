@@ -13,6 +13,7 @@
 #include "safe_malloc.h"
 #include "scanner.h"
 #include "parser.h"
+#include "emit.h"
 //#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,12 +21,58 @@
 #include <stdarg.h>
 
 
+/*    Global variables section    */
+int expr_backend = EXPR_BACKEND_TAC;
+
+/* Start indices of the code of results left on the data stack, the last one
+ * belongs to the result on the top of the stack
+ */
+static int *stack_starts = NULL;
+static int stack_starts_count = 0;
+static int stack_starts_size = 0;
+
+/* Counter variable for generation of unique temporary variables */
+static int unique_counter = 1;
+
+/* Counters of unique labels of conditions and their ElseIf branches */
+static unsigned int unq_lab_cnt = 1;
+static unsigned int elsif_unq_lab_cnt = 1;
+
+/* Header of the code is printed by the outermost instruction_print() only */
+static int flow_control = 1;
+
 /*    Functions definitions section    */
+void generator_reinit()
+{
+	unique_counter = 1;
+	unq_lab_cnt = 1;
+	elsif_unq_lab_cnt = 1;
+	flow_control = 1;
+	stack_starts = NULL;
+	stack_starts_count = 0;
+	stack_starts_size = 0;
+}
+
+void generator_get_counters(gen_counters_t *counters)
+{
+	counters->unique = unique_counter;
+	counters->label = unq_lab_cnt;
+	counters->elsif = elsif_unq_lab_cnt;
+}
+
+void generator_set_counters(const gen_counters_t *counters)
+{
+	unique_counter = counters->unique;
+	unq_lab_cnt = counters->label;
+	elsif_unq_lab_cnt = counters->elsif;
+}
+
 char *generate(tstack *instruction_stack, int id)
 {
-	/* Counter variable for generation of unique temporary variables */
-	static int unique_counter = 1;
-	/* Auxiliary variables for computing length of unique_counter */
+	/* Auxiliary variables for computing length of unique_counter, it is taken
+	 * again right before the name is created, because conversions of the
+	 * operands increment unique_counter
+	 */
 	int counter_length = 0;
 	int temp_counter = unique_counter;
 	
@@ -51,6 +98,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -115,6 +163,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -167,6 +216,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -219,6 +269,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -282,6 +333,7 @@ char *generate(tstack *instruction_stack, int id)
       }
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -334,6 +386,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -385,6 +438,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -436,6 +490,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -479,6 +534,7 @@ char *generate(tstack *instruction_stack, int id)
 		tstack_pop(instruction_stack);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -528,6 +584,7 @@ char *generate(tstack *instruction_stack, int id)
    token_conversion(code_list, type2_token.id, &tmp2, &unique_counter);
    token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
+   temp_counter = unique_counter;
    while(temp_counter != 0)
    {
       temp_counter /= 10;
@@ -575,6 +632,7 @@ char *generate(tstack *instruction_stack, int id)
    token_conversion(code_list, type2_token.id, &tmp2, &unique_counter);
    token_conversion(code_list, type1_token.id, &tmp1, &unique_counter);
 
+   temp_counter = unique_counter;
    while(temp_counter != 0)
    {
       temp_counter /= 10;
@@ -613,6 +671,7 @@ char *generate(tstack *instruction_stack, int id)
 		tstack_pop(instruction_stack);
 
 		/* Generating the unique name for temporary result variable */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -652,6 +711,7 @@ char *generate(tstack *instruction_stack, int id)
 		/* Setting up result token for stack and instruction generation */
 		tmp1.id = TMP_ID;
 		tmp1.a.str = generate(instruction_stack, EQUALS_ID);
+		tmp1.is_const = false;
 		tstack_push(instruction_stack, &tmp1);
 		
 		return generate(instruction_stack, NOT_ID);
@@ -679,6 +739,7 @@ char *generate(tstack *instruction_stack, int id)
 		/* Computes length of space needed for including counter to the name of
 		 *	variable
 		 */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -743,6 +804,7 @@ char *generate(tstack *instruction_stack, int id)
 		/* Computes length of space needed for including counter to the name of
 		 *	variable
 		 */
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -992,6 +1054,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, conv2_token.id, &step_token, &unique_counter);
 		token_conversion(code_list, conv1_token.id, &expj_token, &unique_counter);
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1258,6 +1321,7 @@ char *generate(tstack *instruction_stack, int id)
 
 		generate_instruction(code_list, CALL_INS_ID, 1, func_name_token);
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1282,6 +1346,40 @@ char *generate(tstack *instruction_stack, int id)
 		return tmp_name;
 	}
 
+	/* Stores result of the stack backend from the data stack to variable */
+	else if(id == STACK_RESULT_ID)
+	{
+		token_t tmp_token;
+
+		tstack_pop(instruction_stack);
+		stack_starts_count--;
+
+		temp_counter = unique_counter;
+		while(temp_counter != 0)
+		{
+			temp_counter /= 10;
+			counter_length++;
+		}
+
+		char *tmp_name = smalloc(counter_length + strlen("LF@%tmp") + 1);
+		if(tmp_name == NULL)
+			return NULL;
+
+		snprintf(tmp_name, counter_length + strlen("LF@%tmp") + 1, "%s%d", 
+					"LF@%tmp", unique_counter);
+
+		tmp_token.id = TMP_ID;
+		tmp_token.a.str = tmp_name;
+		tmp_token.is_const = false;
+
+		generate_instruction(code_list, DEFVAR_INS_ID, 1, tmp_token);
+		generate_instruction(code_list, POPS_INS_ID, 1, tmp_token);
+
+		unique_counter++;
+
+		return tmp_name;
+	}
+
 	else if(id == PARAM_NAME_GEN_ID)
 	{
 		token_t name_token;
@@ -1289,6 +1387,7 @@ char *generate(tstack *instruction_stack, int id)
 		name_token = tstack_top(instruction_stack);
 		tstack_pop(instruction_stack);
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1388,6 +1487,7 @@ char *generate(tstack *instruction_stack, int id)
 		tstack_pop(instruction_stack);
 
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1437,6 +1537,7 @@ char *generate(tstack *instruction_stack, int id)
 		param = tstack_top(instruction_stack);
 		tstack_pop(instruction_stack);
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1476,6 +1577,7 @@ char *generate(tstack *instruction_stack, int id)
 		char_val_token = tstack_top(instruction_stack);
 		tstack_pop(instruction_stack);
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1526,6 +1628,7 @@ char *generate(tstack *instruction_stack, int id)
 		pos_token = tstack_top(instruction_stack);
 		tstack_pop(instruction_stack);
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1556,6 +1659,7 @@ char *generate(tstack *instruction_stack, int id)
 
 		str_len_token.id = TMP_ID;
 		str_len_token.a.str = str_len;
+		str_len_token.is_const = false;
 		int0_token.type = INTEGER_ID;
 		int0_token.is_const = true;
 		int0_token.a.val_int = 0;
@@ -1577,7 +1681,7 @@ char *generate(tstack *instruction_stack, int id)
 		generate_instruction(code_list, STRLEN_INS_ID, 2, str_token, 
 									str_len_token); 
 		generate_instruction(code_list, PUSHS_INS_ID, 1, pos_token);
-		if(conv_pos_token.type == INTEGER_ID)
+		if(conv_pos_token.id == INTEGER_ID)
 			generate_instruction(code_list, FLOAT2R2EINTS_INS_ID, 0);
 		generate_instruction(code_list, PUSHS_INS_ID, 1, str_len_token);
 		generate_instruction(code_list, GTS_INS_ID, 0);
@@ -1647,6 +1751,7 @@ char *generate(tstack *instruction_stack, int id)
 		token_conversion(code_list, pos_conv_token.id, &pos_token, &unique_counter);
 
 
+		temp_counter = unique_counter;
 		while(temp_counter != 0)
 		{
 			temp_counter /= 10;
@@ -1943,6 +2048,181 @@ char *generate(tstack *instruction_stack, int id)
 	return NIL;
 }
 
+bool is_stack_result(token_t *token)
+{
+	return !token->is_const && token->a.str != NULL && 
+			 !strcmp(token->a.str, STACK_RESULT);
+}
+
+/* Inserts stack instruction in front of the instruction on index before or
+ * to the end of the code list if before is ILIST_NULL, returns its index
+ */
+static int stack_instruction(int before, int type, token_t *operand)
+{
+	code_t new_code = {0};
+
+	new_code.operation_type = type;
+	if(operand != NULL)
+		new_code.first_operand = *operand;
+
+	if(before == ILIST_NULL)
+	{
+		if(ilist_insert_last(code_list, &new_code))
+			return ILIST_NULL;
+
+		return code_list->last;
+	}
+
+	ilist_set_active(code_list, before);
+	if(ilist_pre_insert(code_list, &new_code))
+		return ILIST_NULL;
+
+	return ilist_index_prev(before);
+}
+
+/* Pushes operand which is not on the data stack yet and converts it, returns
+ * index of the first generated instruction or ILIST_NULL
+ */
+static int stack_operand(token_t *operand, int conv_id, bool on_stack, 
+								 int id, int before)
+{
+	int first = ILIST_NULL;
+	int index;
+
+	if(!on_stack)
+		first = stack_instruction(before, PUSHS_INS_ID, operand);
+
+	/* Literals of integer division are rounded in expr already */
+	if(id == BACKSLASH_ID && operand->is_const)
+		return first;
+
+	if(conv_id == INTEGER_ID)
+	{
+		index = stack_instruction(before, FLOAT2R2EINTS_INS_ID, NULL);
+		first = (first == ILIST_NULL) ? index : first;
+	}
+	else if(conv_id == DOUBLE_ID)
+	{
+		index = stack_instruction(before, INT2FLOATS_INS_ID, NULL);
+		first = (first == ILIST_NULL) ? index : first;
+	}
+
+	if(id == BACKSLASH_ID)
+	{
+		index = stack_instruction(before, INT2FLOATS_INS_ID, NULL);
+		first = (first == ILIST_NULL) ? index : first;
+	}
+
+	return first;
+}
+
+/* Determines if the code from index start to the end of the list calls a
+ * function
+ */
+static bool stack_has_call(int start)
+{
+	for(int index = start; index != ILIST_NULL; 
+		 index = ilist_index_next(index))
+	{
+		if(ilist_at(index)->operation_type == CALL_INS_ID)
+			return true;
+	}
+
+	return false;
+}
+
+char *generate_stack(tstack *instruction_stack, int id)
+{
+	token_t left, right, left_conv, right_conv;
+
+	/* Operands are on the instruction stack in the same order as for
+	 * generate(), left operand is the one printed first by instruction_print()
+	 */
+	left_conv = tstack_top(instruction_stack);
+	tstack_pop(instruction_stack);
+	right_conv = tstack_top(instruction_stack);
+	tstack_pop(instruction_stack);
+	left = tstack_top(instruction_stack);
+	tstack_pop(instruction_stack);
+	right = tstack_top(instruction_stack);
+	tstack_pop(instruction_stack);
+
+	bool left_stack = is_stack_result(&left);
+	bool right_stack = is_stack_result(&right);
+	int left_start = ILIST_NULL;
+	int right_start = ILIST_NULL;
+
+	if(right_stack)
+		right_start = stack_starts[stack_starts_count - 1];
+
+	/* Global variable pushed in front of the right operand could be changed
+	 * by a function called in it, so the right operand is stored first
+	 */
+	if(right_stack && !left_stack && !left.is_const &&
+		!strncmp(left.a.str, "GF@", 3) && stack_has_call(right_start))
+	{
+		if(tstack_push(instruction_stack, &right))
+			return NULL;
+
+		right.a.str = generate(instruction_stack, STACK_RESULT_ID);
+		if(right.a.str == NULL)
+			return NULL;
+
+		right_stack = false;
+	}
+
+	if(right_stack)
+		stack_starts_count--;
+
+	if(left_stack)
+		left_start = stack_starts[--stack_starts_count];
+
+	/* Left operand has to get to the stack before the code of the right one */
+	int first = stack_operand(&left, left_conv.id, left_stack, id, 
+									  right_stack ? right_start : ILIST_NULL);
+	if(left_stack)
+		first = left_start;
+
+	stack_operand(&right, right_conv.id, right_stack, id, ILIST_NULL);
+
+	if(id == PLUS_ID)
+		stack_instruction(ILIST_NULL, ADDS_INS_ID, NULL);
+	else if(id == MINUS_ID)
+		stack_instruction(ILIST_NULL, SUBS_INS_ID, NULL);
+	else if(id == ASTERISK_ID)
+		stack_instruction(ILIST_NULL, MULS_INS_ID, NULL);
+	else if(id == SLASH_ID)
+		stack_instruction(ILIST_NULL, DIVS_INS_ID, NULL);
+	else if(id == BACKSLASH_ID)
+	{
+		stack_instruction(ILIST_NULL, DIVS_INS_ID, NULL);
+		stack_instruction(ILIST_NULL, FLOAT2R2EINTS_INS_ID, NULL);
+	}
+	else if(id == LESS_ID || id == GREATER_EQUAL_ID)
+		stack_instruction(ILIST_NULL, LTS_INS_ID, NULL);
+	else if(id == GREATER_ID || id == LESS_EQUAL_ID)
+		stack_instruction(ILIST_NULL, GTS_INS_ID, NULL);
+	else if(id == EQUALS_ID || id == NOT_EQUAL_ID)
+		stack_instruction(ILIST_NULL, EQS_INS_ID, NULL);
+
+	/* Relations without own instruction are negations of the opposite ones */
+	if(id == GREATER_EQUAL_ID || id == LESS_EQUAL_ID || id == NOT_EQUAL_ID)
+		stack_instruction(ILIST_NULL, NOTS_INS_ID, NULL);
+
+	if(stack_starts_count == stack_starts_size)
+	{
+		int *new_starts = srealloc(stack_starts, 
+											(2 * stack_starts_size + 8) * sizeof(int));
+		if(new_starts == NULL)
+			return NULL;
+
+		stack_starts = new_starts;
+		stack_starts_size = 2 * stack_starts_size + 8;
+	}
+	stack_starts[stack_starts_count++] = first;
+
+	return STACK_RESULT;
+}
 
 
 
@@ -1956,24 +2236,25 @@ void generate_instruction(ilist_t *code_list, int type, int num,  ...)
 
 	token_t tmp_token[3];
 
+	/* Unused operands are zeroed, so the instruction can be copied as is */
+	memset(tmp_token, 0, sizeof(tmp_token));
 
 	for(int i = 0; i < num; i++)
 	{
 		tmp_token[i] = va_arg(args, token_t);
 	}
 
-	code_t *new_code = smalloc(sizeof(code_t));
-	if(new_code == NULL)
-	{
-		return;
-	}
+	va_end(args);
 
-	new_code->operation_type = type;
-	new_code->first_operand = tmp_token[0];
-	new_code->second_operand = tmp_token[1];
-	new_code->third_operand = tmp_token[2];
+	/* Instruction is copied into the list, no allocation is needed */
+	code_t new_code;
 
-	if(ilist_insert_last(code_list, new_code))
+	new_code.operation_type = type;
+	new_code.first_operand = tmp_token[0];
+	new_code.second_operand = tmp_token[1];
+	new_code.third_operand = tmp_token[2];
+
+	if(ilist_insert_last(code_list, &new_code))
 	{
 		return;
 	}
@@ -1981,8 +2262,6 @@ void generate_instruction(ilist_t *code_list, int type, int num,  ...)
 
 void generate_label(tstack *instruction_stack, int id)
 {
-	static unsigned int unq_lab_cnt = 1;
-	static unsigned int elsif_unq_lab_cnt = 1;
 	int cnt_length_lab = 0;
 	int cnt_length_elsif = 0;
 	int temp_cnt_lab = unq_lab_cnt;
@@ -2354,1057 +2633,1096 @@ void generate_label(tstack *instruction_stack, int id)
 
 void instruction_print(ilist_t *instructs)
 {
-   static int flow_control = 1;
-   ilist_elem_t *tmp_list_ptr = instructs->first;
+   code_t *tmp_code = ilist_copy_first(instructs);
 
 
    if(flow_control)
    {
       flow_control = 0;
-      printf("%s\n", ".IFJcode17");
+      emit_format("%s\n", ".IFJcode17");
       instruction_print(&global_var_ilist);
-      if(tmp_list_ptr->data.operation_type != LABEL_MAIN)
-         printf("%s\n", "JUMP $$MAIN");
+      if(tmp_code->operation_type != LABEL_MAIN)
+         emit_format("%s\n", "JUMP $$MAIN");
    }
-	while(instructs->first != NULL)
+	while(ilist_empty(instructs) == ILIST_NOT_EMPTY)
 	{
-		tmp_list_ptr = instructs->first;
+		tmp_code = ilist_copy_first(instructs);
 
 		/*ADD <var> <symb1> >symb2> instruction*/
-		if(tmp_list_ptr->data.operation_type == ADD_INS_ID )
+		if(tmp_code->operation_type == ADD_INS_ID )
 		{
-			printf("%s ", "ADD");
+			emit_format("%s ", "ADD");
 
-			printf("%s ", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s ", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.is_const)
 			{
-				if(tmp_list_ptr->data.second_operand.type == INTEGER_ID)
+				if(tmp_code->second_operand.type == INTEGER_ID)
 				{
-					printf("%s%d ", "int@", 
-							tmp_list_ptr->data.second_operand.a.val_int);
+					emit_format("%s%d ", "int@", 
+							tmp_code->second_operand.a.val_int);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID)
+				else if(tmp_code->second_operand.type == DOUBLE_ID)
 				{
-					printf("%s%g ", "float@", 
-							tmp_list_ptr->data.second_operand.a.val_real);
+					emit_format("%s%g ", "float@", 
+							tmp_code->second_operand.a.val_real);
 				}
 			}
 			else
 			{
-					printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+					emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.is_const)
 			{
-				if(tmp_list_ptr->data.first_operand.type == INTEGER_ID)
+				if(tmp_code->first_operand.type == INTEGER_ID)
 				{
-					printf("%s%d\n", "int@", 
-							tmp_list_ptr->data.first_operand.a.val_int);
+					emit_format("%s%d\n", "int@", 
+							tmp_code->first_operand.a.val_int);
 				}
-				else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID)
+				else if(tmp_code->first_operand.type == DOUBLE_ID)
 				{
-					printf("%s%g\n", "float@", 
-							tmp_list_ptr->data.first_operand.a.val_real);
+					emit_format("%s%g\n", "float@", 
+							tmp_code->first_operand.a.val_real);
 				}
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 		}
-		//else if(tmp_list_ptr->data.operation_type == ADDS_INS_ID )
-		//else if(tmp_list_ptr->data.operation_type == AND_INS_ID )
-		//else if(tmp_list_ptr->data.operation_type == ANDS_INS_ID )
-		//else if(tmp_list_ptr->data.operation_type == BREAK_INS_ID )
+		/*ADDS stack instruction*/
+		else if(tmp_code->operation_type == ADDS_INS_ID )
+		{
+			emit_format("%s\n", "ADDS");
+		}
+		//else if(tmp_code->operation_type == AND_INS_ID )
+		//else if(tmp_code->operation_type == ANDS_INS_ID )
+		//else if(tmp_code->operation_type == BREAK_INS_ID )
 		/*CALL <label> instruction*/
-		else if(tmp_list_ptr->data.operation_type == CALL_INS_ID )
+		else if(tmp_code->operation_type == CALL_INS_ID )
 		{
-			printf("%s %s\n", "CALL", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "CALL", tmp_code->first_operand.a.str);
 		}
 		/*CLEARS instruction*/
-		else if(tmp_list_ptr->data.operation_type == CLEARS_INS_ID )
+		else if(tmp_code->operation_type == CLEARS_INS_ID )
 		{
-			printf("%s\n", "CLEARS");
+			emit_format("%s\n", "CLEARS");
 		}
 		/*CONCAT instruction*/
-		else if(tmp_list_ptr->data.operation_type == CONCAT_INS_ID )
+		else if(tmp_code->operation_type == CONCAT_INS_ID )
 		{
-			printf("%s ", "CONCAT");
+			emit_format("%s ", "CONCAT");
 
-			printf("%s ", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s ", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == 
-				STRING_ID && tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == 
+				STRING_ID && tmp_code->second_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-				printf("%s%s ", "string@", tmp_list_ptr->data.second_operand.a.str);
+            //string_convert(&tmp_code->second_operand.a.str);
+				emit_format("%s%s ", "string@", tmp_code->second_operand.a.str);
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == STRING_ID && 
+				tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 		}
 		/*CREATEFRAME instruction*/
-		else if(tmp_list_ptr->data.operation_type == CREATEFRAME_INS_ID )
+		else if(tmp_code->operation_type == CREATEFRAME_INS_ID )
 		{
-			printf("%s\n", "CREATEFRAME");
+			emit_format("%s\n", "CREATEFRAME");
 		}
 		/*DEFVAR <var> instruction*/
-		else if(tmp_list_ptr->data.operation_type == DEFVAR_INS_ID )
+		else if(tmp_code->operation_type == DEFVAR_INS_ID )
 		{
-			printf("%s %s\n", "DEFVAR", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "DEFVAR", tmp_code->first_operand.a.str);
 		}
 		/*DIV <var> <symb1> >symb2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == DIV_INS_ID )
+		else if(tmp_code->operation_type == DIV_INS_ID )
 		{
-			printf("%s %s ", "DIV", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "DIV", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == 
-				INTEGER_ID && tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == 
+				INTEGER_ID && tmp_code->second_operand.is_const)
 			{
-				printf("%s%d ", "int@", tmp_list_ptr->data.second_operand.a.val_int);
+				emit_format("%s%d ",
+					"int@", tmp_code->second_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == DOUBLE_ID && 
+						tmp_code->second_operand.is_const)
 			{
-				printf("%s%g ", "float@", 
-							tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g ", "float@", 
+							tmp_code->second_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n",
+					"int@", tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-						tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+						tmp_code->first_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 		}
-		//else if(tmp_list_ptr->data->operation_type == DIVS_INS_ID )
-		//else if(tmp_list_ptr->data->operation_type == DPRINT_INS_ID )
+		/*DIVS stack instruction*/
+		else if(tmp_code->operation_type == DIVS_INS_ID )
+		{
+			emit_format("%s\n", "DIVS");
+		}
+		//else if(tmp_code->operation_type == DPRINT_INS_ID )
 		/*EQ <var> <symb1> >symb2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == EQ_INS_ID )
+		else if(tmp_code->operation_type == EQ_INS_ID )
 		{
-			printf("%s %s ", "EQ", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "EQ", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d ", "int@", tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d ", "int@", tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g ", "float@", tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g ",
+					"float@", tmp_code->first_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == STRING_ID && 
+						tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s ", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s ", "string@", tmp_code->first_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.first_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->first_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s ", "bool@true");
+				emit_format("%s ", "bool@true");
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				if(tmp_list_ptr->data.first_operand.a.val_bool)
+				if(tmp_code->first_operand.a.val_bool)
 				{
-					printf("%s ", "bool@true");
+					emit_format("%s ", "bool@true");
 				}
 				else
 				{
-					printf("%s ", "bool@false");
+					emit_format("%s ", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s ", tmp_code->first_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.second_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == INTEGER_ID && 
+				tmp_code->second_operand.is_const)
 			{
-				printf("%s%d\n", "int@", tmp_list_ptr->data.second_operand.a.val_int);
+				emit_format("%s%d\n",
+					"int@", tmp_code->second_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == DOUBLE_ID && 
+						tmp_code->second_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-							tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+							tmp_code->second_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == 
-						STRING_ID && tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == 
+						STRING_ID && tmp_code->second_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-				printf("%s%s\n", "string@", tmp_list_ptr->data.second_operand.a.str);
+            //string_convert(&tmp_code->second_operand.a.str);
+				emit_format("%s%s\n",
+					"string@", tmp_code->second_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.second_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->second_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s\n", "bool@true");
+				emit_format("%s\n", "bool@true");
 			}
-			else if(tmp_list_ptr->data.second_operand.type == 
-						DOUBLE_ID && tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == 
+						DOUBLE_ID && tmp_code->second_operand.is_const)
 			{
-				if(tmp_list_ptr->data.second_operand.a.val_bool)
+				if(tmp_code->second_operand.a.val_bool)
 				{
-					printf("%s\n", "bool@true");
+					emit_format("%s\n", "bool@true");
 				}
 				else
 				{
-					printf("%s\n", "bool@false");
+					emit_format("%s\n", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s\n", tmp_code->second_operand.a.str);
 			}
 		}
-		//else if(tmp_list_ptr->data->operation_type == EQS_INS_ID )
-		//else if(tmp_list_ptr->data->operation_type == FLOAT2INT_INS_ID )
-		//else if(tmp_list_ptr->data->operation_type == FLOAT2INTS_INS_ID )
+		/*EQS stack instruction*/
+		else if(tmp_code->operation_type == EQS_INS_ID )
+		{
+			emit_format("%s\n", "EQS");
+		}
+		//else if(tmp_code->operation_type == FLOAT2INT_INS_ID )
+		//else if(tmp_code->operation_type == FLOAT2INTS_INS_ID )
 		/*FLOAT2R2EINT <var> <symb> instruction*/
-		else if(tmp_list_ptr->data.operation_type == FLOAT2R2EINT_INS_ID )
+		else if(tmp_code->operation_type == FLOAT2R2EINT_INS_ID )
 		{
-			printf("%s %s %s\n", "FLOAT2R2EINT", 
-					tmp_list_ptr->data.first_operand.a.str, 
-					tmp_list_ptr->data.second_operand.a.str);
+			emit_format("%s %s %s\n", "FLOAT2R2EINT", 
+					tmp_code->first_operand.a.str, 
+					tmp_code->second_operand.a.str);
 		}
 		/*FLOAT2R2EINTS stack instruction*/
-		else if(tmp_list_ptr->data.operation_type == FLOAT2R2EINTS_INS_ID )
+		else if(tmp_code->operation_type == FLOAT2R2EINTS_INS_ID )
 		{
-			printf("%s\n", "FLOAT2R2EINTS");
+			emit_format("%s\n", "FLOAT2R2EINTS");
 		}
-		//else if(tmp_list_ptr->data->operation_type == FLOAT2R2OINT_INS_ID )
-		//else if(tmp_list_ptr->data->operation_type == FLOAT2R2OINTS_INS_ID )
+		//else if(tmp_code->operation_type == FLOAT2R2OINT_INS_ID )
+		//else if(tmp_code->operation_type == FLOAT2R2OINTS_INS_ID )
 		/*GETCHAR <var> <symb1> <symb2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == GETCHAR_INS_ID )
+		else if(tmp_code->operation_type == GETCHAR_INS_ID )
 		{
-			printf("%s %s ", "GETCHAR", 
-					tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "GETCHAR", 
+					tmp_code->third_operand.a.str);
 
-         if(tmp_list_ptr->data.second_operand.type == 
-            INTEGER_ID && tmp_list_ptr->data.second_operand.is_const)
+         if(tmp_code->second_operand.type == 
+            INTEGER_ID && tmp_code->second_operand.is_const)
          {
-            printf("%s%d ", "int@", tmp_list_ptr->data.second_operand.a.val_int);
+            emit_format("%s%d ", "int@", tmp_code->second_operand.a.val_int);
          }
-         else if(tmp_list_ptr->data.second_operand.type == 
-                  DOUBLE_ID && tmp_list_ptr->data.second_operand.is_const)
+         else if(tmp_code->second_operand.type == 
+                  DOUBLE_ID && tmp_code->second_operand.is_const)
          {
-            printf("%s%g ", "float@", 
-                  tmp_list_ptr->data.second_operand.a.val_real);
+            emit_format("%s%g ", "float@", 
+                  tmp_code->second_operand.a.val_real);
          }
-         else if(tmp_list_ptr->data.second_operand.type == STRING_ID && 
-                  tmp_list_ptr->data.second_operand.is_const)
+         else if(tmp_code->second_operand.type == STRING_ID && 
+                  tmp_code->second_operand.is_const)
          {
-            //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-            printf("%s%s ", "string@", tmp_list_ptr->data.second_operand.a.str);
+            //string_convert(&tmp_code->second_operand.a.str);
+            emit_format("%s%s ", "string@", tmp_code->second_operand.a.str);
          }
-         else if(tmp_list_ptr->data.second_operand.id == TOKEN_TRUE_ID)
+         else if(tmp_code->second_operand.id == TOKEN_TRUE_ID)
          {
-            printf("%s ", "bool@true");
+            emit_format("%s ", "bool@true");
          }
-         else if(tmp_list_ptr->data.second_operand.type == BOOLEAN_ID && 
-                  tmp_list_ptr->data.second_operand.is_const)
+         else if(tmp_code->second_operand.type == BOOLEAN_ID && 
+                  tmp_code->second_operand.is_const)
          {
-            if(tmp_list_ptr->data.second_operand.a.val_bool)
+            if(tmp_code->second_operand.a.val_bool)
             {
-               printf("%s ", "bool@true");
+               emit_format("%s ", "bool@true");
             }
             else
             {
-               printf("%s ", "bool@false");
+               emit_format("%s ", "bool@false");
             }
          }
          else
          {
-            printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+            emit_format("%s ", tmp_code->second_operand.a.str);
          }
 
-         if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-            tmp_list_ptr->data.first_operand.is_const)
+         if(tmp_code->first_operand.type == INTEGER_ID && 
+            tmp_code->first_operand.is_const)
          {
-            printf("%s%d\n", "int@", tmp_list_ptr->data.first_operand.a.val_int);
+            emit_format("%s%d\n", "int@", tmp_code->first_operand.a.val_int);
          }
-         else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-                  tmp_list_ptr->data.first_operand.is_const)
+         else if(tmp_code->first_operand.type == DOUBLE_ID && 
+                  tmp_code->first_operand.is_const)
          {
-            printf("%s%g\n", "float@", tmp_list_ptr->data.first_operand.a.val_real);
+            emit_format("%s%g\n", "float@", tmp_code->first_operand.a.val_real);
          }
-         else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-                  tmp_list_ptr->data.first_operand.is_const)
+         else if(tmp_code->first_operand.type == STRING_ID && 
+                  tmp_code->first_operand.is_const)
          {
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-            printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+            emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
          }
-         else if(tmp_list_ptr->data.first_operand.id == TOKEN_TRUE_ID)
+         else if(tmp_code->first_operand.id == TOKEN_TRUE_ID)
          {
-            printf("%s\n", "bool@true");
+            emit_format("%s\n", "bool@true");
          }
-         else if(tmp_list_ptr->data.first_operand.type == 
-                  BOOLEAN_ID && tmp_list_ptr->data.first_operand.is_const)
+         else if(tmp_code->first_operand.type == 
+                  BOOLEAN_ID && tmp_code->first_operand.is_const)
          {
-            if(tmp_list_ptr->data.first_operand.a.val_bool)
+            if(tmp_code->first_operand.a.val_bool)
             {
-               printf("%s\n", "bool@true");
+               emit_format("%s\n", "bool@true");
             }
             else
             {
-               printf("%s\n", "bool@false");
+               emit_format("%s\n", "bool@false");
             }
          }
          else
          {
-            printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+            emit_format("%s\n", tmp_code->first_operand.a.str);
          }
       
 		}
 		/*GT <var> <symb1> >symb2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == GT_INS_ID )
+		else if(tmp_code->operation_type == GT_INS_ID )
 			{
-			printf("%s %s ", "GT", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "GT", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == 
-				INTEGER_ID && tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == 
+				INTEGER_ID && tmp_code->second_operand.is_const)
 			{
-				printf("%s%d ", "int@", tmp_list_ptr->data.second_operand.a.val_int);
+				emit_format("%s%d ",
+					"int@", tmp_code->second_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == 
-						DOUBLE_ID && tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == 
+						DOUBLE_ID && tmp_code->second_operand.is_const)
 			{
-				printf("%s%g ", "float@", 
-						tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g ", "float@", 
+						tmp_code->second_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == STRING_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == STRING_ID && 
+						tmp_code->second_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-				printf("%s%s ", "string@", tmp_list_ptr->data.second_operand.a.str);
+            //string_convert(&tmp_code->second_operand.a.str);
+				emit_format("%s%s ", "string@", tmp_code->second_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.second_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->second_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s ", "bool@true");
+				emit_format("%s ", "bool@true");
 			}
-			else if(tmp_list_ptr->data.second_operand.type == BOOLEAN_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == BOOLEAN_ID && 
+						tmp_code->second_operand.is_const)
 			{
-				if(tmp_list_ptr->data.second_operand.a.val_bool)
+				if(tmp_code->second_operand.a.val_bool)
 				{
-					printf("%s ", "bool@true");
+					emit_format("%s ", "bool@true");
 				}
 				else
 				{
-					printf("%s ", "bool@false");
+					emit_format("%s ", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n",
+					"int@", tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n",
+					"float@", tmp_code->first_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == STRING_ID && 
+						tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.first_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->first_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s\n", "bool@true");
+				emit_format("%s\n", "bool@true");
 			}
-			else if(tmp_list_ptr->data.first_operand.type == 
-						BOOLEAN_ID && tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == 
+						BOOLEAN_ID && tmp_code->first_operand.is_const)
 			{
-				if(tmp_list_ptr->data.first_operand.a.val_bool)
+				if(tmp_code->first_operand.a.val_bool)
 				{
-					printf("%s\n", "bool@true");
+					emit_format("%s\n", "bool@true");
 				}
 				else
 				{
-					printf("%s\n", "bool@false");
+					emit_format("%s\n", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 		}
 		/*GTS stack instruction*/
-		else if(tmp_list_ptr->data.operation_type == GTS_INS_ID )
+		else if(tmp_code->operation_type == GTS_INS_ID )
 		{
-			printf("%s\n", "GTS");
+			emit_format("%s\n", "GTS");
 		}
 		/*INT2FLOAT <var> <symb> instruction*/
-		else if(tmp_list_ptr->data.operation_type == INT2FLOAT_INS_ID )
+		else if(tmp_code->operation_type == INT2FLOAT_INS_ID )
+		{
+			emit_format("%s %s %s\n", "INT2FLOAT", 
+					tmp_code->first_operand.a.str, 
+					tmp_code->second_operand.a.str);
+		}
+		/*INT2FLOATS stack instruction*/
+		else if(tmp_code->operation_type == INT2FLOATS_INS_ID )
 		{
-			printf("%s %s %s\n", "INT2FLOAT", 
-					tmp_list_ptr->data.first_operand.a.str, 
-					tmp_list_ptr->data.second_operand.a.str);
+			emit_format("%s\n", "INT2FLOATS");
 		}
-		//else if(tmp_list_ptr->data->operation_type == INT2FLOATS_INS_ID )
-		//else if(tmp_list_ptr->data->operation_type == INT2CHAR_INS_ID )
+		//else if(tmp_code->operation_type == INT2CHAR_INS_ID )
 		/*INT2CHARS stack instruction*/
-		else if(tmp_list_ptr->data.operation_type == INT2CHARS_INS_ID )
+		else if(tmp_code->operation_type == INT2CHARS_INS_ID )
 		{
-			printf("%s\n", "INT2CHARS");
+			emit_format("%s\n", "INT2CHARS");
 		}
 
 		/*JUMP <label> instruction*/
-		else if(tmp_list_ptr->data.operation_type == JUMP_INS_ID )
+		else if(tmp_code->operation_type == JUMP_INS_ID )
 		{
-			printf("%s %s\n", "JUMP", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "JUMP", tmp_code->first_operand.a.str);
 		}
 		/*JUMPIFEQ <label> <symbol1> <symbol2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == JUMPIFEQ_INS_ID )
+		else if(tmp_code->operation_type == JUMPIFEQ_INS_ID )
 		{
-			if(tmp_list_ptr->data.second_operand.type == BOOLEAN_ID && 
-				tmp_list_ptr->data.second_operand.is_const && 
-				tmp_list_ptr->data.third_operand.type == BOOLEAN_ID &&
-				tmp_list_ptr->data.third_operand.is_const)
+			if(tmp_code->second_operand.type == BOOLEAN_ID && 
+				tmp_code->second_operand.is_const && 
+				tmp_code->third_operand.type == BOOLEAN_ID &&
+				tmp_code->third_operand.is_const)
 			{
-				if(tmp_list_ptr->data.second_operand.a.val_bool && 
-					tmp_list_ptr->data.third_operand.a.val_bool)
+				if(tmp_code->second_operand.a.val_bool && 
+					tmp_code->third_operand.a.val_bool)
 				{
-					printf("%s %s\n", "JUMP", tmp_list_ptr->data.first_operand.a.str);
+					emit_format("%s %s\n",
+						"JUMP", tmp_code->first_operand.a.str);
 				}
 			}
 			else
 			{
-				printf("%s %s ", "JUMPIFEQ", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s %s ",
+					"JUMPIFEQ", tmp_code->first_operand.a.str);
 
-				if(tmp_list_ptr->data.second_operand.type == INTEGER_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				if(tmp_code->second_operand.type == INTEGER_ID &&
+					tmp_code->second_operand.is_const)
 				{
-					printf("int@%d ", tmp_list_ptr->data.second_operand.a.val_int);
+					emit_format("int@%d ", tmp_code->second_operand.a.val_int);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				else if(tmp_code->second_operand.type == DOUBLE_ID &&
+					tmp_code->second_operand.is_const)
 				{
-					printf("float@%g ", tmp_list_ptr->data.second_operand.a.val_real);
+					emit_format("float@%g ",
+						tmp_code->second_operand.a.val_real);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == STRING_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				else if(tmp_code->second_operand.type == STRING_ID &&
+					tmp_code->second_operand.is_const)
 				{
-               //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-					printf("string@%s ", tmp_list_ptr->data.second_operand.a.str);
+               //string_convert(&tmp_code->second_operand.a.str);
+					emit_format("string@%s ", tmp_code->second_operand.a.str);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == BOOLEAN_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				else if(tmp_code->second_operand.type == BOOLEAN_ID &&
+					tmp_code->second_operand.is_const)
 				{
-					if(tmp_list_ptr->data.second_operand.a.val_bool)
+					if(tmp_code->second_operand.a.val_bool)
 					{
-						printf("%s ", "bool@true");
+						emit_format("%s ", "bool@true");
 					}
 					else
 					{
-						printf("%s ", "bool@false");
+						emit_format("%s ", "bool@false");
 					}
 				}
 				else
 				{
-					printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+					emit_format("%s ", tmp_code->second_operand.a.str);
 				}
 
 
-				if(tmp_list_ptr->data.third_operand.type == INTEGER_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				if(tmp_code->third_operand.type == INTEGER_ID &&
+					tmp_code->third_operand.is_const)
 				{
-					printf("int@%d\n", tmp_list_ptr->data.third_operand.a.val_int);
+					emit_format("int@%d\n", tmp_code->third_operand.a.val_int);
 				}
-				else if(tmp_list_ptr->data.third_operand.type == DOUBLE_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				else if(tmp_code->third_operand.type == DOUBLE_ID &&
+					tmp_code->third_operand.is_const)
 				{
-					printf("float@%g\n", tmp_list_ptr->data.third_operand.a.val_real);
+					emit_format("float@%g\n",
+						tmp_code->third_operand.a.val_real);
 				}
-				else if(tmp_list_ptr->data.third_operand.type == STRING_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				else if(tmp_code->third_operand.type == STRING_ID &&
+					tmp_code->third_operand.is_const)
 				{
-               //string_convert(&tmp_list_ptr->data.third_operand.a.str);
-					printf("string@%s\n", tmp_list_ptr->data.third_operand.a.str);
+               //string_convert(&tmp_code->third_operand.a.str);
+					emit_format("string@%s\n", tmp_code->third_operand.a.str);
 				}
-				else if(tmp_list_ptr->data.third_operand.type == BOOLEAN_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				else if(tmp_code->third_operand.type == BOOLEAN_ID &&
+					tmp_code->third_operand.is_const)
 				{
-					if(tmp_list_ptr->data.third_operand.a.val_bool)
+					if(tmp_code->third_operand.a.val_bool)
 					{
-						printf("%s\n", "bool@true");
+						emit_format("%s\n", "bool@true");
 					}
 					else
 					{
-						printf("%s\n", "bool@false");
+						emit_format("%s\n", "bool@false");
 					}
 				}
 				else
 				{
-					printf("%s\n", tmp_list_ptr->data.third_operand.a.str);
+					emit_format("%s\n", tmp_code->third_operand.a.str);
 				}
 			}
 		}
 		/*JUMPIFEQS stack instruction*/
-		else if(tmp_list_ptr->data.operation_type == JUMPIFEQS_INS_ID )
+		else if(tmp_code->operation_type == JUMPIFEQS_INS_ID )
 		{
-			printf("%s %s\n", "JUMPIFEQS", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "JUMPIFEQS", tmp_code->first_operand.a.str);
 		}
 		/*JUMPIFNEQ <label> <symbol1> <symbol2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == JUMPIFNEQ_INS_ID )
+		else if(tmp_code->operation_type == JUMPIFNEQ_INS_ID )
 		{
-			if(tmp_list_ptr->data.second_operand.type == BOOLEAN_ID && 
-				tmp_list_ptr->data.second_operand.is_const && 
-				tmp_list_ptr->data.third_operand.type == BOOLEAN_ID &&
-				tmp_list_ptr->data.third_operand.is_const)
+			if(tmp_code->second_operand.type == BOOLEAN_ID && 
+				tmp_code->second_operand.is_const && 
+				tmp_code->third_operand.type == BOOLEAN_ID &&
+				tmp_code->third_operand.is_const)
 			{
-				if(tmp_list_ptr->data.second_operand.a.val_bool ^ 
-					tmp_list_ptr->data.third_operand.a.val_bool)
+				if(tmp_code->second_operand.a.val_bool ^ 
+					tmp_code->third_operand.a.val_bool)
 				{
-					printf("%s %s\n", "JUMP", tmp_list_ptr->data.first_operand.a.str);
+					emit_format("%s %s\n",
+						"JUMP", tmp_code->first_operand.a.str);
 				}
 			}
 			else
 			{
-				printf("%s %s ", "JUMPIFNEQ", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s %s ",
+					"JUMPIFNEQ", tmp_code->first_operand.a.str);
 
-				if(tmp_list_ptr->data.second_operand.type == INTEGER_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				if(tmp_code->second_operand.type == INTEGER_ID &&
+					tmp_code->second_operand.is_const)
 				{
-					printf("int@%d ", tmp_list_ptr->data.second_operand.a.val_int);
+					emit_format("int@%d ", tmp_code->second_operand.a.val_int);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				else if(tmp_code->second_operand.type == DOUBLE_ID &&
+					tmp_code->second_operand.is_const)
 				{
-					printf("float@%g ", tmp_list_ptr->data.second_operand.a.val_real);
+					emit_format("float@%g ",
+						tmp_code->second_operand.a.val_real);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == STRING_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				else if(tmp_code->second_operand.type == STRING_ID &&
+					tmp_code->second_operand.is_const)
 				{
-               //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-					printf("string@%s ", tmp_list_ptr->data.second_operand.a.str);
+               //string_convert(&tmp_code->second_operand.a.str);
+					emit_format("string@%s ", tmp_code->second_operand.a.str);
 				}
-				else if(tmp_list_ptr->data.second_operand.type == BOOLEAN_ID &&
-					tmp_list_ptr->data.second_operand.is_const)
+				else if(tmp_code->second_operand.type == BOOLEAN_ID &&
+					tmp_code->second_operand.is_const)
 				{
-					if(tmp_list_ptr->data.second_operand.a.val_bool)
+					if(tmp_code->second_operand.a.val_bool)
 					{
-						printf("%s ", "bool@true");
+						emit_format("%s ", "bool@true");
 					}
 					else
 					{
-						printf("%s ", "bool@false");
+						emit_format("%s ", "bool@false");
 					}
 				}
 				else
 				{
-					printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+					emit_format("%s ", tmp_code->second_operand.a.str);
 				}
 
 
-				if(tmp_list_ptr->data.third_operand.type == INTEGER_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				if(tmp_code->third_operand.type == INTEGER_ID &&
+					tmp_code->third_operand.is_const)
 				{
-					printf("int@%d\n", tmp_list_ptr->data.third_operand.a.val_int);
+					emit_format("int@%d\n", tmp_code->third_operand.a.val_int);
 				}
-				else if(tmp_list_ptr->data.third_operand.type == DOUBLE_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				else if(tmp_code->third_operand.type == DOUBLE_ID &&
+					tmp_code->third_operand.is_const)
 				{
-					printf("float@%g\n", tmp_list_ptr->data.third_operand.a.val_real);
+					emit_format("float@%g\n",
+						tmp_code->third_operand.a.val_real);
 				}
-				else if(tmp_list_ptr->data.third_operand.type == STRING_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				else if(tmp_code->third_operand.type == STRING_ID &&
+					tmp_code->third_operand.is_const)
 				{
-               //string_convert(&tmp_list_ptr->data.third_operand.a.str);
-					printf("string@%s\n", tmp_list_ptr->data.third_operand.a.str);
+               //string_convert(&tmp_code->third_operand.a.str);
+					emit_format("string@%s\n", tmp_code->third_operand.a.str);
 				}
-				else if(tmp_list_ptr->data.third_operand.type == BOOLEAN_ID &&
-					tmp_list_ptr->data.third_operand.is_const)
+				else if(tmp_code->third_operand.type == BOOLEAN_ID &&
+					tmp_code->third_operand.is_const)
 				{
-					if(tmp_list_ptr->data.third_operand.a.val_bool)
+					if(tmp_code->third_operand.a.val_bool)
 					{
-						printf("%s\n", "bool@true");
+						emit_format("%s\n", "bool@true");
 					}
 					else
 					{
-						printf("%s\n", "bool@false");
+						emit_format("%s\n", "bool@false");
 					}
 				}
 				else
 				{
-					printf("%s\n", tmp_list_ptr->data.third_operand.a.str);
+					emit_format("%s\n", tmp_code->third_operand.a.str);
 				}
 			}
 		}
 		/*JUMPIFNEQS <lab> stack instruction*/
-		else if(tmp_list_ptr->data.operation_type == JUMPIFNEQS_INS_ID )
+		else if(tmp_code->operation_type == JUMPIFNEQS_INS_ID )
 		{
-			printf("%s %s\n", "JUMPIFNEQS", 
-					tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "JUMPIFNEQS", 
+					tmp_code->first_operand.a.str);
 		}
 		/*LABEL <label> instruction*/
-		else if(tmp_list_ptr->data.operation_type == LABEL_INS_ID )
+		else if(tmp_code->operation_type == LABEL_INS_ID )
 		{
-			printf("%s %s\n", "LABEL", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "LABEL", tmp_code->first_operand.a.str);
 		}
 		/*LT <var> <symbol1> <symbol2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == LT_INS_ID )
+		else if(tmp_code->operation_type == LT_INS_ID )
 		{
-			printf("%s %s ", "LT", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "LT", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.second_operand.is_const) 
+			if(tmp_code->second_operand.type == INTEGER_ID && 
+				tmp_code->second_operand.is_const) 
 			{
-				printf("%s%d ", "int@", 
-						tmp_list_ptr->data.second_operand.a.val_int);
+				emit_format("%s%d ", "int@", 
+						tmp_code->second_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == DOUBLE_ID && 
+						tmp_code->second_operand.is_const)
 			{
-				printf("%s%g ", "float@", 
-						tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g ", "float@", 
+						tmp_code->second_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == STRING_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == STRING_ID && 
+						tmp_code->second_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.second_operand.a.str);
-				printf("%s%s ", "string@", tmp_list_ptr->data.second_operand.a.str);
+            //string_convert(&tmp_code->second_operand.a.str);
+				emit_format("%s%s ", "string@", tmp_code->second_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.second_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->second_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s ", "bool@true");
+				emit_format("%s ", "bool@true");
 			}
-			else if(tmp_list_ptr->data.second_operand.type == 
-						BOOLEAN_ID && tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == 
+						BOOLEAN_ID && tmp_code->second_operand.is_const)
 			{
-				if(tmp_list_ptr->data.second_operand.a.val_bool)
+				if(tmp_code->second_operand.a.val_bool)
 				{
-					printf("%s ", "bool@true");
+					emit_format("%s ", "bool@true");
 				}
 				else
 				{
-					printf("%s ", "bool@false");
+					emit_format("%s ", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", 
-						tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n", "int@", 
+						tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-						tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+						tmp_code->first_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == STRING_ID && 
+						tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == TOKEN_TRUE_ID)
+			else if(tmp_code->first_operand.type == TOKEN_TRUE_ID)
 			{
-				printf("%s\n", "bool@true");
+				emit_format("%s\n", "bool@true");
 			}
-			else if(tmp_list_ptr->data.first_operand.type == BOOLEAN_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == BOOLEAN_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				if(tmp_list_ptr->data.first_operand.a.val_bool)
+				if(tmp_code->first_operand.a.val_bool)
 				{
-					printf("%s\n", "bool@true");
+					emit_format("%s\n", "bool@true");
 				}
 				else
 				{
-					printf("%s\n", "bool@false");
+					emit_format("%s\n", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 
 		}
 		/*LTS stack instruction*/
-		else if(tmp_list_ptr->data.operation_type == LTS_INS_ID )
+		else if(tmp_code->operation_type == LTS_INS_ID )
 		{
-			printf("%s\n", "LTS");
+			emit_format("%s\n", "LTS");
 		}
 		/*MOVE <var> <symbol1> instruction*/
-		else if(tmp_list_ptr->data.operation_type == MOVE_INS_ID )
+		else if(tmp_code->operation_type == MOVE_INS_ID )
 		{
-			printf("%s %s ", "MOVE", tmp_list_ptr->data.second_operand.a.str);
+			emit_format("%s %s ", "MOVE", tmp_code->second_operand.a.str);
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-					tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+					tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", 
-						tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n", "int@", 
+						tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-						tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+						tmp_code->first_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.first_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->first_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s\n", "bool@true");
+				emit_format("%s\n", "bool@true");
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == STRING_ID && 
+						tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 		}
 		/*MUL <var> <symbol1> <symbol2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == MUL_INS_ID )
+		else if(tmp_code->operation_type == MUL_INS_ID )
 		{
-			printf("%s %s ", "MUL", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "MUL", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == INTEGER_ID && 
+				tmp_code->second_operand.is_const)
 			{
-				printf("%s%d ", "int@", 
-						tmp_list_ptr->data.second_operand.a.val_int);
+				emit_format("%s%d ", "int@", 
+						tmp_code->second_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == DOUBLE_ID && 
+						tmp_code->second_operand.is_const)
 			{
-				printf("%s%g ", "float@", 
-						tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g ", "float@", 
+						tmp_code->second_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", 
-						tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n", "int@", 
+						tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-						tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+						tmp_code->first_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 			
 		}
-		//else if(tmp_list_ptr->data->operation_type == MULS_INS_ID )
+		/*MULS stack instruction*/
+		else if(tmp_code->operation_type == MULS_INS_ID )
+		{
+			emit_format("%s\n", "MULS");
+		}
 		/*NOT <var> <symbol1> instruction*/
-		else if(tmp_list_ptr->data.operation_type == NOT_INS_ID )
+		else if(tmp_code->operation_type == NOT_INS_ID )
+		{
+			emit_format("%s %s %s\n", "NOT", tmp_code->second_operand.a.str, 
+					tmp_code->first_operand.a.str);
+		}
+		/*NOTS stack instruction*/
+		else if(tmp_code->operation_type == NOTS_INS_ID )
 		{
-			printf("%s %s %s\n", "NOT", tmp_list_ptr->data.second_operand.a.str, 
-					tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s\n", "NOTS");
 		}
-		//else if(tmp_list_ptr->data->operation_type == NOTS_INS_ID )
 		/*OR <var> <symb1> <symb2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == OR_INS_ID )
+		else if(tmp_code->operation_type == OR_INS_ID )
 		{
-			printf("%s %s %s %s\n", "OR", tmp_list_ptr->data.third_operand.a.str, 
-													tmp_list_ptr->data.first_operand.a.str, 
-													tmp_list_ptr->data.second_operand.a.str);
+			emit_format("%s %s %s %s\n", "OR", tmp_code->third_operand.a.str, 
+													tmp_code->first_operand.a.str, 
+													tmp_code->second_operand.a.str);
 		}
-		//else if(tmp_list_ptr->data->operation_type == ORS_INS_ID )
+		//else if(tmp_code->operation_type == ORS_INS_ID )
 		/*POPFRAME instruction*/
-		else if(tmp_list_ptr->data.operation_type == POPFRAME_INS_ID )
+		else if(tmp_code->operation_type == POPFRAME_INS_ID )
 		{
-			printf("%s\n", "POPFRAME");
+			emit_format("%s\n", "POPFRAME");
 		}
 		/*POPS <var> instruction*/
-		else if(tmp_list_ptr->data.operation_type == POPS_INS_ID )
+		else if(tmp_code->operation_type == POPS_INS_ID )
 		{
-			printf("%s %s\n", "POPS", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s\n", "POPS", tmp_code->first_operand.a.str);
 		}
 		/*PUSHFRAME instruction*/
-		else if(tmp_list_ptr->data.operation_type == PUSHFRAME_INS_ID )
+		else if(tmp_code->operation_type == PUSHFRAME_INS_ID )
 		{
-			printf("%s\n", "PUSHFRAME");
+			emit_format("%s\n", "PUSHFRAME");
 		}
 		/*PUSHS <symb> instruction*/
-		else if(tmp_list_ptr->data.operation_type == PUSHS_INS_ID )
+		else if(tmp_code->operation_type == PUSHS_INS_ID )
 		{
-			printf("%s ", "PUSHS");
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			emit_format("%s ", "PUSHS");
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n","int@", tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n","int@", tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n","float@", 
-						tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n","float@", 
+						tmp_code->first_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == STRING_ID && 
+						tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s\n","string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s\n","string@", tmp_code->first_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.first_operand.id == TOKEN_TRUE_ID)
+			else if(tmp_code->first_operand.id == TOKEN_TRUE_ID)
 			{
-				printf("%s\n", "bool@true");
+				emit_format("%s\n", "bool@true");
 			}
 			else
 			{
-				printf("%s\n",tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n",tmp_code->first_operand.a.str);
 			}
 		}
 		/*READ <var> <type> instruction*/
-		else if(tmp_list_ptr->data.operation_type == READ_INS_ID )
+		else if(tmp_code->operation_type == READ_INS_ID )
 		{
-			printf("%s %s ", "READ", tmp_list_ptr->data.first_operand.a.str);
+			emit_format("%s %s ", "READ", tmp_code->first_operand.a.str);
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID)
+			if(tmp_code->first_operand.type == INTEGER_ID)
 			{
-				printf("%s\n", "int");
+				emit_format("%s\n", "int");
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID)
+			else if(tmp_code->first_operand.type == DOUBLE_ID)
 			{
-				printf("%s\n", "float");
+				emit_format("%s\n", "float");
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID)
+			else if(tmp_code->first_operand.type == STRING_ID)
 			{
-				printf("%s\n", "string");
+				emit_format("%s\n", "string");
 			}
 			else
 			{
-				printf("%s\n", "bool");
+				emit_format("%s\n", "bool");
 			}
 		}
 		/*RETURN instruction*/
-		else if(tmp_list_ptr->data.operation_type == RETURN_INS_ID )
+		else if(tmp_code->operation_type == RETURN_INS_ID )
 		{
-			printf("%s\n", "RETURN");
+			emit_format("%s\n", "RETURN");
 		}
-		//else if(tmp_list_ptr->data.operation_type == SETCHAR_INS_ID )
+		//else if(tmp_code->operation_type == SETCHAR_INS_ID )
 		/*STR2INT <var> <symb1> <symb2> instruction*/
-		else if(tmp_list_ptr->data.operation_type == STRI2INT_INS_ID )
+		else if(tmp_code->operation_type == STRI2INT_INS_ID )
 		{
-			printf("%s %s %s %d\n", "STR2INT", 
-										tmp_list_ptr->data.third_operand.a.str, 
-										tmp_list_ptr->data.first_operand.a.str, 
-										tmp_list_ptr->data.second_operand.a.val_int);
+			emit_format("%s %s %s %d\n", "STR2INT", 
+										tmp_code->third_operand.a.str, 
+										tmp_code->first_operand.a.str, 
+										tmp_code->second_operand.a.val_int);
 		}
 		/*STR2INTS instruction*/
-		else if(tmp_list_ptr->data.operation_type == STRI2INTS_INS_ID )
+		else if(tmp_code->operation_type == STRI2INTS_INS_ID )
 		{
-			printf("%s\n", "STRI2INTS");
+			emit_format("%s\n", "STRI2INTS");
 		}
 		/*STRLEN <var> <symb>*/
-		else if(tmp_list_ptr->data.operation_type == STRLEN_INS_ID )
+		else if(tmp_code->operation_type == STRLEN_INS_ID )
 		{
-			printf("%s %s ", "STRLEN", 
-											tmp_list_ptr->data.second_operand.a.str);
+			emit_format("%s %s ", "STRLEN", 
+											tmp_code->second_operand.a.str);
 
-         if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-            tmp_list_ptr->data.first_operand.is_const)
+         if(tmp_code->first_operand.type == INTEGER_ID && 
+            tmp_code->first_operand.is_const)
          {
-            printf("%s%d\n", "int@", 
-                     tmp_list_ptr->data.first_operand.a.val_int);
+            emit_format("%s%d\n", "int@", 
+                     tmp_code->first_operand.a.val_int);
          }
-         else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-                  tmp_list_ptr->data.first_operand.is_const)
+         else if(tmp_code->first_operand.type == DOUBLE_ID && 
+                  tmp_code->first_operand.is_const)
          {
-            printf("%s%g\n", "float@", 
-                     tmp_list_ptr->data.first_operand.a.val_real);
+            emit_format("%s%g\n", "float@", 
+                     tmp_code->first_operand.a.val_real);
          }
-         else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-                  tmp_list_ptr->data.first_operand.is_const)
+         else if(tmp_code->first_operand.type == STRING_ID && 
+                  tmp_code->first_operand.is_const)
          {
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-            printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+            emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
          }
-         else if(tmp_list_ptr->data.first_operand.type == BOOLEAN_ID && 
-                  tmp_list_ptr->data.first_operand.is_const)
+         else if(tmp_code->first_operand.type == BOOLEAN_ID && 
+                  tmp_code->first_operand.is_const)
          {
-            if(tmp_list_ptr->data.first_operand.a.val_bool)
+            if(tmp_code->first_operand.a.val_bool)
             {
-               printf("%s\n", "bool@true");
+               emit_format("%s\n", "bool@true");
             }
             else
             {
-               printf("%s\n", "bool@false");
+               emit_format("%s\n", "bool@false");
             }
          }
          else
          {
-            printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+            emit_format("%s\n", tmp_code->first_operand.a.str);
          }
 		}
-		else if(tmp_list_ptr->data.operation_type == SUB_INS_ID )
+		else if(tmp_code->operation_type == SUB_INS_ID )
 		{
-			printf("%s ", "SUB");
+			emit_format("%s ", "SUB");
 
-			printf("%s ", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s ", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == INTEGER_ID && 
-					tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == INTEGER_ID && 
+					tmp_code->second_operand.is_const)
 			{
-				printf("%s%d ", "int@", 
-							tmp_list_ptr->data.second_operand.a.val_int);
+				emit_format("%s%d ", "int@", 
+							tmp_code->second_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.second_operand.is_const)
+			else if(tmp_code->second_operand.type == DOUBLE_ID && 
+						tmp_code->second_operand.is_const)
 			{
-				printf("%s%g ", "float@", 
-						tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g ", "float@", 
+						tmp_code->second_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", 
-							tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n", "int@", 
+							tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-						tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+						tmp_code->first_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 
 			
 		}
 		/*SUBS instruction*/
-		else if(tmp_list_ptr->data.operation_type == SUBS_INS_ID )
+		else if(tmp_code->operation_type == SUBS_INS_ID )
 		{
-			printf("%s\n", "SUBS");
+			emit_format("%s\n", "SUBS");
 		}
-		//else if(tmp_list_ptr->data->operation_type == TYPE_INS_ID )
-		else if(tmp_list_ptr->data.operation_type == WRITE_INS_ID )
+		//else if(tmp_code->operation_type == TYPE_INS_ID )
+		else if(tmp_code->operation_type == WRITE_INS_ID )
 		{
-			printf("%s ", "WRITE");
+			emit_format("%s ", "WRITE");
 			
-			if(tmp_list_ptr->data.first_operand.type == INTEGER_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == INTEGER_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%d\n", "int@", 
-							tmp_list_ptr->data.first_operand.a.val_int);
+				emit_format("%s%d\n", "int@", 
+							tmp_code->first_operand.a.val_int);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == DOUBLE_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-							tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+							tmp_code->first_operand.a.val_real);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == STRING_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == STRING_ID && 
+						tmp_code->first_operand.is_const)
 			{
-            //string_convert(&tmp_list_ptr->data.first_operand.a.str);
-				printf("%s%s\n", "string@", tmp_list_ptr->data.first_operand.a.str);
+            //string_convert(&tmp_code->first_operand.a.str);
+				emit_format("%s%s\n", "string@", tmp_code->first_operand.a.str);
 			}
-			else if(tmp_list_ptr->data.first_operand.type == BOOLEAN_ID && 
-						tmp_list_ptr->data.first_operand.is_const)
+			else if(tmp_code->first_operand.type == BOOLEAN_ID && 
+						tmp_code->first_operand.is_const)
 			{
-				if(tmp_list_ptr->data.first_operand.a.val_bool)
+				if(tmp_code->first_operand.a.val_bool)
 				{
-					printf("%s\n", "bool@true");
+					emit_format("%s\n", "bool@true");
 				}
 				else
 				{
-					printf("%s\n", "bool@false");
+					emit_format("%s\n", "bool@false");
 				}
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
 		}
 
-		else if(tmp_list_ptr->data.operation_type == LABEL_MAIN)
+		else if(tmp_code->operation_type == LABEL_MAIN)
 		{
-			printf("%s\n", "LABEL $$MAIN");
+			emit_format("%s\n", "LABEL $$MAIN");
 		}
 
-		else if(tmp_list_ptr->data.operation_type == INT_DIV_INS_ID)
+		else if(tmp_code->operation_type == INT_DIV_INS_ID)
 		{
-			//printf("%s %s %s\n", "INT2FLOAT", tmp_list_ptr->data.second_operand.a.str, tmp_list_ptr->data.second_operand.a.str);
-			//printf("%s %s %s\n", "INT2FLOAT", tmp_list_ptr->data.first_operand.a.str, tmp_list_ptr->data.first_operand.a.str);
+			//printf("%s %s %s\n", "INT2FLOAT", tmp_code->second_operand.a.str, tmp_code->second_operand.a.str);
+			//printf("%s %s %s\n", "INT2FLOAT", tmp_code->first_operand.a.str, tmp_code->first_operand.a.str);
 
-			printf("%s %s ", "DIV", tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s ", "DIV", tmp_code->third_operand.a.str);
 
-			if(tmp_list_ptr->data.second_operand.type == DOUBLE_ID && 
-				tmp_list_ptr->data.second_operand.is_const)
+			if(tmp_code->second_operand.type == DOUBLE_ID && 
+				tmp_code->second_operand.is_const)
 			{
-				printf("%s%g ", "float@", 
-							tmp_list_ptr->data.second_operand.a.val_real);
+				emit_format("%s%g ", "float@", 
+							tmp_code->second_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s ", tmp_list_ptr->data.second_operand.a.str);
+				emit_format("%s ", tmp_code->second_operand.a.str);
 			}
 
-			if(tmp_list_ptr->data.first_operand.type == DOUBLE_ID && 
-				tmp_list_ptr->data.first_operand.is_const)
+			if(tmp_code->first_operand.type == DOUBLE_ID && 
+				tmp_code->first_operand.is_const)
 			{
-				printf("%s%g\n", "float@", 
-							tmp_list_ptr->data.first_operand.a.val_real);
+				emit_format("%s%g\n", "float@", 
+							tmp_code->first_operand.a.val_real);
 			}
 			else
 			{
-				printf("%s\n", tmp_list_ptr->data.first_operand.a.str);
+				emit_format("%s\n", tmp_code->first_operand.a.str);
 			}
-			printf("%s %s %s\n", "FLOAT2R2EINT", 
-						tmp_list_ptr->data.third_operand.a.str, 
-						tmp_list_ptr->data.third_operand.a.str);
+			emit_format("%s %s %s\n", "FLOAT2R2EINT", 
+						tmp_code->third_operand.a.str, 
+						tmp_code->third_operand.a.str);
 
 		}
 		ilist_delete_first(instructs);
@@ -3415,48 +3733,53 @@ void instruction_print(ilist_t *instructs)
 
 void order_ilist(ilist_t *ins_list)
 {
-	ilist_first(ins_list);
 	code_t *code_ptr;
-	int depth_cnt = 0;
-	ilist_elem_t *iter_ptr;
+	tstack loops;
+
+	/* Labels of currently open loops, bottom one is the outermost loop */
+	if(tstack_init(&loops))
+		return;
 
-	while(ilist_active(ins_list))
+	/* Single pass, definitions in any nested loop are moved in front of the
+	 * outermost loop, which is kept as the active element of the list
+	 */
+	ilist_first(ins_list);
+	for(int index = ilist_index(ins_list); index != ILIST_NULL; 
+		 index = ilist_index_next(index))
 	{
-		code_ptr = ilist_copy(ins_list);
-		if(code_ptr->operation_type == LABEL_INS_ID)
+		code_ptr = ilist_at(index);
+		if(code_ptr->operation_type == LABEL_INS_ID &&
+			code_ptr->first_operand.id == LOOP_BEGIN_ID)
 		{
-			if(code_ptr->first_operand.id == LOOP_BEGIN_ID)
-			{
-				depth_cnt = code_ptr->first_operand.type;
-				iter_ptr = ins_list->activ->rneigh;
+			if(tstack_empty(&loops) == TSTACK_EMPTY)
+				ilist_set_active(ins_list, index);
 
-				while(iter_ptr->data.operation_type != LABEL_INS_ID ||
-					(iter_ptr->data.first_operand.id != LOOP_END_ID ||
-										(iter_ptr->data.first_operand.id == LOOP_END_ID &&
-											iter_ptr->data.first_operand.type != depth_cnt)))
-				{
-					if(iter_ptr->data.operation_type == DEFVAR_INS_ID)
-					{
-						if(iter_ptr->data.first_operand.a.str[0] != 'T')
-						{
-							ilist_pre_insert(ins_list, &(iter_ptr->data));
-							iter_ptr->data.operation_type = NO_PRINT_ID;
-						}
-					}
-					iter_ptr = iter_ptr->rneigh;
-				}
-			}
+			if(tstack_push(&loops, &code_ptr->first_operand))
+				break;
+		}
+		else if(code_ptr->operation_type == LABEL_INS_ID &&
+				  code_ptr->first_operand.id == LOOP_END_ID &&
+				  tstack_empty(&loops) != TSTACK_EMPTY &&
+				  tstack_top(&loops).type == code_ptr->first_operand.type)
+		{
+			tstack_pop(&loops);
+		}
+		else if(code_ptr->operation_type == DEFVAR_INS_ID &&
+				  tstack_empty(&loops) != TSTACK_EMPTY &&
+				  code_ptr->first_operand.a.str[0] != 'T')
+		{
+			ilist_pre_insert(ins_list, code_ptr);
+			code_ptr->operation_type = NO_PRINT_ID;
 		}
-
-
-		ilist_next(ins_list);
 	}
+
+	tstack_free(&loops);
 }
 
 void token_conversion(ilist_t *code_list, int conv_id, token_t *op_token, int *counter)
 {
 	char *temp_name = NULL;
-	token_t *tmp_token = smalloc(sizeof(token_t));
+	token_t *tmp_token = scalloc(1, sizeof(token_t));
 	if(tmp_token == NULL)
 		return;
 	int temp_counter = *counter;
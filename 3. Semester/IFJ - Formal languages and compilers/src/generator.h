@@ -113,10 +113,30 @@
 #define NO_PRINT_ID 1029
 #define FUNC_NAME_ID 1030
 #define FUNC_END_ID 1031
+#define STACK_RESULT_ID 1032
+
+/* Expression backends */
+
+#define EXPR_BACKEND_TAC 0
+#define EXPR_BACKEND_STACK 1
+
+/* Name of the expression result left on the data stack */
+#define STACK_RESULT "$stack"
 
 /*GODLIKE NIL!!!*/
 #define NIL NULL
 
+/* Expression backend selected by main, EXPR_BACKEND_TAC by default */
+extern int expr_backend;
+
+/* Counters of unique names and labels of the generator */
+typedef struct gen_counters
+{
+	int unique;					///< Counter of temporary variables
+	unsigned int label;		///< Counter of labels
+	unsigned int elsif;		///< Counter of ElseIf branches of a condition
+} gen_counters_t;
+
 	
 /*	Prototypes	*/
 /**
@@ -142,6 +162,28 @@ void generate_instruction(ilist_t *code_list, int type, int num,  ...);
  */
 char *generate(tstack *instruction_stack, int id);
 
+/**
+ * @brief Alternative to generate() for binary operators of expressions.
+ * Reduction is compiled straight to stack instructions and its result is left
+ * on the data stack.  Result of the whole expression is stored to variable by
+ * generate() with STACK_RESULT_ID.
+ *
+ *
+ * @param *instruction_stack Pointer to the stack of tokens.
+ * @param id Integer containing id of the operator.
+ * @return Returns STACK_RESULT or NULL on allocation error.
+ */
+char *generate_stack(tstack *instruction_stack, int id);
+
+/**
+ * @brief Determines if the token stands for result left on the data stack.
+ *
+ *
+ * @param *token Pointer to the expression token.
+ * @return Returns true for results of generate_stack().
+ */
+bool is_stack_result(token_t *token);
+
 /**
  * @brief Generates coresponding label names for spacial cases and handles
  *	uniqueness of labels for those cases.
@@ -153,6 +195,33 @@ char *generate(tstack *instruction_stack, int id);
  */
 void generate_label(tstack *instruction_stack, int id);
 
+/**
+ * @brief Resets counters of unique names and labels and the state of the
+ *        printing, so the next program is generated the same way as in a
+ *        new process (batch mode).
+ *
+ * @return void.
+ */
+void generator_reinit();
+
+/**
+ * @brief Stores current values of the counters of unique names and labels.
+ *        Function cache uses them to rebase names of a cached function.
+ *
+ * @param *counters Structure to be filled.
+ * @return void.
+ */
+void generator_get_counters(gen_counters_t *counters);
+
+/**
+ * @brief Sets the counters of unique names and labels, so the generation
+ *        continues after the code spliced from the function cache.
+ *
+ * @param *counters Values of the counters.
+ * @return void.
+ */
+void generator_set_counters(const gen_counters_t *counters);
+
 /**
  * @brief Prints contents of the instruction list.
  *
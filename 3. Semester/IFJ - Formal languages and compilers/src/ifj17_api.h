@@ -44,6 +44,7 @@
 
 #define CODE_STRUCTURE_LINEAR 1
 #define CODE_STRUCTURE_JUMP 2
+#define CODE_STRUCTURE_BRANCH 3
 
 /** @brief Line counter in scanner.c for error reporting. */
 extern int line_counter;
@@ -135,18 +136,15 @@ typedef struct token
   token_t third_operand;       ///< Third instruction operand.
 } code_t;
 
-/** @brief Doubly-linked instruction list element. */
-typedef struct instruction_list_element {
-   code_t data;                                 ///< Instruction data
-   struct instruction_list_element *lneigh;     ///< Left neighbor
-   struct instruction_list_element *rneigh;     ///< Right neighbor
-} ilist_elem_t;
-
-/** @brief Doubly-linked instruction list used for code generation.  */
+/**
+ * @brief Doubly-linked instruction list used for code generation.  Elements
+ *        are stored in the shared instruction pool (see ilist.h) and
+ *        referred by their stable indices, 0 stands for no element.
+ */
 struct instruction_list {
-   ilist_elem_t *first;        ///< First element pointer
-   ilist_elem_t *activ;        ///< Active element pointer
-   ilist_elem_t *last;         ///< Last element pointer
+   int first;                  ///< First element index
+   int activ;                  ///< Active element index
+   int last;                   ///< Last element index
    int size;                   ///< Number of elems in the list
 };
 
@@ -1,11 +1,12 @@
 /**
  * @file ilist_t.c
  * @brief Doubly-linked list for IFJ Project 2017 AT vut.fit.vutbr.cz.
- * @date 21.11.2017
+ * @date 21.11.2017, last rev. 17.10.2026
  * @author Patrik Goldschmidt - xgolds00@stud.fit.vutbr.cz
  *
  * Module provides doubly linked list interface for used for storing
- * instructions prior to their generation and optimization.
+ * instructions prior to their generation and optimization.  Elements of all
+ * lists are stored in the chunked instruction pool and linked by indices.
  */
 
 #include "ilist.h"
@@ -13,65 +14,156 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** @brief Chunk of the instruction pool.  */
+typedef struct ilist_chunk
+{
+   code_t data[ILIST_CHUNK_SIZ];    ///< Instructions
+   int lneigh[ILIST_CHUNK_SIZ];     ///< Left neighbor indices
+   int rneigh[ILIST_CHUNK_SIZ];     ///< Right neighbor indices
+} ilist_chunk_t;
+
+/** @brief Instruction stored at the index. */
+#define ILIST_DATA(index) \
+   (pool_chunks[(index) / ILIST_CHUNK_SIZ]->data[(index) % ILIST_CHUNK_SIZ])
+
+/** @brief Left neighbor of the element at the index. */
+#define ILIST_LNEIGH(index) \
+   (pool_chunks[(index) / ILIST_CHUNK_SIZ]->lneigh[(index) % ILIST_CHUNK_SIZ])
+
+/** @brief Right neighbor of the element at the index. */
+#define ILIST_RNEIGH(index) \
+   (pool_chunks[(index) / ILIST_CHUNK_SIZ]->rneigh[(index) % ILIST_CHUNK_SIZ])
+
+/** @brief Table of the pool chunks.  */
+static ilist_chunk_t **pool_chunks = NULL;
+
+/** @brief Number of allocated chunks.  */
+static int pool_chunks_count = 0;
+
+/** @brief Size of the chunk table.  */
+static int pool_chunks_size = 0;
+
+/** @brief Number of indices ever used, index 0 is ILIST_NULL.  */
+static int pool_used = 1;
+
+/** @brief First deleted element, deleted elements are linked by rneigh.  */
+static int pool_free = ILIST_NULL;
+
+/*
+ * Takes an element from the pool and fills it with the instruction.  Returns
+ * its index or ILIST_NULL if the memory allocation fails.
+ */
+static int ilist_alloc(code_t *instr)
+{
+   int index = pool_free;
+
+   /* Reuse deleted element if there is any.   */
+   if(index != ILIST_NULL)
+      pool_free = ILIST_RNEIGH(index);
+   else
+   {
+      /* Add new chunk if all the chunks are used.   */
+      if(pool_used >= pool_chunks_count * ILIST_CHUNK_SIZ)
+      {
+         if(pool_chunks_count == pool_chunks_size)
+         {
+            int size = (pool_chunks_size) ? 2 * pool_chunks_size
+                                          : ILIST_CHUNKS_INIT_SIZ;
+            ilist_chunk_t **chunks = srealloc(pool_chunks, 
+                                              size * sizeof(ilist_chunk_t *));
+
+            if(chunks == NULL)
+               return ILIST_NULL;
+
+            pool_chunks = chunks;
+            pool_chunks_size = size;
+         }
+
+         pool_chunks[pool_chunks_count] = smalloc(sizeof(ilist_chunk_t));
+
+         if(pool_chunks[pool_chunks_count] == NULL)
+            return ILIST_NULL;
+
+         pool_chunks_count++;
+      }
+
+      index = pool_used++;
+   }
+
+   memcpy(&ILIST_DATA(index), instr, sizeof(code_t));
+
+   return index;
+}
+
+/*
+ * Returns the element to the pool.
+ */
+static void ilist_release(int index)
+{
+   ILIST_RNEIGH(index) = pool_free;
+   pool_free = index;
+
+   return;
+}
+
 int ilist_active(ilist_t *list)
 {
-   if(list->activ != NULL)
+   if(list->activ != ILIST_NULL)
       return ILIST_ACTIVITY_ON;
    else
       return ILIST_ACTIVITY_OFF;
 }
 
-code_t * ilist_copy(ilist_t *list)
+code_t * ilist_at(int index)
 {
-   /* Check if the list is active.  */
-   if(list->activ == NULL)
+   if(index == ILIST_NULL)
       return NULL;
 
-   return &list->activ->data;
+   return &ILIST_DATA(index);
 }
 
-code_t * ilist_copy_first(ilist_t *list)
+code_t * ilist_copy(ilist_t *list)
 {
-   if(list->first == NULL)
-      return NULL;
+   /* Check if the list is active.  */
+   return ilist_at(list->activ);
+}
 
-   return &list->first->data;
+code_t * ilist_copy_first(ilist_t *list)
+{
+   return ilist_at(list->first);
 }
 
 
 code_t *ilist_copy_last(ilist_t *list)
 {
-   if(list->last == NULL)
-      return NULL;
-
-   return &list->last->data;
+   return ilist_at(list->last);
 }
 
 void ilist_delete_first(ilist_t *list)
 {
    /* Check if the list is not empty.  */
-   if(list->first != NULL)
+   if(list->first != ILIST_NULL)
    {
-      /* Back up pointer to the next element.  */
-      ilist_elem_t *new_first = list->first->rneigh;
+      /* Back up index of the next element.  */
+      int new_first = ILIST_RNEIGH(list->first);
 
       /* If active element is about to be deleted, set list to inactive.  */
       if(list->activ == list->first)
-         list->activ = NULL;
+         list->activ = ILIST_NULL;
 
-      /* Deallocate 1st element and replace it with next.   */
-      sfree(list->first);
+      /* Release 1st element and replace it with next.   */
+      ilist_release(list->first);
       list->first = new_first;
 
       /*
-       * If the current 1st element is not NULL (list contained more than
-       * 1 element), set its left pointer to NULL;
+       * If the current 1st element exists (list contained more than
+       * 1 element), set its left neighbor to ILIST_NULL;
        */
-      if(list->first != NULL)
-         list->first->lneigh = NULL;
-      /* If the deleted element was the only one, set last to NULL too.   */
+      if(list->first != ILIST_NULL)
+         ILIST_LNEIGH(list->first) = ILIST_NULL;
+      /* If the deleted element was the only one, clear last too.   */
       else
-         list->last = NULL;
+         list->last = ILIST_NULL;
 
       list->size--;
    }
@@ -82,28 +174,28 @@ void ilist_delete_first(ilist_t *list)
 void ilist_delete_last(ilist_t *list)
 {
    /* Check if the list is not empty.  */
-   if(list->last != NULL)
+   if(list->last != ILIST_NULL)
    {
-      /* Back up pointer to the previous element.  */
-      ilist_elem_t *new_last = list->last->lneigh;
+      /* Back up index of the previous element.  */
+      int new_last = ILIST_LNEIGH(list->last);
 
       /* If active element is about to be deleted, set list to inactive.  */
       if(list->activ == list->last)
-         list->activ = NULL;
+         list->activ = ILIST_NULL;
 
-      /* Deallocate last element and replace it with next.   */
-      sfree(list->last);
+      /* Release last element and replace it with previous.   */
+      ilist_release(list->last);
       list->last = new_last;
 
       /*
-       * If the current last element is not NULL (list contained more than
-       * 1 element), set its right pointer to NULL;
+       * If the current last element exists (list contained more than
+       * 1 element), set its right neighbor to ILIST_NULL;
        */
-      if(list->last != NULL)
-         list->last->rneigh = NULL;
-      /* If the deleted element was the only one, set first to NULL too.   */
+      if(list->last != ILIST_NULL)
+         ILIST_RNEIGH(list->last) = ILIST_NULL;
+      /* If the deleted element was the only one, clear first too.   */
       else
-         list->first = NULL;
+         list->first = ILIST_NULL;
 
       list->size--;
    }
@@ -113,8 +205,8 @@ void ilist_delete_last(ilist_t *list)
 
 void ilist_edit(ilist_t *list, code_t *instr)
 {
-   if(list->activ != NULL)
-      memcpy(&list->activ->data, instr, sizeof(code_t));
+   if(list->activ != ILIST_NULL)
+      memcpy(&ILIST_DATA(list->activ), instr, sizeof(code_t));
 
    return;
 }
@@ -137,50 +229,75 @@ void ilist_first(ilist_t *list)
 void ilist_free(ilist_t *list)
 {
    /* Temporary next list element holder. */
-   ilist_elem_t *next_elem;
+   int next_elem;
 
    /* Iterate until end of the list is reached. */
-   while(list->first != NULL)
+   while(list->first != ILIST_NULL)
    {
-      next_elem = list->first->rneigh;
-      sfree(list->first);
+      next_elem = ILIST_RNEIGH(list->first);
+      ilist_release(list->first);
       list->first = next_elem;
    }
 
-   /* Set other list pointers to NULL and size to 0 as well.  */
-   list->activ = NULL;
-   list->last  = NULL;
+   /* Set other list indices to ILIST_NULL and size to 0 as well.  */
+   list->activ = ILIST_NULL;
+   list->last  = ILIST_NULL;
    list->size  = 0;
 
    return;   
 }
 
+int ilist_index(ilist_t *list)
+{
+   return list->activ;
+}
+
+int ilist_index_next(int index)
+{
+   return ILIST_RNEIGH(index);
+}
+
+int ilist_index_prev(int index)
+{
+   return ILIST_LNEIGH(index);
+}
+
 void ilist_init(ilist_t *list)
 {
-   list->first = NULL;
-   list->last  = NULL;
-   list->activ = NULL;
+   list->first = ILIST_NULL;
+   list->last  = ILIST_NULL;
+   list->activ = ILIST_NULL;
    list->size  = 0;
 
    return;
 }
 
+void ilist_reinit()
+{
+   pool_chunks = NULL;
+   pool_chunks_count = 0;
+   pool_chunks_size = 0;
+   pool_used = 1;
+   pool_free = ILIST_NULL;
+
+   return;
+}
+
 int ilist_insert_first(ilist_t *list, code_t *instr)
 {
-   /* Allocate memory for new element + error handling.   */
-   ilist_elem_t *new_elem = smalloc(sizeof(ilist_elem_t));
+   /* Take new element from the pool + error handling.   */
+   int new_elem = ilist_alloc(instr);
 
-   if(new_elem == NULL)
+   if(new_elem == ILIST_NULL)
       return ILIST_INSERT_FAILURE;
 
-   /* Set up the element data value and pointer addresses.   */
-   memcpy(&new_elem->data, instr, sizeof(code_t));
-   new_elem->lneigh = NULL;
-   new_elem->rneigh = list->first;
+   /* Set up the element links.   */
+   ILIST_LNEIGH(new_elem) = ILIST_NULL;
+   ILIST_RNEIGH(new_elem) = list->first;
 
    /* If the list is not empty.   */
-   if(list->first != NULL)
-      list->first->lneigh = new_elem;
+   if(list->first != ILIST_NULL)
+      ILIST_LNEIGH(list->first) = new_elem;
    /* If the list is empty.  */
    else
       list->last = new_elem;
@@ -195,25 +312,24 @@ int ilist_insert_first(ilist_t *list, code_t *instr)
 
 int ilist_insert_last(ilist_t *list, code_t *instr)
 {
-   /* Allocate memory for new element + error handling.   */
-   ilist_elem_t *new_elem = smalloc(sizeof(ilist_elem_t));
+   /* Take new element from the pool + error handling.   */
+   int new_elem = ilist_alloc(instr);
 
-   if(new_elem == NULL)
+   if(new_elem == ILIST_NULL)
       return ILIST_INSERT_FAILURE;
 
-   /* Set up the element data value and pointer addresses.   */
-   memcpy(&new_elem->data, instr, sizeof(code_t));
-   new_elem->lneigh = list->last;
-   new_elem->rneigh = NULL;
+   /* Set up the element links.   */
+   ILIST_LNEIGH(new_elem) = list->last;
+   ILIST_RNEIGH(new_elem) = ILIST_NULL;
 
    /* If the list is not empty.   */
-   if(list->last != NULL)
-      list->last->rneigh = new_elem;
+   if(list->last != ILIST_NULL)
+      ILIST_RNEIGH(list->last) = new_elem;
    /* If the list is empty.  */
    else
       list->first = new_elem;
 
-   /* Replace first element with the created one.  */
+   /* Replace last element with the created one.  */
    list->last = new_elem;
 
    list->size++;
@@ -235,12 +351,12 @@ ilist_t * ilist_merge(ilist_t *list1, ilist_t *list2)
       return list1;
 
    /* Check the status of both lists before merging.  */
-   if(list1->last != NULL && list2->first != NULL)
+   if(list1->last != ILIST_NULL && list2->first != ILIST_NULL)
    {
       /******** Lists are not empty ********/
       /* Link last element of 1st to first element of 2nd.  */
-      list1->last->rneigh = list2->first;
-      list2->first->lneigh = list1->last;
+      ILIST_RNEIGH(list1->last) = list2->first;
+      ILIST_LNEIGH(list2->first) = list1->last;
 
       /* Set last element of 1st to last element of 2nd. */
       list1->last = list2->last;
@@ -251,13 +367,15 @@ ilist_t * ilist_merge(ilist_t *list1, ilist_t *list2)
       /* Set list2 to initial state.  */
       ilist_init(list2);
    }
-   else if(list1->last == NULL && list2->first != NULL)
+   else if(list1->last == ILIST_NULL && list2->first != ILIST_NULL)
    {
       /******** Second list is not empty, but first is. ********/
-      /* Merge 2nd to 1st while 1st is empty, just swap pointers.   */
-      ilist_t *tmplist = list1;
-      list1 = list2;
-      list2 = tmplist;
+      /* Merge 2nd to 1st while 1st is empty, just move the elements.   */
+      list1->first = list2->first;
+      list1->last = list2->last;
+      list1->size = list2->size;
+
+      ilist_init(list2);
    }
 
    return list1;
@@ -265,8 +383,8 @@ ilist_t * ilist_merge(ilist_t *list1, ilist_t *list2)
 
 void ilist_next(ilist_t *list)
 {
-   if(list->activ != NULL)
-      list->activ = list->activ->rneigh;
+   if(list->activ != ILIST_NULL)
+      list->activ = ILIST_RNEIGH(list->activ);
 
    return;
 }
@@ -274,21 +392,21 @@ void ilist_next(ilist_t *list)
 void ilist_post_delete(ilist_t *list)
 {
    /* Check if the list is active and the active element is not last.   */
-   if(list->activ != NULL && list->activ->rneigh != NULL)
+   if(list->activ != ILIST_NULL && ILIST_RNEIGH(list->activ) != ILIST_NULL)
    {
-      /* Back up pointer to the deleted element.   */
-      ilist_elem_t *elem_to_del = list->activ->rneigh;
-      /* Set pointer to next element after the deletion process. */
-      list->activ->rneigh = elem_to_del->rneigh;
+      /* Back up index of the deleted element.   */
+      int elem_to_del = ILIST_RNEIGH(list->activ);
+      /* Set index of the next element after the deletion process. */
+      ILIST_RNEIGH(list->activ) = ILIST_RNEIGH(elem_to_del);
 
       /* If the deleted element is not last, modify links with the active.  */
       if(elem_to_del != list->last)
-         list->activ->rneigh->lneigh = list->activ;
+         ILIST_LNEIGH(ILIST_RNEIGH(list->activ)) = list->activ;
       /* If the deleted element is the last, link last to active.  */
       else
          list->last = list->activ;
 
-      sfree(elem_to_del);
+      ilist_release(elem_to_del);
 
       list->size--;
    }
@@ -299,18 +417,17 @@ void ilist_post_delete(ilist_t *list)
 int ilist_post_insert(ilist_t *list, code_t *instr)
 {
    /* Check if the list is active.  */
-   if(list->activ != NULL)
+   if(list->activ != ILIST_NULL)
    {
-      /* Allocate memory for new element + error handling.  */
-      ilist_elem_t *new_elem = smalloc(sizeof(ilist_elem_t));
+      /* Take new element from the pool + error handling.  */
+      int new_elem = ilist_alloc(instr);
 
-      if(new_elem == NULL)
+      if(new_elem == ILIST_NULL)
          return ILIST_INSERT_FAILURE;
 
-      /* Fill up new element data and create links. */
-      memcpy(&new_elem->data, instr, sizeof(code_t));
-      new_elem->lneigh = list->activ;
-      new_elem->rneigh = list->activ->rneigh;
+      /* Create links of the new element.  */
+      ILIST_LNEIGH(new_elem) = list->activ;
+      ILIST_RNEIGH(new_elem) = ILIST_RNEIGH(list->activ);
 
       /* If the active element was last, change it to new element.   */
       if(list->activ == list->last)
@@ -320,10 +437,10 @@ int ilist_post_insert(ilist_t *list, code_t *instr)
        * one being added.
        */
       else
-         new_elem->rneigh->lneigh = new_elem;
+         ILIST_LNEIGH(ILIST_RNEIGH(new_elem)) = new_elem;
 
       /* Finally - link the new element to the active one.  */
-      list->activ->rneigh = new_elem;
+      ILIST_RNEIGH(list->activ) = new_elem;
 
       list->size++;
    }
@@ -334,21 +451,21 @@ int ilist_post_insert(ilist_t *list, code_t *instr)
 void ilist_pre_delete(ilist_t *list)
 {
    /* Check if the list is active and the active element is not first.   */
-   if(list->activ != NULL && list->activ->lneigh != NULL)
+   if(list->activ != ILIST_NULL && ILIST_LNEIGH(list->activ) != ILIST_NULL)
    {
-      /* Back up pointer to the deleted element.   */
-      ilist_elem_t *elem_to_del = list->activ->lneigh;
-      /* Set pointer to next element after the deletion process. */
-      list->activ->lneigh = elem_to_del->lneigh;
+      /* Back up index of the deleted element.   */
+      int elem_to_del = ILIST_LNEIGH(list->activ);
+      /* Set index of the previous element after the deletion process. */
+      ILIST_LNEIGH(list->activ) = ILIST_LNEIGH(elem_to_del);
 
       /* If the deleted element is not first, modify links with the active.  */
       if(elem_to_del != list->first)
-         list->activ->lneigh->rneigh = list->activ;
+         ILIST_RNEIGH(ILIST_LNEIGH(list->activ)) = list->activ;
       /* If the deleted element is the first, link first to active.  */
       else
          list->first = list->activ;
 
-      sfree(elem_to_del);
+      ilist_release(elem_to_del);
 
       list->size--;
    }
@@ -359,18 +476,17 @@ void ilist_pre_delete(ilist_t *list)
 int ilist_pre_insert(ilist_t *list, code_t *instr)
 {
    /* Check if the list is active.  */
-   if(list->activ != NULL)
+   if(list->activ != ILIST_NULL)
    {
-      /* Allocate memory for new element + error handling.  */
-      ilist_elem_t *new_elem = smalloc(sizeof(ilist_elem_t));
+      /* Take new element from the pool + error handling.  */
+      int new_elem = ilist_alloc(instr);
 
-      if(new_elem == NULL)
+      if(new_elem == ILIST_NULL)
          return ILIST_INSERT_FAILURE;
 
-      /* Fill up new element data and create links. */
-      memcpy(&new_elem->data, instr, sizeof(code_t));
-      new_elem->lneigh = list->activ->lneigh;
-      new_elem->rneigh = list->activ;
+      /* Create links of the new element.  */
+      ILIST_LNEIGH(new_elem) = ILIST_LNEIGH(list->activ);
+      ILIST_RNEIGH(new_elem) = list->activ;
 
       /* If the active element was first, change it to new element.   */
       if(list->activ == list->first)
@@ -380,10 +496,10 @@ int ilist_pre_insert(ilist_t *list, code_t *instr)
        * the one being added.
        */
       else
-         new_elem->lneigh->rneigh = new_elem;
+         ILIST_RNEIGH(ILIST_LNEIGH(new_elem)) = new_elem;
 
       /* Finally - link the new element to the active one.  */
-      list->activ->lneigh = new_elem;
+      ILIST_LNEIGH(list->activ) = new_elem;
 
       list->size++;
    }
@@ -393,8 +509,15 @@ int ilist_pre_insert(ilist_t *list, code_t *instr)
 
 void ilist_prev(ilist_t *list)
 {
-   if(list->activ != NULL)
-      list->activ = list->activ->lneigh;
+   if(list->activ != ILIST_NULL)
+      list->activ = ILIST_LNEIGH(list->activ);
+
+   return;
+}
+
+void ilist_set_active(ilist_t *list, int index)
+{
+   list->activ = index;
 
    return;
 }
@@ -402,4 +525,4 @@ void ilist_prev(ilist_t *list)
 int ilist_size(ilist_t *list)
 {
    return list->size;
-}
\ No newline at end of file
+}
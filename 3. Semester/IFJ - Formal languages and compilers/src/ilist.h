@@ -6,6 +6,13 @@
  *
  * Module provides doubly linked list interface for used for storing
  * instructions prior to their generation and optimization.
+ *
+ * Elements of all lists are kept in one instruction pool made of chunks of
+ * ILIST_CHUNK_SIZ elements.  Chunks are never moved, so each element keeps
+ * its index (and the address of its code_t) until it is deleted.  Links
+ * between the elements are indices kept in separate arrays of the chunk, so
+ * no allocation is done per instruction and traversal stays in contiguous
+ * memory.  Deleted elements are reused by later insertions.
  */
 
 #ifndef ILIST_H_INCLUDED
@@ -13,6 +20,15 @@
 
 #include "ifj17_api.h"
 
+/** @brief Index standing for no element of the list.  */
+#define ILIST_NULL 0
+
+/** @brief Number of elements in one chunk of the pool, power of 2.   */
+#define ILIST_CHUNK_SIZ 1024
+
+/** @brief Initial size of the chunk table of the pool.   */
+#define ILIST_CHUNKS_INIT_SIZ 16
+
 /** @brief Defines instruction list insertion success output code.   */
 #define ILIST_INSERT_SUCCESS 0
 
@@ -39,6 +55,15 @@
  */
 int ilist_active(ilist_t *list);
 
+/**
+ * @brief Returns contents of the element with the given index.
+ *
+ * @param index Index of the element.
+ * @return Pointer to code_t data structure or NULL, if the index is
+ *         ILIST_NULL.
+ */
+code_t * ilist_at(int index);
+
 /**
  * @brief Returns contents of the active element of the list.
  *
@@ -108,7 +133,8 @@ int ilist_empty(ilist_t *list);
 void ilist_first(ilist_t *list);
 
 /**
- * @brief Frees all data in the list and sets control pointers to NULL.
+ * @brief Returns all elements of the list to the pool and sets control
+ *        indices to ILIST_NULL.
  *
  * @param *list Pointer to the list data type.
  * @return void.
@@ -116,13 +142,49 @@ void ilist_first(ilist_t *list);
 void ilist_free(ilist_t *list);
 
 /**
- * @brief Initializes doubly-linked list, setting all control pointers to NULL.
+ * @brief Returns index of the active element of the list.
+ *
+ * @param *list Pointer to the list data type.
+ * @return Index of the active element or ILIST_NULL if the list is not
+ *         active.
+ */
+int ilist_index(ilist_t *list);
+
+/**
+ * @brief Returns index of the element following the given one.
+ *
+ * @param index Index of the element, must not be ILIST_NULL.
+ * @return Index of the next element or ILIST_NULL if the element is last.
+ */
+int ilist_index_next(int index);
+
+/**
+ * @brief Returns index of the element preceding the given one.
+ *
+ * @param index Index of the element, must not be ILIST_NULL.
+ * @return Index of the previous element or ILIST_NULL if the element is
+ *         first.
+ */
+int ilist_index_prev(int index);
+
+/**
+ * @brief Initializes doubly-linked list, setting all control indices to
+ *        ILIST_NULL.
  *
  * @param *list Pointer to the list data type.
  * @return void.
  */
 void ilist_init(ilist_t *list);
 
+/**
+ * @brief Forgets the pool of elements shared by all lists.  Used between
+ *        inputs of the batch mode, after the chunks of the pool were freed
+ *        by memman_clear().  All lists have to be initialized again.
+ *
+ * @return void.
+ */
+void ilist_reinit();
+
 /**
  * @brief Inserts element to the start of the list.
  *
@@ -218,6 +280,16 @@ int ilist_pre_insert(ilist_t *list, code_t *instr);
  */
 void ilist_prev(ilist_t *list);
 
+/**
+ * @brief Sets list activity to the element with the given index.
+ *
+ * @param *list Pointer to the list data type.
+ * @param index Index of the element of the list or ILIST_NULL to make the
+ *              list inactive.
+ * @return void.
+ */
+void ilist_set_active(ilist_t *list, int index);
+
 /**
  * @brief Returns number of elements contained in the list.
  *
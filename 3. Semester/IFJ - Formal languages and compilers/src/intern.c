@@ -0,0 +1,235 @@
+/**
+ * @file intern.c
+ * @brief Identifier interning module for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module keeps exactly one copy of every distinct identifier.  Scanner
+ * interns identifiers when it reads them, so equal names share the same
+ * pointer.  Symbol table then compares keys by pointer and takes their hash
+ * from the interned copy instead of hashing the name on every search.
+ *
+ * Interned strings are stored in pool chunks, each preceded by its hash and
+ * length.  A string is recognized as already interned in constant time by the
+ * address range of the pool chunks.  Lookup of other strings is done through
+ * an open-addressing hash table.  All memory is tracked by the safe_malloc
+ * module.
+ */
+
+#include "intern.h"
+#include "safe_malloc.h"
+#include "symtable.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** @brief Interned string preceded by its metadata.  */
+typedef struct intern_entry
+{
+   unsigned int hash;               ///< Hash of the string
+   unsigned int len;                ///< Length of the string
+   char str[];                      ///< The string itself
+} intern_entry_t;
+
+/** @brief Chunk of memory, which interned strings are carved from.   */
+typedef struct intern_pool
+{
+   char *data;                      ///< Start of the chunk
+   size_t size;                     ///< Size of the chunk
+   size_t used;                     ///< Used bytes of the chunk
+} intern_pool_t;
+
+/** @brief Hash table of interned strings.  */
+static intern_entry_t **entries = NULL;
+
+/** @brief Number of slots of the hash table.  */
+static unsigned int entries_size = 0;
+
+/** @brief Number of interned strings.  */
+static unsigned int entries_count = 0;
+
+/** @brief Pool chunks, the last one is used for new strings.  */
+static intern_pool_t pools[INTERN_MAX_POOLS];
+
+/** @brief Number of used pool chunks.  */
+static int pools_count = 0;
+
+/*
+ * Returns entry of the string, if the string lies in one of the pools.
+ * Integer comparison of the addresses avoids comparing unrelated pointers.
+ */
+static intern_entry_t *intern_owner(const char *str)
+{
+   uintptr_t addr = (uintptr_t)str;
+
+   /* Recent pools are the most probable ones.  */
+   for(int i = pools_count - 1; i >= 0; i--)
+   {
+      uintptr_t start = (uintptr_t)pools[i].data;
+
+      if(addr >= start && addr < start + pools[i].used)
+         return (intern_entry_t *)(str - offsetof(intern_entry_t, str));
+   }
+
+   return NULL;
+}
+
+/*
+ * Finds the slot of the string in the hash table.  Returns slot with the
+ * string or the empty slot where the string belongs.
+ */
+static unsigned int intern_slot(const char *str, unsigned int hash)
+{
+   unsigned int mask = entries_size - 1;
+   unsigned int i = hash & mask;
+
+   /* Linear probing until the string or an empty slot is found.  */
+   while(entries[i] != NULL && 
+         (entries[i]->hash != hash || strcmp(entries[i]->str, str)))
+      i = (i + 1) & mask;
+
+   return i;
+}
+
+/*
+ * Doubles the hash table and reinserts all entries.
+ */
+static int intern_grow()
+{
+   intern_entry_t **old = entries;
+   unsigned int old_size = entries_size;
+
+   entries = scalloc(2 * old_size, sizeof(intern_entry_t *));
+
+   if(entries == NULL)
+   {
+      entries = old;
+      return INTERN_FAILURE;
+   }
+
+   entries_size = 2 * old_size;
+
+   /* Hashes are stored, strings do not need to be compared.  */
+   for(unsigned int i = 0; i < old_size; i++)
+   {
+      if(old[i] != NULL)
+      {
+         unsigned int j = old[i]->hash & (entries_size - 1);
+
+         while(entries[j] != NULL)
+            j = (j + 1) & (entries_size - 1);
+
+         entries[j] = old[i];
+      }
+   }
+
+   sfree(old);
+
+   return INTERN_SUCCESS;
+}
+
+/*
+ * Allocates a new entry from the pools.
+ */
+static intern_entry_t *intern_alloc(unsigned int len)
+{
+   /* Keep every entry aligned like the entry structure.   */
+   size_t siz = (sizeof(intern_entry_t) + len + 1 + sizeof(intern_entry_t) - 1)
+                / sizeof(intern_entry_t) * sizeof(intern_entry_t);
+   intern_pool_t *pool = (pools_count) ? &pools[pools_count - 1] : NULL;
+
+   /* Start a new pool, twice as big as the previous one.  */
+   if(pool == NULL || pool->size - pool->used < siz)
+   {
+      size_t pool_siz = (pool) ? 2 * pool->size : INTERN_POOL_SIZ;
+
+      while(pool_siz < siz)
+         pool_siz *= 2;
+
+      if(pools_count == INTERN_MAX_POOLS)
+         return NULL;
+
+      pool = &pools[pools_count];
+      pool->data = smalloc(pool_siz);
+
+      if(pool->data == NULL)
+         return NULL;
+
+      pool->size = pool_siz;
+      pool->used = 0;
+      pools_count++;
+   }
+
+   intern_entry_t *entry = (intern_entry_t *)(pool->data + pool->used);
+
+   pool->used += siz;
+
+   return entry;
+}
+
+int intern_init()
+{
+   entries = scalloc(INTERN_INIT_SIZ, sizeof(intern_entry_t *));
+
+   if(entries == NULL)
+      return INTERN_FAILURE;
+
+   entries_size = INTERN_INIT_SIZ;
+   entries_count = 0;
+   pools_count = 0;
+
+   return INTERN_SUCCESS;
+}
+
+char *intern_cstring(const char *str)
+{
+   intern_entry_t *entry = intern_owner(str);
+
+   /* String is already interned.   */
+   if(entry != NULL)
+      return entry->str;
+
+   unsigned int hash = hash_fnv32(str);
+   unsigned int slot = intern_slot(str, hash);
+
+   if(entries[slot] != NULL)
+      return entries[slot]->str;
+
+   /* Create new entry.  */
+   unsigned int len = strlen(str);
+
+   entry = intern_alloc(len);
+
+   if(entry == NULL)
+      return NULL;
+
+   entry->hash = hash;
+   entry->len = len;
+   memcpy(entry->str, str, len + 1);
+
+   /* Keep load factor under 1/2.   */
+   entries[slot] = entry;
+   entries_count++;
+
+   if(2 * entries_count > entries_size && intern_grow() == INTERN_FAILURE)
+      return NULL;
+
+   return entry->str;
+}
+
+char *intern_lookup(const char *str)
+{
+   intern_entry_t *entry = intern_owner(str);
+
+   if(entry != NULL)
+      return entry->str;
+
+   unsigned int slot = intern_slot(str, hash_fnv32(str));
+
+   return (entries[slot] != NULL) ? entries[slot]->str : NULL;
+}
+
+unsigned int intern_hash(const char *str)
+{
+   return ((intern_entry_t *)(str - offsetof(intern_entry_t, str)))->hash;
+}
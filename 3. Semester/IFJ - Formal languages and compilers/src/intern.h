@@ -0,0 +1,72 @@
+/**
+ * @file intern.h
+ * @brief Identifier interning module for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module keeps exactly one copy of every distinct identifier.  Scanner
+ * interns identifiers when it reads them, so equal names share the same
+ * pointer.  Symbol table then compares keys by pointer and takes their hash
+ * from the interned copy instead of hashing the name on every search.
+ *
+ * Interned strings are stored in pool chunks, each preceded by its hash and
+ * length.  A string is recognized as already interned in constant time by the
+ * address range of the pool chunks.  Lookup of other strings is done through
+ * an open-addressing hash table.  All memory is tracked by the safe_malloc
+ * module.
+ */
+
+#ifndef INTERN_H_INCLUDED
+#define INTERN_H_INCLUDED 1
+
+/** @brief Interning module success identifier.  */
+#define INTERN_SUCCESS 0
+
+/** @brief Interning module failure identifier.  */
+#define INTERN_FAILURE 1
+
+/** @brief Initial number of hash table slots, has to be a power of 2.  */
+#define INTERN_INIT_SIZ 256
+
+/** @brief Size of the first pool chunk, every next one is twice as big.  */
+#define INTERN_POOL_SIZ 4096
+
+/** @brief Maximal number of pool chunks.  */
+#define INTERN_MAX_POOLS 32
+
+/**
+ * @brief Initializes the hash table and forgets all previously interned
+ *        strings.
+ *
+ * @return INTERN_SUCCESS if the allocation was successful, INTERN_FAILURE
+ *         otherwise.
+ */
+int intern_init();
+
+/**
+ * @brief Returns the interned copy of the string, creating it if the string
+ *        has not been interned yet.  Interned strings must not be modified
+ *        nor freed.
+ *
+ * @param str NUL terminated string to be interned.
+ * @return Interned copy of the string, NULL if the allocation failed.
+ */
+char *intern_cstring(const char *str);
+
+/**
+ * @brief Returns the interned copy of the string without creating it.
+ *
+ * @param str NUL terminated string to be searched.
+ * @return Interned copy of the string, NULL if it has not been interned.
+ */
+char *intern_lookup(const char *str);
+
+/**
+ * @brief Returns the hash of the interned string computed by hash_fnv32().
+ *
+ * @param str String returned by intern_cstring() or intern_lookup().
+ * @return Hash of the string.
+ */
+unsigned int intern_hash(const char *str);
+
+#endif
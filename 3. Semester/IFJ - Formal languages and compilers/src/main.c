@@ -7,47 +7,124 @@
  * Program for IFJ Project 2017 loads code in source language IFJ17 and
  * interpretes it into the IFJcode17. This code is then furtherly interpreted
  * using IFJ17 interpreter.
+ *
+ * In the batch mode, one process compiles many inputs.  Modules are returned
+ * to their initial state by their reinit functions between the inputs and
+ * the whole memory of an input is released by memman_clear().
  */
 
+/* fork() and waitpid() of the batch workers are POSIX.  */
+#define _POSIX_C_SOURCE 200112L
+
 /*    Includes section   */
+#include "emit.h"
 #include "error.h"
+#include "fcache.h"
 #include "generator.h"
 #include "ifj17_api.h"
 #include "ilist.h"
+#include "intern.h"
+#include "optimizer.h"
 #include "parser.h"
 #include "safe_malloc.h"
+#include "scanner.h"
+#include "stats.h"
 #include "str.h"
+#include <limits.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**   @brief Defines option selecting the output file.   */
+#define ARG_OUTPUT "-o"
+
+/**
+ * @brief Defines option enabling the optimizer: inlining, dead code removal,
+ *        loop-invariant hoisting, peephole rules and temporary reuse.
+ */
+#define ARG_OPTIMIZE "-O"
+
+/**   @brief Defines option setting maximal size of inlined functions.   */
+#define ARG_INLINE "-i"
+
+/**   @brief Defines option printing reports of the optimizer to stderr.   */
+#define ARG_REPORT "-r"
+
+/**   @brief Defines option selecting the stack backend of expressions.   */
+#define ARG_STACK "-s"
+
+/**   @brief Defines option compiling a list of files or a stream (batch).   */
+#define ARG_BATCH "-b"
+
+/**   @brief Defines option setting number of worker processes of the batch. */
+#define ARG_WORKERS "-j"
+
+/**   @brief Defines maximal number of worker processes.   */
+#define MAX_WORKERS 64
+
+/**   @brief Defines extension of the outputs of the batch mode.   */
+#define BATCH_EXTENSION ".code"
+
+/**   @brief Defines option selecting directory of the function cache.   */
+#define ARG_CACHE "-c"
 
-/**   @brief Defines expected number of argumens on program start.   */
-#define ARG_NUM 1
+/**   @brief Defines option printing compile statistics (IFJ_STATS only).   */
+#define ARG_STATS "--stats"
 
 /**   @brief Defines info/error message on incorrect params run.  */
 #define USAGE \
 "./ifj17 - IFJ17 language interpreter. Program loads ifj17 source language \
-           from stdin and produces output in IFJcode17 to stdout. \
+           from stdin and produces output in IFJcode17 to stdout, or to \
+           the file given by option -o.  Option -O enables the \
+           optimizer (inlining, dead code removal, loop-invariant \
+           hoisting, peephole rules and temporary reuse), option -r \
+           prints reports of these passes (inlined calls, removed code, \
+           hoisted code, rule hit counts, reused temporaries) to stderr. \
+           Option -i sets maximal size of functions inlined by the \
+           optimizer, 0 disables the inlining.  Option -s compiles \
+           expressions to stack instructions instead of three-address \
+           code.  Option --stats prints times of the phases, counters and \
+           memory statistics as JSON to stderr, if the compiler was \
+           built by 'make stats'.  Option -b compiles every given file \
+           to the file with extension .code in one process, option -j \
+           divides the files among the given number of worker processes. \
+           Without files, -b reads records '<length>\\n<source>' from \
+           stdin and writes records '<exit code> <length>\\n<code>' to \
+           stdout.  Option -c keeps generated code of function bodies \
+           in the given directory and reuses it for unchanged functions. \
 Example run: \
-./ifj17 < source.ifj > output.ifjc"
+./ifj17 < source.ifj > output.ifjc \
+./ifj17 -O -r -i 32 -s -o output.ifjc < source.ifj \
+./ifj17 -b -j 4 first.ifj second.ifj third.ifj \
+./ifj17 -c .ifj17cache -o output.ifjc < source.ifj"
 
 ilist_t instructs;            ///< Instruction list
 ilist_t global_var_ilist;     ///< Global variables list
 ilist_t *code_list;
 
-int main(int argc, char **argv)
+static bool optimize = false;                ///< Run the optimizer
+static long inline_size = OPT_INLINE_SIZE;   ///< Maximal size of inlined funcs
+static FILE *opt_report = NULL;              ///< Optimizer reports, NULL none
+
+/*
+ * Compiles the source previously set by set_source_file() or
+ * set_source_data().  Code is written to the file at output_path (stdout if
+ * NULL), or to output_stream if it is not NULL, only if the compilation
+ * succeeds.  Returns exit code of the compilation.
+ */
+static int compile_source(const char *output_path, FILE *output_stream)
 {
-   (void)argv;
    int out_code = 0;
 
-   /* Check correct program run. */
-   if(argc != ARG_NUM)
-   {
-      fprintf(stderr, USAGE);
-      return INTERNAL_ERR;
-   }
-
    /* Memory and dynamic structures initializations.  */
-   memman_init();
+   status = 0;
+   out_code = intern_init();
+   if(out_code)
+      return INTERNAL_ERR;
    out_code = str_init(&str);
    if(out_code)
       return INTERNAL_ERR;
@@ -65,24 +142,59 @@ int main(int argc, char **argv)
 
    //FIXME error checky po inicializaciach + korektne uvolennie + internal err
 
-   /* Set source file as sdtin.  */
-   set_source_file(stdin);
-
    /* Set default code_list to instucts */
    code_list = &instructs;
 
    /* Start the parsing process. */
    token.id = -2;                   //Ensure no invalid free in GET_TOKEN
+   STATS_START(STATS_PHASE_PARSER);
    GET_TOKEN(token);
    parse();
+   STATS_STOP(STATS_PHASE_PARSER);
 
    if(status == 0)
    {
+      STATS_START(STATS_PHASE_ORDER);
       order_ilist(&instructs);
-      instruction_print(&instructs);
+      STATS_STOP(STATS_PHASE_ORDER);
+      STATS_COUNT(STATS_INSTRUCTIONS, ilist_size(&instructs));
+
+      STATS_START(STATS_PHASE_OPTIMIZER);
+      if(optimize)
+      {
+         opt_stats_t stats = {{0}, 0};
+
+         if(opt_inline(&instructs, inline_size, opt_report) != OPT_SUCCESS ||
+            opt_dead_code(&instructs, opt_report) != OPT_SUCCESS)
+            status = INTERNAL_ERR;
+         else if(opt_peephole(&instructs, &stats) != OPT_SUCCESS)
+            status = INTERNAL_ERR;
+         else if(opt_report != NULL)
+            opt_print_stats(opt_report, &stats);
+
+         if(status == 0 &&
+            opt_hoist_invariants(&instructs, opt_report) != OPT_SUCCESS)
+            status = INTERNAL_ERR;
+         if(status == 0 &&
+            opt_reuse_temps(&instructs, opt_report) != OPT_SUCCESS)
+            status = INTERNAL_ERR;
+      }
+      STATS_STOP(STATS_PHASE_OPTIMIZER);
+
+      if(((output_stream != NULL) ? emit_open_stream(output_stream)
+                                  : emit_open(output_path)) == EMIT_SUCCESS)
+      {
+         STATS_START(STATS_PHASE_PRINT);
+         instruction_print(&instructs);
+         if(emit_close() != EMIT_SUCCESS)
+            status = INTERNAL_ERR;
+         STATS_STOP(STATS_PHASE_PRINT);
+      }
+      else
+         status = INTERNAL_ERR;
    }
 
-   /* Deallocate data structures and end the program. */
+   /* Deallocate data structures. */
    tstack_free(&semStack);
    tstack_free(&instr_stack);
    stab_clear(&global_table);
@@ -90,7 +202,265 @@ int main(int argc, char **argv)
    ilist_free(&instructs);
    ilist_free(&global_var_ilist);
    str_free(&str);
-   memman_free_all();
 
    return status;
 }
+
+/*
+ * Releases whole memory of the compiled input and returns the modules to
+ * their initial state, so the next input is compiled as by a new process.
+ */
+static void compile_reset()
+{
+   memman_clear();
+   scanner_reinit();
+   parser_reinit();
+   generator_reinit();
+   ilist_reinit();
+   fcache_reinit();
+}
+
+/*
+ * Compiles a single file of the batch to the file with BATCH_EXTENSION
+ * instead of its extension.  Returns exit code of the compilation, failures
+ * are reported to stderr together with the path.
+ */
+static int batch_file(const char *path)
+{
+   FILE *input = fopen(path, "r");
+   const char *name = strrchr(path, '/');
+   const char *dot = strrchr((name != NULL) ? name : path, '.');
+   size_t base_len = (dot != NULL) ? (size_t)(dot - path) : strlen(path);
+   char *output_path = smalloc(base_len + sizeof(BATCH_EXTENSION));
+   int result = 0;
+
+   if(input == NULL || output_path == NULL)
+      result = INTERNAL_ERR;
+   else if(set_source_file(input) != SOURCE_SUCCESS)
+      result = INTERNAL_ERR;
+   else
+   {
+      memcpy(output_path, path, base_len);
+      strcpy(output_path + base_len, BATCH_EXTENSION);
+      result = compile_source(output_path, NULL);
+   }
+
+   if(input != NULL)
+      fclose(input);
+   compile_reset();
+
+   if(result != 0)
+      fprintf(stderr, "%s: error %d\n", path, result);
+
+   return result;
+}
+
+/*
+ * Compiles files first, first + step, ... of the batch.  Returns exit code
+ * of the first failed file or 0.
+ */
+static int batch_files(char **inputs, int count, int first, int step)
+{
+   int result = 0;
+
+   for(int i = first; i < count; i += step)
+   {
+      int file_result = batch_file(inputs[i]);
+
+      if(result == 0)
+         result = file_result;
+   }
+
+   return result;
+}
+
+/*
+ * Divides the files of the batch among the worker processes, worker w
+ * compiles files w, w + workers, ...  Every module keeps its state in
+ * globals, so workers are forked processes, not threads.  Files of a
+ * worker, which could not be forked, are compiled by the caller.  Returns
+ * the first nonzero exit code of the workers in their order, in the worker
+ * processes returns their own exit code.
+ */
+static int batch_run(char **inputs, int count, int workers)
+{
+   pid_t pids[MAX_WORKERS];
+   int results[MAX_WORKERS];
+   int result = 0;
+
+   if(workers > count)
+      workers = count;
+   if(workers <= 1)
+      return batch_files(inputs, count, 0, 1);
+
+   /* Buffered output would be written by the workers again.  */
+   fflush(NULL);
+
+   for(int w = 0; w < workers; w++)
+   {
+      pids[w] = fork();
+      if(pids[w] == 0)
+         return batch_files(inputs, count, w, workers);
+      else if(pids[w] < 0)
+         results[w] = batch_files(inputs, count, w, workers);
+   }
+
+   for(int w = 0; w < workers; w++)
+   {
+      int wstatus;
+
+      if(pids[w] > 0)
+      {
+         if(waitpid(pids[w], &wstatus, 0) == pids[w] && WIFEXITED(wstatus))
+            results[w] = WEXITSTATUS(wstatus);
+         else
+            results[w] = INTERNAL_ERR;
+      }
+
+      if(result == 0)
+         result = results[w];
+   }
+
+   return result;
+}
+
+/*
+ * Compiles stream of records '<length>\n<source>' read from input and writes
+ * a record '<exit code> <length>\n<code>' for each of them to output, which
+ * is flushed after every record.  Returns exit code of the first failed
+ * record or INTERNAL_ERR if the stream is malformed.
+ */
+static int batch_stream(FILE *input, FILE *output)
+{
+   FILE *code = tmpfile();          //Code of the current record
+   char block[BUFSIZ];
+   size_t len;
+   int result = 0;
+
+   if(code == NULL)
+      return INTERNAL_ERR;
+
+   while(fscanf(input, "%zu", &len) == 1 && getc(input) == '\n')
+   {
+      char *data = smalloc(len + 1);
+      int record_result;
+      long code_len;
+
+      if(data == NULL || fread(data, 1, len, input) != len)
+      {
+         result = INTERNAL_ERR;
+         break;
+      }
+
+      rewind(code);
+      set_source_data(data, len);
+      record_result = compile_source(NULL, code);
+      compile_reset();
+
+      /* Code is written only by successful compilations.  */
+      code_len = (record_result == 0) ? ftell(code) : 0;
+      rewind(code);
+      fprintf(output, "%d %ld\n", record_result, code_len);
+      while(code_len > 0)
+      {
+         size_t part = fread(block, 1, ((size_t)code_len < sizeof(block)) ?
+                             (size_t)code_len : sizeof(block), code);
+
+         if(part == 0)
+            break;
+         fwrite(block, 1, part, output);
+         code_len -= part;
+      }
+      fflush(output);
+
+      if(result == 0)
+         result = record_result;
+   }
+
+   if(result == 0 && (!feof(input) || ferror(input)))
+      result = INTERNAL_ERR;
+
+   fclose(code);
+
+   return result;
+}
+
+int main(int argc, char **argv)
+{
+   int out_code = 0;
+   char *output_path = NULL;        //Output file, stdout if NULL
+   char *cache_path = NULL;         //Function cache directory
+   char *inputs[argc];              //Files of the batch mode
+   int input_count = 0;
+   bool batch = false;              //Batch mode
+   long workers = 1;                //Number of worker processes
+   char *end;
+
+   /* Check correct program run. */
+   for(int i = 1; i < argc; i++)
+   {
+      if(!strcmp(argv[i], ARG_OUTPUT) && i + 1 < argc && output_path == NULL)
+         output_path = argv[++i];
+      else if(!strcmp(argv[i], ARG_CACHE) && i + 1 < argc && cache_path == NULL)
+         cache_path = argv[++i];
+      else if(!strcmp(argv[i], ARG_OPTIMIZE))
+         optimize = true;
+      else if(!strcmp(argv[i], ARG_REPORT))
+         opt_report = stderr;
+      else if(!strcmp(argv[i], ARG_STACK))
+         expr_backend = EXPR_BACKEND_STACK;
+      else if(!strcmp(argv[i], ARG_BATCH))
+         batch = true;
+      else if(argv[i][0] != '-')
+         inputs[input_count++] = argv[i];
+#ifdef IFJ_STATS
+      else if(!strcmp(argv[i], ARG_STATS))
+         STATS_ENABLE();
+#endif
+      else if(!strcmp(argv[i], ARG_INLINE) && i + 1 < argc &&
+              (inline_size = strtol(argv[i + 1], &end, 10)) >= 0 &&
+              inline_size <= INT_MAX && *argv[++i] != '\0' && *end == '\0')
+         continue;
+      else if(!strcmp(argv[i], ARG_WORKERS) && i + 1 < argc &&
+              (workers = strtol(argv[i + 1], &end, 10)) >= 1 &&
+              workers <= MAX_WORKERS && *argv[++i] != '\0' && *end == '\0')
+         continue;
+      else
+      {
+         fprintf(stderr, USAGE);
+         return INTERNAL_ERR;
+      }
+   }
+
+   if((!batch && (input_count > 0 || workers > 1)) ||
+      (batch && output_path != NULL))
+   {
+      fprintf(stderr, USAGE);
+      return INTERNAL_ERR;
+   }
+
+   if(cache_path != NULL && fcache_open(cache_path) != FCACHE_SUCCESS)
+   {
+      fprintf(stderr, "Cannot use function cache directory %s\n", cache_path);
+      return INTERNAL_ERR;
+   }
+
+   STATS_START(STATS_PHASE_TOTAL);
+   memman_init();
+
+   if(batch && input_count == 0)
+      out_code = batch_stream(stdin, stdout);
+   else if(batch)
+      out_code = batch_run(inputs, input_count, workers);
+   else if(set_source_file(stdin) != SOURCE_SUCCESS)
+      out_code = INTERNAL_ERR;
+   else
+      out_code = compile_source(output_path, NULL);
+
+   /* Every worker of the batch reports its own statistics.  */
+   STATS_STOP(STATS_PHASE_TOTAL);
+   STATS_REPORT(stderr);
+   memman_free_all();
+
+   return out_code;
+}
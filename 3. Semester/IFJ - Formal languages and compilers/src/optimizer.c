@@ -0,0 +1,2050 @@
+/**
+ * @file optimizer.c
+ * @brief Optimizer of generated code for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module optimizes generated IFJcode17 instruction list before it is
+ * printed.  Small functions are inlined at their call sites.  Dead code
+ * elimination removes unreachable code and unread variables.  Peephole
+ * optimizer rewrites short redundant sequences of instructions produced by
+ * the generator.  Removed instructions are not unlinked from the list, they
+ * are marked by NO_PRINT_ID the same way as hoisted definitions in
+ * order_ilist().  Invariant computations are moved out of loops.
+ * Temporaries with disjoint live ranges are renamed to share a single
+ * variable of the function frame.  Reports of the passes are printed only
+ * to the stream given by the caller, main.c passes stderr for option -r.
+ */
+
+#include "generator.h"
+#include "ilist.h"
+#include "optimizer.h"
+#include "safe_malloc.h"
+#include "scanner.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Number of operands of an instruction.  */
+#define OPT_OPERANDS 3
+
+/** @brief Prefix of temporary variables created by the generator.  */
+#define OPT_TMP_PREFIX "LF@%tmp"
+
+/** @brief Initial size of the array of temporary usage counters.  */
+#define OPT_USES_INIT_SIZ 256
+
+/** @brief Initial size of the arrays used by temporary reuse.  */
+#define OPT_ARRAY_INIT_SIZ 64
+
+/** @brief Room for the suffix of names renamed by inlining.  */
+#define OPT_INLINE_SUFFIX_SIZ 16
+
+/** @brief Usage of a temporary variable in the instruction list.  */
+typedef struct opt_uses
+{
+   int reads;                 ///< Number of instructions reading it.
+   int writes;                ///< Number of instructions writing to it.
+   int defs;                  ///< Number of its definitions.
+   int function;              ///< Function using it, 0 none, -1 more.
+   int first;                 ///< Start of the live range, 0 if unused.
+   int last;                  ///< End of the live range.
+   int labels;                ///< Labels passed before the first use.
+   bool joined;               ///< Live range may be entered by a jump.
+   int slot;                  ///< Slot the temporary is renamed to.
+} opt_uses_t;
+
+/** @brief Temporary used in the function being processed.  */
+typedef struct opt_temp
+{
+   int index;                 ///< Number of the temporary.
+   char *name;                ///< Name of the temporary.
+} opt_temp_t;
+
+/** @brief Label in the function being processed.  */
+typedef struct opt_label
+{
+   char *name;                ///< Name of the label.
+   int pos;                   ///< Position of the label.
+} opt_label_t;
+
+/** @brief Loop closed by a jump back to a label.  */
+typedef struct opt_loop
+{
+   int begin;                 ///< Position of the label.
+   int end;                   ///< Position of the jump.
+} opt_loop_t;
+
+/** @brief Variable shared by temporaries with disjoint live ranges.  */
+typedef struct opt_slot
+{
+   char *name;                ///< Name of the variable.
+   int end;                   ///< End of the live range of the last user.
+} opt_slot_t;
+
+/** @brief Data collected about one function.  */
+typedef struct opt_function
+{
+   opt_temp_t *temps;         ///< Temporaries used by the function.
+   int temps_count;           ///< Number of temporaries.
+   int temps_size;            ///< Allocated size of temps.
+   opt_label_t *labels;       ///< Labels of the function.
+   int labels_count;          ///< Number of labels.
+   int labels_size;           ///< Allocated size of labels.
+   opt_loop_t *loops;         ///< Loops of the function.
+   int loops_count;           ///< Number of loops.
+   int loops_size;            ///< Allocated size of loops.
+   opt_slot_t *slots;         ///< Variables the temporaries are renamed to.
+   int slots_count;           ///< Number of slots.
+   int slots_size;            ///< Allocated size of slots.
+} opt_function_t;
+
+/** @brief Use of a variable by an instruction.  */
+typedef struct opt_ref
+{
+   char *name;                ///< Name of the variable.
+   int index;                 ///< Index of the instruction.
+   int role;                  ///< Role of the operand.
+   bool global;               ///< Instruction is in global_var_ilist.
+} opt_ref_t;
+
+/** @brief Data of the dead code elimination.  */
+typedef struct opt_dead
+{
+   opt_label_t *labels;       ///< Labels sorted by name, pos is their index.
+   int labels_count;          ///< Number of labels.
+   int labels_size;           ///< Allocated size of labels.
+   int *work;                 ///< Indexes of instructions to be visited.
+   int work_count;            ///< Number of instructions to be visited.
+   int work_size;             ///< Allocated size of work.
+   bool *reached;             ///< Reached instructions indexed by index.
+   opt_ref_t *refs;           ///< Uses of variables sorted by name.
+   int refs_count;            ///< Number of uses.
+   int refs_size;             ///< Allocated size of refs.
+} opt_dead_t;
+
+/** @brief Variable used in the instruction list.  */
+typedef struct opt_var
+{
+   char *name;                ///< Name of the variable.
+   int writes;                ///< Number of instructions writing to it.
+   int first_read;            ///< Position of the first read.
+   int last_read;             ///< Position of the last read.
+   int loop;                  ///< Loop the loop_writes belong to.
+   int loop_writes;           ///< Number of writes in the loop.
+   int read_loop;             ///< Loop it was already read in, -1 none.
+} opt_var_t;
+
+/** @brief Data of the loop-invariant code motion.  */
+typedef struct opt_licm
+{
+   int *pos;                  ///< Positions of instructions by index.
+   opt_ref_t *refs;           ///< Uses of variables sorted by name.
+   int refs_count;            ///< Number of uses.
+   int refs_size;             ///< Allocated size of refs.
+   opt_var_t *vars;           ///< Variables sorted by name.
+   int vars_count;            ///< Number of variables.
+   int vars_size;             ///< Allocated size of vars.
+   opt_loop_t *loops;         ///< Loops, inner loops go first.
+   int loops_count;           ///< Number of loops.
+   int loops_size;            ///< Allocated size of loops.
+   int *open;                 ///< Begin labels of loops not closed yet.
+   int open_count;            ///< Number of open loops.
+   int open_size;             ///< Allocated size of open.
+   char **passed;             ///< Labels passed in the searched loop.
+   int passed_count;          ///< Number of passed labels.
+   int passed_size;           ///< Allocated size of passed.
+   char **pending;            ///< Targets of forward jumps not passed yet.
+   int pending_count;         ///< Number of pending targets.
+   int pending_size;          ///< Allocated size of pending.
+} opt_licm_t;
+
+/** @brief Function which is a candidate for inlining.  */
+typedef struct opt_callee
+{
+   char *name;                ///< Label of the function.
+   int label;                 ///< Index of the label.
+   int frame;                 ///< Index of its PUSHFRAME.
+   int end;                   ///< Index of the instruction after the body.
+   int size;                  ///< Number of instructions of the body.
+   int max_tmp;               ///< Highest number of its temporaries.
+   bool inlinable;            ///< Body has no calls and frame instructions.
+} opt_callee_t;
+
+/** @brief Data of the function inlining.  */
+typedef struct opt_inline
+{
+   opt_callee_t *callees;     ///< Functions sorted by name.
+   int callees_count;         ///< Number of functions.
+   int callees_size;          ///< Allocated size of callees.
+   int next_tmp;              ///< Number of the next free temporary.
+   int instance;              ///< Number of the last inlined call.
+} opt_inline_t;
+
+/** @brief Usage counters indexed by the number of the temporary.  */
+static opt_uses_t *uses = NULL;
+
+/** @brief Allocated size of the uses array.  */
+static int uses_size = 0;
+
+/** @brief Names of the rules for statistics.  */
+static const char *rule_names[OPT_RULE_COUNT] =
+{
+   [OPT_RULE_PUSH_POP] = "push-pop",
+   [OPT_RULE_JUMP_NEXT] = "jump-next",
+   [OPT_RULE_TMP_MOVE] = "tmp-move",
+   [OPT_RULE_INT2FLOAT_CONST] = "int2float-const",
+   [OPT_RULE_DEAD_DEFVAR] = "dead-defvar"
+};
+
+int opt_role(int operation, int operand)
+{
+   switch(operation)
+   {
+      /* <var> <symb1> <symb2> instructions, var is the third operand.  */
+      case ADD_INS_ID:
+      case SUB_INS_ID:
+      case MUL_INS_ID:
+      case DIV_INS_ID:
+      case INT_DIV_INS_ID:
+      case EQ_INS_ID:
+      case LT_INS_ID:
+      case GT_INS_ID:
+      case OR_INS_ID:
+      case CONCAT_INS_ID:
+      case GETCHAR_INS_ID:
+         return (operand == 2) ? OPT_ROLE_WRITE : OPT_ROLE_READ;
+      /* Position of STRI2INT is printed as a number.  */
+      case STRI2INT_INS_ID:
+         if(operand == 2)
+            return OPT_ROLE_WRITE;
+         return (operand == 0) ? OPT_ROLE_READ : OPT_ROLE_NONE;
+      /* <var> <symb> instructions with var as the first operand.  */
+      case INT2FLOAT_INS_ID:
+      case FLOAT2R2EINT_INS_ID:
+         if(operand == 0)
+            return OPT_ROLE_WRITE;
+         return (operand == 1) ? OPT_ROLE_READ : OPT_ROLE_NONE;
+      /* <var> <symb> instructions with var as the second operand.  */
+      case MOVE_INS_ID:
+      case NOT_INS_ID:
+      case STRLEN_INS_ID:
+         if(operand == 1)
+            return OPT_ROLE_WRITE;
+         return (operand == 0) ? OPT_ROLE_READ : OPT_ROLE_NONE;
+      case DEFVAR_INS_ID:
+         return (operand == 0) ? OPT_ROLE_DEFINE : OPT_ROLE_NONE;
+      case POPS_INS_ID:
+      case READ_INS_ID:
+         return (operand == 0) ? OPT_ROLE_WRITE : OPT_ROLE_NONE;
+      case PUSHS_INS_ID:
+      case WRITE_INS_ID:
+         return (operand == 0) ? OPT_ROLE_READ : OPT_ROLE_NONE;
+      case CALL_INS_ID:
+      case JUMP_INS_ID:
+      case JUMPIFEQS_INS_ID:
+      case JUMPIFNEQS_INS_ID:
+      case LABEL_INS_ID:
+         return (operand == 0) ? OPT_ROLE_LABEL : OPT_ROLE_NONE;
+      case JUMPIFEQ_INS_ID:
+      case JUMPIFNEQ_INS_ID:
+         return (operand == 0) ? OPT_ROLE_LABEL : OPT_ROLE_READ;
+      default:
+         return OPT_ROLE_NONE;
+   }
+}
+
+/*
+ * Returns pointer to the operand of the instruction.
+ */
+static token_t *opt_operand(code_t *code, int operand)
+{
+   if(operand == 0)
+      return &(code->first_operand);
+   else if(operand == 1)
+      return &(code->second_operand);
+   else
+      return &(code->third_operand);
+}
+
+/*
+ * Determines if the operand is printed as a constant.
+ */
+static bool opt_is_const(token_t *operand)
+{
+   if(operand->id == TOKEN_TRUE_ID)
+      return true;
+
+   /* Type is checked first, as the printer does.  */
+   return (operand->type == INTEGER_ID || operand->type == DOUBLE_ID ||
+           operand->type == STRING_ID || operand->type == BOOLEAN_ID) &&
+          operand->is_const;
+}
+
+/*
+ * Returns name of the variable in the operand or NULL, if the operand is
+ * not a variable.
+ */
+static char *opt_var_name(code_t *code, int operand)
+{
+   int role = opt_role(code->operation_type, operand);
+   token_t *token = opt_operand(code, operand);
+
+   if(role == OPT_ROLE_NONE || role == OPT_ROLE_LABEL)
+      return NULL;
+   if(role == OPT_ROLE_READ && opt_is_const(token))
+      return NULL;
+
+   return token->a.str;
+}
+
+/*
+ * Returns index of the operand written by the instruction or -1.
+ */
+static int opt_write_operand(int operation)
+{
+   for(int i = 0; i < OPT_OPERANDS; i++)
+   {
+      if(opt_role(operation, i) == OPT_ROLE_WRITE)
+         return i;
+   }
+
+   return -1;
+}
+
+/*
+ * Returns number of the temporary variable or -1, if the name does not
+ * belong to a temporary.
+ */
+static int opt_tmp_index(const char *name)
+{
+   int index = 0;
+
+   if(name == NULL || strncmp(name, OPT_TMP_PREFIX, strlen(OPT_TMP_PREFIX)))
+      return -1;
+
+   name += strlen(OPT_TMP_PREFIX);
+   if(*name == '\0')
+      return -1;
+
+   for(; *name != '\0'; name++)
+   {
+      if(*name < '0' || *name > '9' || index > (INT_MAX - 9) / 10)
+         return -1;
+      index = index * 10 + (*name - '0');
+   }
+
+   return index;
+}
+
+/*
+ * Returns usage counters of the temporary, array is enlarged when needed.
+ */
+static opt_uses_t *opt_uses(int index)
+{
+   if(index >= uses_size)
+   {
+      int new_size = (uses_size == 0) ? OPT_USES_INIT_SIZ : uses_size;
+
+      while(new_size <= index)
+         new_size *= 2;
+
+      opt_uses_t *new_uses = srealloc(uses, new_size * sizeof(opt_uses_t));
+      if(new_uses == NULL)
+         return NULL;
+
+      memset(new_uses + uses_size, 0,
+             (new_size - uses_size) * sizeof(opt_uses_t));
+      uses = new_uses;
+      uses_size = new_size;
+   }
+
+   return &(uses[index]);
+}
+
+/*
+ * Adds delta to usage counters of all temporaries used by the instruction.
+ */
+static int opt_count(code_t *code, int delta)
+{
+   for(int i = 0; i < OPT_OPERANDS; i++)
+   {
+      int index = opt_tmp_index(opt_var_name(code, i));
+      if(index < 0)
+         continue;
+
+      opt_uses_t *counters = opt_uses(index);
+      if(counters == NULL)
+         return OPT_FAILURE;
+
+      switch(opt_role(code->operation_type, i))
+      {
+         case OPT_ROLE_READ:
+            counters->reads += delta;
+            break;
+         case OPT_ROLE_WRITE:
+            counters->writes += delta;
+            break;
+         default:
+            counters->defs += delta;
+            break;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Counts usage of temporaries in the whole instruction list.
+ */
+static int opt_count_list(ilist_t *list)
+{
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      if(opt_count(ilist_at(i), 1))
+         return OPT_FAILURE;
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Returns usage counters of the temporary in the operand or NULL, if the
+ * operand is not a temporary.
+ */
+static opt_uses_t *opt_tmp_uses(code_t *code, int operand)
+{
+   int index = opt_tmp_index(opt_var_name(code, operand));
+
+   return (index < 0 || index >= uses_size) ? NULL : &(uses[index]);
+}
+
+/*
+ * Marks instruction as removed.
+ */
+static void opt_remove(int index)
+{
+   code_t *code = ilist_at(index);
+
+   opt_count(code, -1);
+   code->operation_type = NO_PRINT_ID;
+}
+
+/*
+ * Replaces instruction on the index by the new one and keeps usage counters
+ * up to date.
+ */
+static void opt_replace(int index, code_t *code)
+{
+   opt_count(ilist_at(index), -1);
+   *ilist_at(index) = *code;
+   opt_count(ilist_at(index), 1);
+}
+
+/*
+ * Returns index of the next instruction which is going to be printed.
+ */
+static int opt_next(int index)
+{
+   do
+   {
+      index = ilist_index_next(index);
+   } while(index != ILIST_NULL &&
+           ilist_at(index)->operation_type == NO_PRINT_ID);
+
+   return index;
+}
+
+/*
+ * Returns index of the next printed instruction other than DEFVAR.
+ */
+static int opt_next_skip_defvar(int index)
+{
+   do
+   {
+      index = opt_next(index);
+   } while(index != ILIST_NULL &&
+           ilist_at(index)->operation_type == DEFVAR_INS_ID);
+
+   return index;
+}
+
+/*
+ * PUSHS <symb>, POPS <var> -> MOVE <var> <symb>.  Pair is removed if the
+ * symbol is the variable itself.
+ */
+static bool opt_push_pop(int index, int *next)
+{
+   code_t *push = ilist_at(index);
+
+   if(push->operation_type != PUSHS_INS_ID)
+      return false;
+
+   int pop_index = opt_next(index);
+   if(pop_index == ILIST_NULL ||
+      ilist_at(pop_index)->operation_type != POPS_INS_ID)
+      return false;
+
+   code_t *pop = ilist_at(pop_index);
+   char *name = opt_var_name(push, 0);
+
+   if(name != NULL && !strcmp(name, pop->first_operand.a.str))
+   {
+      opt_remove(pop_index);
+      opt_remove(index);
+      *next = opt_next(pop_index);
+      return true;
+   }
+
+   code_t move = {0};
+   move.operation_type = MOVE_INS_ID;
+   move.first_operand = push->first_operand;
+   move.second_operand = pop->first_operand;
+
+   opt_replace(pop_index, &move);
+   opt_remove(index);
+   *next = pop_index;
+
+   return true;
+}
+
+/*
+ * JUMP <label> followed by LABEL <label> -> LABEL <label>.  There can be
+ * more labels right after the jump.
+ */
+static bool opt_jump_next(int index, int *next)
+{
+   code_t *jump = ilist_at(index);
+
+   if(jump->operation_type != JUMP_INS_ID)
+      return false;
+
+   for(int i = opt_next(index); i != ILIST_NULL &&
+       ilist_at(i)->operation_type == LABEL_INS_ID; i = opt_next(i))
+   {
+      if(!strcmp(ilist_at(i)->first_operand.a.str, jump->first_operand.a.str))
+      {
+         opt_remove(index);
+         *next = i;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/*
+ * <instr> <tmp> ..., MOVE <var> <tmp> -> <instr> <var> ..., where tmp is not
+ * used anywhere else.  Definitions between the instructions are skipped,
+ * the result is placed on the position of the MOVE.
+ */
+static bool opt_tmp_move(int index, int *next)
+{
+   code_t *code = ilist_at(index);
+   int operand = opt_write_operand(code->operation_type);
+
+   /* READ derives the input type from the operand, keep its variable.  */
+   if(operand < 0 || code->operation_type == READ_INS_ID)
+      return false;
+
+   opt_uses_t *counters = opt_tmp_uses(code, operand);
+   if(counters == NULL || counters->reads != 1 || counters->writes != 1)
+      return false;
+
+   int move_index = opt_next_skip_defvar(index);
+   if(move_index == ILIST_NULL)
+      return false;
+
+   code_t *move = ilist_at(move_index);
+   char *tmp_name = opt_operand(code, operand)->a.str;
+   char *src_name = opt_var_name(move, 0);
+
+   if(move->operation_type != MOVE_INS_ID || src_name == NULL ||
+      strcmp(src_name, tmp_name))
+      return false;
+
+   code_t result = *code;
+   *opt_operand(&result, operand) = move->second_operand;
+
+   opt_replace(move_index, &result);
+   opt_remove(index);
+   *next = move_index;
+
+   return true;
+}
+
+/*
+ * MOVE <tmp> int@c, INT2FLOAT <var> <tmp> -> MOVE <var> float@c, where tmp
+ * is not used anywhere else.
+ */
+static bool opt_int2float_const(int index, int *next)
+{
+   code_t *move = ilist_at(index);
+
+   if(move->operation_type != MOVE_INS_ID ||
+      move->first_operand.type != INTEGER_ID ||
+      !move->first_operand.is_const)
+      return false;
+
+   opt_uses_t *counters = opt_tmp_uses(move, 1);
+   if(counters == NULL || counters->reads != 1 || counters->writes != 1)
+      return false;
+
+   int conv_index = opt_next_skip_defvar(index);
+   if(conv_index == ILIST_NULL)
+      return false;
+
+   code_t *conv = ilist_at(conv_index);
+   if(conv->operation_type != INT2FLOAT_INS_ID ||
+      strcmp(conv->second_operand.a.str, move->second_operand.a.str))
+      return false;
+
+   code_t result = {0};
+   result.operation_type = MOVE_INS_ID;
+   result.first_operand.id = DOUBLE_LITERAL_ID;
+   result.first_operand.type = DOUBLE_ID;
+   result.first_operand.is_const = true;
+   result.first_operand.a.val_real = move->first_operand.a.val_int;
+   result.second_operand = conv->first_operand;
+
+   opt_replace(conv_index, &result);
+   opt_remove(index);
+   *next = conv_index;
+
+   return true;
+}
+
+/*
+ * Removes definitions of temporaries, which are neither read nor written.
+ */
+static void opt_dead_defvars(ilist_t *list, opt_stats_t *stats)
+{
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      if(code->operation_type != DEFVAR_INS_ID)
+         continue;
+
+      opt_uses_t *counters = opt_tmp_uses(code, 0);
+      if(counters != NULL && counters->reads == 0 && counters->writes == 0)
+      {
+         opt_remove(i);
+         stats->hits[OPT_RULE_DEAD_DEFVAR]++;
+      }
+   }
+}
+
+int opt_peephole(ilist_t *list, opt_stats_t *stats)
+{
+   opt_stats_t local_stats = {{0}, 0};
+   bool changed = true;
+
+   if(stats == NULL)
+      stats = &local_stats;
+
+   /* Usage of temporaries is needed before any rewrite.  */
+   if(opt_count_list(list) || opt_count_list(&global_var_ilist))
+   {
+      sfree(uses);
+      uses = NULL;
+      uses_size = 0;
+      return OPT_FAILURE;
+   }
+
+   for(int pass = 0; changed && pass < OPT_MAX_PASSES; pass++)
+   {
+      changed = false;
+      stats->passes++;
+
+      for(int i = list->first; i != ILIST_NULL; )
+      {
+         int next = ILIST_NULL;
+
+         /* Apply the first matching rule, continue with the rewritten code. */
+         if(opt_push_pop(i, &next))
+            stats->hits[OPT_RULE_PUSH_POP]++;
+         else if(opt_jump_next(i, &next))
+            stats->hits[OPT_RULE_JUMP_NEXT]++;
+         else if(opt_tmp_move(i, &next))
+            stats->hits[OPT_RULE_TMP_MOVE]++;
+         else if(opt_int2float_const(i, &next))
+            stats->hits[OPT_RULE_INT2FLOAT_CONST]++;
+         else
+         {
+            i = ilist_index_next(i);
+            continue;
+         }
+
+         changed = true;
+         i = next;
+      }
+   }
+
+   opt_dead_defvars(list, stats);
+
+   sfree(uses);
+   uses = NULL;
+   uses_size = 0;
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Returns the array with room for at least count + 1 items, the array is
+ * enlarged when needed.  NULL is returned on allocation error, the original
+ * array stays valid.
+ */
+static void *opt_reserve(void *array, int *size, int count, size_t item)
+{
+   if(count < *size)
+      return array;
+
+   int new_size = (*size == 0) ? OPT_ARRAY_INIT_SIZ : *size * 2;
+   void *new_array = srealloc(array, new_size * item);
+
+   if(new_array != NULL)
+      *size = new_size;
+
+   return new_array;
+}
+
+/*
+ * Returns index of the PUSHFRAME instruction if the instruction on the index
+ * starts a function, ILIST_NULL otherwise.  Function starts with its label or
+ * $$MAIN label followed by CREATEFRAME and PUSHFRAME.
+ */
+static int opt_function_frame(int index)
+{
+   code_t *code = ilist_at(index);
+   int next;
+
+   if(code->operation_type != LABEL_INS_ID &&
+      code->operation_type != LABEL_MAIN)
+      return ILIST_NULL;
+
+   next = opt_next(index);
+   if(code->operation_type == LABEL_MAIN && next != ILIST_NULL &&
+      ilist_at(next)->operation_type == CREATEFRAME_INS_ID)
+      next = opt_next(next);
+
+   if(next == ILIST_NULL || ilist_at(next)->operation_type != PUSHFRAME_INS_ID)
+      return ILIST_NULL;
+
+   return next;
+}
+
+/*
+ * Determines if the instruction jumps to the label in the first operand.
+ */
+static bool opt_is_jump(int operation)
+{
+   return operation == JUMP_INS_ID || operation == JUMPIFEQ_INS_ID ||
+          operation == JUMPIFNEQ_INS_ID || operation == JUMPIFEQS_INS_ID ||
+          operation == JUMPIFNEQS_INS_ID;
+}
+
+/*
+ * Assigns functions to all temporaries.  Temporaries used outside of
+ * functions or in more of them are excluded from the reuse.
+ */
+static int opt_assign_functions(ilist_t *list, int function)
+{
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      if(function >= 0 && opt_function_frame(i) != ILIST_NULL)
+         function++;
+
+      code_t *code = ilist_at(i);
+      if(code->operation_type == NO_PRINT_ID)
+         continue;
+
+      for(int j = 0; j < OPT_OPERANDS; j++)
+      {
+         int index = opt_tmp_index(opt_var_name(code, j));
+         if(index < 0)
+            continue;
+
+         opt_uses_t *counters = opt_uses(index);
+         if(counters == NULL)
+            return OPT_FAILURE;
+
+         if(function <= 0 || (counters->function != 0 &&
+                              counters->function != function))
+            counters->function = -1;
+         else
+            counters->function = function;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Records the use of the temporary on the position.  Range of temporary,
+ * which is not written first or which contains a label, can be entered by
+ * a jump.
+ */
+static int opt_use_temp(opt_function_t *func, code_t *code, int operand,
+                        int pos)
+{
+   int index = opt_tmp_index(opt_var_name(code, operand));
+   int role = opt_role(code->operation_type, operand);
+   opt_uses_t *counters = opt_tmp_uses(code, operand);
+
+   if(counters == NULL || counters->function <= 0 ||
+      (role != OPT_ROLE_READ && role != OPT_ROLE_WRITE))
+      return OPT_SUCCESS;
+
+   if(counters->first == 0)
+   {
+      opt_temp_t *temps = opt_reserve(func->temps, &func->temps_size,
+                                      func->temps_count, sizeof(opt_temp_t));
+      if(temps == NULL)
+         return OPT_FAILURE;
+
+      func->temps = temps;
+      func->temps[func->temps_count].index = index;
+      func->temps[func->temps_count].name = opt_operand(code, operand)->a.str;
+      func->temps_count++;
+
+      counters->first = pos;
+      counters->labels = func->labels_count;
+      counters->joined = (role != OPT_ROLE_WRITE);
+   }
+   else if(counters->labels != func->labels_count)
+      counters->joined = true;
+
+   counters->last = pos;
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Collects temporaries, labels and loops of the function.  Returns number
+ * of DEFVAR instructions in the function through defvars.
+ */
+static int opt_scan_function(opt_function_t *func, int begin, int end,
+                             int *defvars)
+{
+   int pos = 0;
+
+   for(int i = begin; i != end; i = opt_next(i))
+   {
+      code_t *code = ilist_at(i);
+      pos++;
+
+      if(code->operation_type == DEFVAR_INS_ID)
+         (*defvars)++;
+      else if(code->operation_type == LABEL_INS_ID)
+      {
+         opt_label_t *labels = opt_reserve(func->labels, &func->labels_size,
+                                           func->labels_count,
+                                           sizeof(opt_label_t));
+         if(labels == NULL)
+            return OPT_FAILURE;
+
+         func->labels = labels;
+         func->labels[func->labels_count].name = code->first_operand.a.str;
+         func->labels[func->labels_count].pos = pos;
+         func->labels_count++;
+      }
+      else if(opt_is_jump(code->operation_type))
+      {
+         /* Jump to a label already seen closes a loop.  */
+         for(int j = 0; j < func->labels_count; j++)
+         {
+            if(strcmp(func->labels[j].name, code->first_operand.a.str))
+               continue;
+
+            opt_loop_t *loops = opt_reserve(func->loops, &func->loops_size,
+                                            func->loops_count,
+                                            sizeof(opt_loop_t));
+            if(loops == NULL)
+               return OPT_FAILURE;
+
+            func->loops = loops;
+            func->loops[func->loops_count].begin = func->labels[j].pos;
+            func->loops[func->loops_count].end = pos;
+            func->loops_count++;
+            break;
+         }
+      }
+
+      for(int j = 0; j < OPT_OPERANDS; j++)
+      {
+         if(opt_use_temp(func, code, j, pos))
+            return OPT_FAILURE;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Extends live ranges, which can be entered by a jump, over all loops they
+ * overlap.  Value of such temporary can be carried to the next iteration.
+ */
+static void opt_extend_ranges(opt_function_t *func)
+{
+   for(int i = 0; i < func->temps_count; i++)
+   {
+      opt_uses_t *counters = &(uses[func->temps[i].index]);
+      bool changed = counters->joined;
+
+      /* Extended range can overlap an outer loop.  */
+      while(changed)
+      {
+         changed = false;
+
+         for(int j = 0; j < func->loops_count; j++)
+         {
+            opt_loop_t *loop = &(func->loops[j]);
+
+            if(counters->first > loop->end || counters->last < loop->begin ||
+               (counters->first <= loop->begin && counters->last >= loop->end))
+               continue;
+
+            if(loop->begin < counters->first)
+               counters->first = loop->begin;
+            if(loop->end > counters->last)
+               counters->last = loop->end;
+            changed = true;
+         }
+      }
+   }
+}
+
+/*
+ * Compares temporaries by the start of their live ranges.
+ */
+static int opt_temp_cmp(const void *a, const void *b)
+{
+   int first_a = uses[((const opt_temp_t *) a)->index].first;
+   int first_b = uses[((const opt_temp_t *) b)->index].first;
+
+   return (first_a > first_b) - (first_a < first_b);
+}
+
+/*
+ * Assigns slots to the temporaries in order of their live ranges, slot is
+ * reused when the range of its last user ended before.
+ */
+static int opt_assign_slots(opt_function_t *func)
+{
+   if(func->temps_count == 0)
+      return OPT_SUCCESS;
+
+   qsort(func->temps, func->temps_count, sizeof(opt_temp_t), opt_temp_cmp);
+
+   for(int i = 0; i < func->temps_count; i++)
+   {
+      opt_uses_t *counters = &(uses[func->temps[i].index]);
+      int slot = 0;
+
+      while(slot < func->slots_count &&
+            func->slots[slot].end >= counters->first)
+         slot++;
+
+      if(slot == func->slots_count)
+      {
+         opt_slot_t *slots = opt_reserve(func->slots, &func->slots_size,
+                                         func->slots_count,
+                                         sizeof(opt_slot_t));
+         if(slots == NULL)
+            return OPT_FAILURE;
+
+         func->slots = slots;
+         func->slots[slot].name = func->temps[i].name;
+         func->slots_count++;
+      }
+
+      func->slots[slot].end = counters->last;
+      counters->slot = slot;
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Renames temporaries of the function to their slots and moves their
+ * definitions right after PUSHFRAME of the function.
+ */
+static int opt_rename_temps(ilist_t *list, opt_function_t *func, int begin,
+                            int end, int frame)
+{
+   for(int i = begin; i != end; i = opt_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      for(int j = 0; j < OPT_OPERANDS; j++)
+      {
+         opt_uses_t *counters = opt_tmp_uses(code, j);
+         if(counters == NULL || counters->function <= 0)
+            continue;
+
+         if(code->operation_type == DEFVAR_INS_ID)
+            code->operation_type = NO_PRINT_ID;
+         else if(counters->first != 0)
+            opt_operand(code, j)->a.str = func->slots[counters->slot].name;
+      }
+   }
+
+   /* Definitions are inserted in reverse order after the PUSHFRAME.  */
+   ilist_set_active(list, frame);
+   for(int slot = func->slots_count - 1; slot >= 0; slot--)
+   {
+      code_t defvar = {0};
+      defvar.operation_type = DEFVAR_INS_ID;
+      defvar.first_operand.id = TMP_ID;
+      defvar.first_operand.a.str = func->slots[slot].name;
+
+      if(ilist_post_insert(list, &defvar) != ILIST_INSERT_SUCCESS)
+         return OPT_FAILURE;
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Reuses temporaries in the function from begin to end, PUSHFRAME of the
+ * function is on the index frame.
+ */
+static int opt_reuse_function(ilist_t *list, int begin, int end, int frame,
+                              FILE *report)
+{
+   opt_function_t func = {0};
+   int before = 0;
+   int status = OPT_FAILURE;
+
+   if(opt_scan_function(&func, begin, end, &before) == OPT_SUCCESS)
+   {
+      opt_extend_ranges(&func);
+
+      if(opt_assign_slots(&func) == OPT_SUCCESS &&
+         opt_rename_temps(list, &func, begin, end, frame) == OPT_SUCCESS)
+         status = OPT_SUCCESS;
+   }
+
+   if(status == OPT_SUCCESS && report != NULL)
+   {
+      int after = 0;
+
+      for(int i = begin; i != end; i = opt_next(i))
+      {
+         if(ilist_at(i)->operation_type == DEFVAR_INS_ID)
+            after++;
+      }
+
+      fprintf(report, "   %-24s %6d -> %d\n",
+              (ilist_at(begin)->operation_type == LABEL_MAIN) ?
+              "$$MAIN" : ilist_at(begin)->first_operand.a.str, before, after);
+   }
+
+   sfree(func.temps);
+   sfree(func.labels);
+   sfree(func.loops);
+   sfree(func.slots);
+
+   return status;
+}
+
+int opt_reuse_temps(ilist_t *list, FILE *report)
+{
+   int status = OPT_SUCCESS;
+
+   /* Temporaries of global variable definitions stay untouched.  */
+   if(opt_assign_functions(&global_var_ilist, -1) ||
+      opt_assign_functions(list, 0))
+      status = OPT_FAILURE;
+
+   if(status == OPT_SUCCESS && report != NULL)
+      fprintf(report, "Temporary reuse (DEFVAR count per function):\n");
+
+   int begin = list->first;
+   while(status == OPT_SUCCESS && begin != ILIST_NULL &&
+         opt_function_frame(begin) == ILIST_NULL)
+      begin = opt_next(begin);
+
+   while(status == OPT_SUCCESS && begin != ILIST_NULL)
+   {
+      int frame = opt_function_frame(begin);
+      int end = opt_next(begin);
+
+      while(end != ILIST_NULL && opt_function_frame(end) == ILIST_NULL)
+         end = opt_next(end);
+
+      status = opt_reuse_function(list, begin, end, frame, report);
+      begin = end;
+   }
+
+   sfree(uses);
+   uses = NULL;
+   uses_size = 0;
+
+   return status;
+}
+
+/*
+ * Compares candidates for inlining by names of the functions.
+ */
+static int opt_callee_cmp(const void *a, const void *b)
+{
+   return strcmp(((const opt_callee_t *) a)->name,
+                 ((const opt_callee_t *) b)->name);
+}
+
+/*
+ * Collects functions of the list with sizes of their bodies.  Function can
+ * be inlined if it does not call anything, so it cannot be recursive, and
+ * its frame is popped only right before RETURN.  The highest number of a
+ * temporary in the list is found too.
+ */
+static int opt_find_callees(ilist_t *list, opt_inline_t *inl)
+{
+   int callee = -1;
+
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+      int frame = opt_function_frame(i);
+
+      for(int j = 0; j < OPT_OPERANDS; j++)
+      {
+         int tmp = opt_tmp_index(opt_var_name(code, j));
+
+         if(tmp >= inl->next_tmp)
+            inl->next_tmp = tmp + 1;
+         if(callee >= 0 && tmp > inl->callees[callee].max_tmp)
+            inl->callees[callee].max_tmp = tmp;
+      }
+
+      if(code->operation_type == LABEL_MAIN || frame != ILIST_NULL)
+      {
+         if(callee >= 0)
+            inl->callees[callee].end = i;
+         callee = -1;
+      }
+
+      if(code->operation_type == LABEL_INS_ID && frame != ILIST_NULL)
+      {
+         opt_callee_t *callees = opt_reserve(inl->callees, &inl->callees_size,
+                                             inl->callees_count,
+                                             sizeof(opt_callee_t));
+         if(callees == NULL)
+            return OPT_FAILURE;
+
+         inl->callees = callees;
+         callee = inl->callees_count++;
+         inl->callees[callee] = (opt_callee_t)
+            {code->first_operand.a.str, i, frame, ILIST_NULL, 0, -1, true};
+         i = frame;
+         continue;
+      }
+
+      if(callee < 0)
+         continue;
+
+      switch(code->operation_type)
+      {
+         case NO_PRINT_ID:
+         case DEFVAR_INS_ID:
+         case RETURN_INS_ID:
+            break;
+         case CALL_INS_ID:
+         case CREATEFRAME_INS_ID:
+         case PUSHFRAME_INS_ID:
+            inl->callees[callee].inlinable = false;
+            break;
+         case POPFRAME_INS_ID:
+            if(opt_next(i) == ILIST_NULL ||
+               ilist_at(opt_next(i))->operation_type != RETURN_INS_ID)
+               inl->callees[callee].inlinable = false;
+            break;
+         default:
+            inl->callees[callee].size++;
+            break;
+      }
+   }
+
+   if(inl->callees_count > 0)
+      qsort(inl->callees, inl->callees_count, sizeof(opt_callee_t),
+            opt_callee_cmp);
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Returns new name of the variable or label for the inlined call.
+ * Temporaries get fresh numbers from tmp_base, variables of the temporary
+ * frame are moved to the local frame and other names get the number of the
+ * inlined call as a suffix.
+ */
+static char *opt_inline_name(opt_inline_t *inl, char *name, int tmp_base)
+{
+   int tmp = opt_tmp_index(name);
+   size_t size = strlen(name) + OPT_INLINE_SUFFIX_SIZ;
+   char *new_name = smalloc(size);
+
+   if(new_name == NULL)
+      return NULL;
+
+   if(tmp >= 0)
+      snprintf(new_name, size, "%s%d", OPT_TMP_PREFIX, tmp_base + tmp);
+   else if(!strncmp(name, "TF@", 3))
+      snprintf(new_name, size, "LF@%s$%d", name + 3, inl->instance);
+   else
+      snprintf(new_name, size, "%s$%d", name, inl->instance);
+
+   return new_name;
+}
+
+/*
+ * Renames operands of the instruction for the inlined call.  Labels and
+ * local variables are renamed in the body of the function, variables of
+ * the temporary frame at the call site.  Global variables are kept.
+ */
+static int opt_inline_code(opt_inline_t *inl, code_t *code, bool body,
+                           int tmp_base)
+{
+   for(int j = 0; j < OPT_OPERANDS; j++)
+   {
+      token_t *token = opt_operand(code, j);
+      char *name = (opt_role(code->operation_type, j) == OPT_ROLE_LABEL)
+                   ? token->a.str : opt_var_name(code, j);
+
+      if(name == NULL || !strncmp(name, "GF@", 3) ||
+         (body && !strncmp(name, "TF@", 3)) ||
+         (!body && strncmp(name, "TF@", 3)))
+         continue;
+
+      token->a.str = opt_inline_name(inl, name, tmp_base);
+      if(token->a.str == NULL)
+         return OPT_FAILURE;
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Determines if the instruction of the function is followed only by code
+ * which cannot be reached, as there is no label after it.
+ */
+static bool opt_is_last(opt_callee_t *callee, int index)
+{
+   for(int i = opt_next(index); i != callee->end && i != ILIST_NULL;
+       i = opt_next(i))
+   {
+      if(ilist_at(i)->operation_type == LABEL_INS_ID)
+         return false;
+   }
+
+   return true;
+}
+
+/*
+ * Replaces the CALL by a copy of the body of the function.  Frame of the
+ * function becomes a part of the local frame of the caller, its
+ * definitions are moved right after the PUSHFRAME of the caller, the same
+ * as arguments defined between CREATEFRAME and CALL.  RETURN jumps to the
+ * end of the copy, the result stays on the data stack for the POPS after
+ * the call.
+ */
+static int opt_expand_call(ilist_t *list, opt_inline_t *inl,
+                           opt_callee_t *callee, int create, int call,
+                           int frame)
+{
+   int tmp_base = inl->next_tmp;
+   bool reached = true;
+   bool jumped = false;
+   code_t end = *ilist_at(callee->label);
+
+   inl->instance++;
+   inl->next_tmp += callee->max_tmp + 1;
+   end.first_operand.a.str = opt_inline_name(inl, callee->name, tmp_base);
+   if(end.first_operand.a.str == NULL)
+      return OPT_FAILURE;
+
+   /* Arguments are moved from the temporary frame.  */
+   ilist_at(create)->operation_type = NO_PRINT_ID;
+   for(int i = ilist_index_next(create); i != call; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      if(opt_inline_code(inl, code, false, tmp_base))
+         return OPT_FAILURE;
+
+      if(code->operation_type == DEFVAR_INS_ID)
+      {
+         ilist_set_active(list, frame);
+         if(ilist_post_insert(list, code) != ILIST_INSERT_SUCCESS)
+            return OPT_FAILURE;
+         code->operation_type = NO_PRINT_ID;
+      }
+   }
+
+   for(int i = ilist_index_next(callee->frame); i != callee->end;
+       i = ilist_index_next(i))
+   {
+      code_t code = *ilist_at(i);
+
+      if(code.operation_type == LABEL_INS_ID)
+         reached = true;
+      if(!reached || code.operation_type == NO_PRINT_ID ||
+         code.operation_type == POPFRAME_INS_ID)
+         continue;
+
+      if(opt_inline_code(inl, &code, true, tmp_base))
+         return OPT_FAILURE;
+
+      if(code.operation_type == RETURN_INS_ID)
+      {
+         reached = false;
+         if(opt_is_last(callee, i))
+            continue;
+
+         code = end;
+         code.operation_type = JUMP_INS_ID;
+         jumped = true;
+      }
+
+      ilist_set_active(list, (code.operation_type == DEFVAR_INS_ID) ? frame
+                                                                   : call);
+      if(((code.operation_type == DEFVAR_INS_ID) ?
+          ilist_post_insert(list, &code) : ilist_pre_insert(list, &code))
+         != ILIST_INSERT_SUCCESS)
+         return OPT_FAILURE;
+   }
+
+   ilist_set_active(list, call);
+   if(jumped && ilist_pre_insert(list, &end) != ILIST_INSERT_SUCCESS)
+      return OPT_FAILURE;
+
+   ilist_at(call)->operation_type = NO_PRINT_ID;
+
+   return OPT_SUCCESS;
+}
+
+int opt_inline(ilist_t *list, int max_size, FILE *report)
+{
+   opt_inline_t inl = {0};
+   int frame = ILIST_NULL;
+   int create = ILIST_NULL;
+   int status = OPT_SUCCESS;
+
+   if(max_size > 0 && opt_find_callees(list, &inl))
+      status = OPT_FAILURE;
+
+   for(int i = list->first; status == OPT_SUCCESS && i != ILIST_NULL &&
+       inl.callees_count > 0; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      if(opt_function_frame(i) != ILIST_NULL)
+         frame = opt_function_frame(i);
+
+      switch(code->operation_type)
+      {
+         case CREATEFRAME_INS_ID:
+            create = i;
+            break;
+         case PUSHFRAME_INS_ID:
+         case POPFRAME_INS_ID:
+            create = ILIST_NULL;
+            break;
+         case CALL_INS_ID:
+         {
+            opt_callee_t key = {code->first_operand.a.str, 0, 0, 0, 0, 0,
+                                false};
+            opt_callee_t *callee = bsearch(&key, inl.callees,
+                                           inl.callees_count,
+                                           sizeof(opt_callee_t),
+                                           opt_callee_cmp);
+
+            if(callee != NULL && callee->inlinable &&
+               callee->size <= max_size && create != ILIST_NULL &&
+               frame != ILIST_NULL)
+               status = opt_expand_call(list, &inl, callee, create, i, frame);
+
+            create = ILIST_NULL;
+            break;
+         }
+         default:
+            break;
+      }
+   }
+
+   if(report != NULL)
+   {
+      fprintf(report, "Function inlining (max size %d):\n", max_size);
+      fprintf(report, "   %-16s %d\n", "inlined", inl.instance);
+   }
+
+   sfree(inl.callees);
+
+   return status;
+}
+
+/*
+ * Compares labels by their names.
+ */
+static int opt_label_cmp(const void *a, const void *b)
+{
+   return strcmp(((const opt_label_t *) a)->name,
+                 ((const opt_label_t *) b)->name);
+}
+
+/*
+ * Returns index of the label instruction or ILIST_NULL, if there is no such
+ * label.
+ */
+static int opt_find_label(opt_dead_t *dead, char *name)
+{
+   opt_label_t key = {name, 0};
+   opt_label_t *label = bsearch(&key, dead->labels, dead->labels_count,
+                                sizeof(opt_label_t), opt_label_cmp);
+
+   return (label == NULL) ? ILIST_NULL : label->pos;
+}
+
+/*
+ * Adds instruction to the instructions to be visited.
+ */
+static int opt_visit(opt_dead_t *dead, int index)
+{
+   int *work = opt_reserve(dead->work, &dead->work_size, dead->work_count,
+                           sizeof(int));
+   if(work == NULL)
+      return OPT_FAILURE;
+
+   dead->work = work;
+   dead->work[dead->work_count++] = index;
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Marks instructions reachable from $$MAIN.  Instructions are followed until
+ * unconditional JUMP or RETURN, targets of jumps and calls are visited
+ * later.  Returns OPT_FAILURE also when a target label does not exist, the
+ * code is kept untouched then.
+ */
+static int opt_mark_reached(ilist_t *list, opt_dead_t *dead)
+{
+   int max_index = ILIST_NULL;
+   int main_index = ILIST_NULL;
+
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      if(i > max_index)
+         max_index = i;
+
+      if(code->operation_type == LABEL_MAIN)
+         main_index = i;
+      else if(code->operation_type == LABEL_INS_ID)
+      {
+         opt_label_t *labels = opt_reserve(dead->labels, &dead->labels_size,
+                                           dead->labels_count,
+                                           sizeof(opt_label_t));
+         if(labels == NULL)
+            return OPT_FAILURE;
+
+         dead->labels = labels;
+         dead->labels[dead->labels_count].name = code->first_operand.a.str;
+         dead->labels[dead->labels_count].pos = i;
+         dead->labels_count++;
+      }
+   }
+
+   if(main_index == ILIST_NULL)
+      return OPT_FAILURE;
+
+   if(dead->labels_count > 0)
+      qsort(dead->labels, dead->labels_count, sizeof(opt_label_t),
+            opt_label_cmp);
+
+   dead->reached = smalloc((max_index + 1) * sizeof(bool));
+   if(dead->reached == NULL || opt_visit(dead, main_index))
+      return OPT_FAILURE;
+   memset(dead->reached, 0, (max_index + 1) * sizeof(bool));
+
+   while(dead->work_count > 0)
+   {
+      int i = dead->work[--dead->work_count];
+
+      for(; i != ILIST_NULL && !dead->reached[i]; i = opt_next(i))
+      {
+         code_t *code = ilist_at(i);
+         int operation = code->operation_type;
+
+         dead->reached[i] = true;
+
+         if(operation == CALL_INS_ID || opt_is_jump(operation))
+         {
+            int target = opt_find_label(dead, code->first_operand.a.str);
+            if(target == ILIST_NULL || opt_visit(dead, target))
+               return OPT_FAILURE;
+         }
+
+         if(operation == JUMP_INS_ID || operation == RETURN_INS_ID)
+            break;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Removes instructions which were not reached, removed functions are
+ * reported.
+ */
+static void opt_remove_unreached(ilist_t *list, opt_dead_t *dead,
+                                 opt_dead_stats_t *stats, FILE *report)
+{
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      if(code->operation_type == NO_PRINT_ID || dead->reached[i])
+         continue;
+
+      if(opt_function_frame(i) != ILIST_NULL)
+      {
+         stats->functions++;
+         if(report != NULL)
+            fprintf(report, "   removed function %s\n",
+                    code->first_operand.a.str);
+      }
+
+      code->operation_type = NO_PRINT_ID;
+      stats->unreached++;
+   }
+}
+
+/*
+ * Determines if the instruction has no other effect than writing its
+ * result.  Instructions which can end with a runtime error or which work
+ * with the input or the data stack are not pure.
+ */
+static bool opt_is_pure(int operation)
+{
+   switch(operation)
+   {
+      case MOVE_INS_ID:
+      case ADD_INS_ID:
+      case SUB_INS_ID:
+      case MUL_INS_ID:
+      case EQ_INS_ID:
+      case LT_INS_ID:
+      case GT_INS_ID:
+      case OR_INS_ID:
+      case NOT_INS_ID:
+      case CONCAT_INS_ID:
+      case STRLEN_INS_ID:
+      case INT2FLOAT_INS_ID:
+      case FLOAT2R2EINT_INS_ID:
+         return true;
+      default:
+         return false;
+   }
+}
+
+/*
+ * Collects uses of variables in the instruction list.
+ */
+static int opt_collect_refs(ilist_t *list, opt_ref_t **refs, int *count,
+                            int *size, bool global)
+{
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      for(int j = 0; j < OPT_OPERANDS; j++)
+      {
+         char *name = opt_var_name(code, j);
+         if(name == NULL)
+            continue;
+
+         opt_ref_t *new_refs = opt_reserve(*refs, size, *count,
+                                           sizeof(opt_ref_t));
+         if(new_refs == NULL)
+            return OPT_FAILURE;
+
+         *refs = new_refs;
+         (*refs)[*count].name = name;
+         (*refs)[*count].index = i;
+         (*refs)[*count].role = opt_role(code->operation_type, j);
+         (*refs)[*count].global = global;
+         (*count)++;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Compares uses of variables by the names of the variables.
+ */
+static int opt_ref_cmp(const void *a, const void *b)
+{
+   return strcmp(((const opt_ref_t *) a)->name,
+                 ((const opt_ref_t *) b)->name);
+}
+
+/*
+ * Removes definitions of variables which are never read, together with
+ * pure instructions writing to them.  Arguments in the temporary frame are
+ * read through the local frame of the callee, they are kept.  Returns
+ * number of removed definitions through removed.
+ */
+static int opt_remove_unread(ilist_t *list, opt_dead_t *dead,
+                             opt_dead_stats_t *stats, int *removed)
+{
+   *removed = 0;
+   dead->refs_count = 0;
+
+   if(opt_collect_refs(list, &dead->refs, &dead->refs_count,
+                       &dead->refs_size, false) ||
+      opt_collect_refs(&global_var_ilist, &dead->refs, &dead->refs_count,
+                       &dead->refs_size, true))
+      return OPT_FAILURE;
+
+   if(dead->refs_count > 0)
+      qsort(dead->refs, dead->refs_count, sizeof(opt_ref_t), opt_ref_cmp);
+
+   for(int begin = 0, end; begin < dead->refs_count; begin = end)
+   {
+      bool removable = strncmp(dead->refs[begin].name, "TF@", 3) != 0;
+      bool defined = false;
+
+      for(end = begin; end < dead->refs_count &&
+          !strcmp(dead->refs[end].name, dead->refs[begin].name); end++)
+      {
+         opt_ref_t *ref = &(dead->refs[end]);
+
+         if(ref->role == OPT_ROLE_DEFINE)
+            defined = true;
+         else if(ref->role == OPT_ROLE_READ || ref->global ||
+                 !opt_is_pure(ilist_at(ref->index)->operation_type))
+            removable = false;
+      }
+
+      if(!removable || !defined)
+         continue;
+
+      for(int i = begin; i < end; i++)
+      {
+         code_t *code = ilist_at(dead->refs[i].index);
+
+         if(dead->refs[i].role == OPT_ROLE_DEFINE)
+         {
+            stats->defvars++;
+            (*removed)++;
+         }
+         else
+            stats->writes++;
+
+         code->operation_type = NO_PRINT_ID;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+int opt_dead_code(ilist_t *list, FILE *report)
+{
+   opt_dead_t dead = {0};
+   opt_dead_stats_t stats = {0, 0, 0, 0};
+   int status = OPT_SUCCESS;
+
+   if(report != NULL)
+      fprintf(report, "Dead code elimination:\n");
+
+   /* Unknown jump target leaves all the code in place.  */
+   if(opt_mark_reached(list, &dead) == OPT_SUCCESS)
+      opt_remove_unreached(list, &dead, &stats, report);
+
+   /* Removed writes can make other variables unread.  */
+   for(int pass = 0, removed = 1; removed > 0 && pass < OPT_MAX_PASSES;
+       pass++)
+   {
+      if(opt_remove_unread(list, &dead, &stats, &removed))
+      {
+         status = OPT_FAILURE;
+         break;
+      }
+   }
+
+   if(report != NULL)
+   {
+      fprintf(report, "   %-16s %lu\n", "functions", stats.functions);
+      fprintf(report, "   %-16s %lu\n", "unreachable", stats.unreached);
+      fprintf(report, "   %-16s %lu\n", "unread-defvar", stats.defvars);
+      fprintf(report, "   %-16s %lu\n", "unread-write", stats.writes);
+   }
+
+   sfree(dead.labels);
+   sfree(dead.work);
+   sfree(dead.reached);
+   sfree(dead.refs);
+
+   return status;
+}
+
+/*
+ * Compares variables by their names.
+ */
+static int opt_var_cmp(const void *a, const void *b)
+{
+   return strcmp(((const opt_var_t *) a)->name,
+                 ((const opt_var_t *) b)->name);
+}
+
+/*
+ * Returns the variable with the name.  All the variables used in the list
+ * are collected, so the name is always found.
+ */
+static opt_var_t *opt_find_var(opt_licm_t *licm, char *name)
+{
+   opt_var_t key = {name, 0, 0, 0, 0, 0, 0};
+
+   return bsearch(&key, licm->vars, licm->vars_count, sizeof(opt_var_t),
+                  opt_var_cmp);
+}
+
+/*
+ * Numbers instructions of the list by their position and collects
+ * variables with the number of writes and the range of their reads.
+ * Instructions of global_var_ilist get position -1, before any loop.
+ */
+static int opt_collect_vars(ilist_t *list, opt_licm_t *licm)
+{
+   int max_index = 0;
+   int position = 0;
+
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+      max_index = (i > max_index) ? i : max_index;
+   for(int i = global_var_ilist.first; i != ILIST_NULL;
+       i = ilist_index_next(i))
+      max_index = (i > max_index) ? i : max_index;
+
+   licm->pos = smalloc((max_index + 1) * sizeof(int));
+   if(licm->pos == NULL)
+      return OPT_FAILURE;
+
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+      licm->pos[i] = position++;
+   for(int i = global_var_ilist.first; i != ILIST_NULL;
+       i = ilist_index_next(i))
+      licm->pos[i] = -1;
+
+   if(opt_collect_refs(list, &licm->refs, &licm->refs_count,
+                       &licm->refs_size, false) ||
+      opt_collect_refs(&global_var_ilist, &licm->refs, &licm->refs_count,
+                       &licm->refs_size, true))
+      return OPT_FAILURE;
+
+   if(licm->refs_count > 0)
+      qsort(licm->refs, licm->refs_count, sizeof(opt_ref_t), opt_ref_cmp);
+
+   for(int begin = 0, end; begin < licm->refs_count; begin = end)
+   {
+      opt_var_t var = {licm->refs[begin].name, 0, INT_MAX, INT_MIN, -1, 0,
+                       -1};
+
+      for(end = begin; end < licm->refs_count &&
+          !strcmp(licm->refs[end].name, var.name); end++)
+      {
+         opt_ref_t *ref = &(licm->refs[end]);
+         int ref_pos = licm->pos[ref->index];
+
+         if(ref->role == OPT_ROLE_WRITE)
+            var.writes++;
+         else if(ref->role == OPT_ROLE_READ)
+         {
+            var.first_read = (ref_pos < var.first_read) ? ref_pos
+                                                        : var.first_read;
+            var.last_read = (ref_pos > var.last_read) ? ref_pos
+                                                      : var.last_read;
+         }
+      }
+
+      opt_var_t *vars = opt_reserve(licm->vars, &licm->vars_size,
+                                    licm->vars_count, sizeof(opt_var_t));
+      if(vars == NULL)
+         return OPT_FAILURE;
+
+      licm->vars = vars;
+      licm->vars[licm->vars_count++] = var;
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Finds loops by their LOOP_BEGIN_ID and LOOP_END_ID labels.  Loop is
+ * added when its end label is found, so inner loops go first.
+ */
+static int opt_find_loops(ilist_t *list, opt_licm_t *licm)
+{
+   for(int i = list->first; i != ILIST_NULL; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+
+      if(code->operation_type != LABEL_INS_ID)
+         continue;
+
+      if(code->first_operand.id == LOOP_BEGIN_ID)
+      {
+         int *open = opt_reserve(licm->open, &licm->open_size,
+                                 licm->open_count, sizeof(int));
+         if(open == NULL)
+            return OPT_FAILURE;
+
+         licm->open = open;
+         licm->open[licm->open_count++] = i;
+      }
+      else if(code->first_operand.id == LOOP_END_ID &&
+              licm->open_count > 0 &&
+              ilist_at(licm->open[licm->open_count - 1])->first_operand.type ==
+              code->first_operand.type)
+      {
+         opt_loop_t *loops = opt_reserve(licm->loops, &licm->loops_size,
+                                         licm->loops_count,
+                                         sizeof(opt_loop_t));
+         if(loops == NULL)
+            return OPT_FAILURE;
+
+         licm->loops = loops;
+         licm->loops[licm->loops_count].begin =
+            licm->open[--licm->open_count];
+         licm->loops[licm->loops_count].end = i;
+         licm->loops_count++;
+      }
+   }
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Determines if the instruction computes the same value in every iteration
+ * of the loop and can be executed before it.  It must be pure, its result
+ * must be the only write to a local variable read only inside of the loop
+ * and none of its operands can be written in the loop.  The result cannot
+ * be read in the loop before the instruction, such read sees the value
+ * from the loop entry (a parameter) or from the previous iteration.
+ * Variables outside of the local frame can be changed by called functions.
+ */
+static bool opt_is_invariant(opt_licm_t *licm, code_t *code, int loop,
+                             bool calls)
+{
+   int begin = licm->pos[licm->loops[loop].begin];
+   int end = licm->pos[licm->loops[loop].end];
+   int write = opt_write_operand(code->operation_type);
+
+   if(!opt_is_pure(code->operation_type) || write < 0)
+      return false;
+
+   opt_var_t *result = opt_find_var(licm, opt_var_name(code, write));
+   if(strncmp(result->name, "LF@", 3) || result->writes != 1 ||
+      result->first_read <= begin || result->last_read >= end ||
+      result->read_loop == loop)
+      return false;
+
+   for(int i = 0; i < OPT_OPERANDS; i++)
+   {
+      char *name = opt_var_name(code, i);
+      if(name == NULL || i == write)
+         continue;
+
+      opt_var_t *var = opt_find_var(licm, name);
+      if((var->loop == loop && var->loop_writes > 0) ||
+         !strncmp(name, "TF@", 3) || (calls && strncmp(name, "LF@", 3)))
+         return false;
+   }
+
+   return true;
+}
+
+/*
+ * Returns position of the name in the array of names, -1 if it is not
+ * there.
+ */
+static int opt_find_name(char **names, int count, const char *name)
+{
+   for(int i = 0; i < count; i++)
+   {
+      if(!strcmp(names[i], name))
+         return i;
+   }
+
+   return -1;
+}
+
+/*
+ * Adds the name to the array of names.
+ */
+static int opt_add_name(char ***names, int *count, int *size, char *name)
+{
+   char **new_names = opt_reserve(*names, size, *count, sizeof(char *));
+   if(new_names == NULL)
+      return OPT_FAILURE;
+
+   *names = new_names;
+   (*names)[(*count)++] = name;
+
+   return OPT_SUCCESS;
+}
+
+/*
+ * Follows jumps and labels of the loop.  Instructions passed while a
+ * forward jump waits for its label can be skipped in an iteration, their
+ * results cannot be moved.  Jumps out of the loop and back to passed labels
+ * do not skip anything later in the iteration.
+ */
+static int opt_follow_jumps(opt_licm_t *licm, code_t *code, int end)
+{
+   char *name = code->first_operand.a.str;
+
+   if(code->operation_type == LABEL_INS_ID)
+   {
+      int pending = opt_find_name(licm->pending, licm->pending_count, name);
+      if(pending >= 0)
+         licm->pending[pending] = licm->pending[--licm->pending_count];
+
+      return opt_add_name(&licm->passed, &licm->passed_count,
+                          &licm->passed_size, name);
+   }
+
+   if(!opt_is_jump(code->operation_type) ||
+      !strcmp(name, ilist_at(end)->first_operand.a.str) ||
+      opt_find_name(licm->passed, licm->passed_count, name) >= 0 ||
+      opt_find_name(licm->pending, licm->pending_count, name) >= 0)
+      return OPT_SUCCESS;
+
+   return opt_add_name(&licm->pending, &licm->pending_count,
+                       &licm->pending_size, name);
+}
+
+/*
+ * Moves invariant instructions of the loop in front of its begin label.
+ * Only instructions executed in every iteration are moved, so they are
+ * executed before all the reads of their results which follow them.
+ * Removed instructions are kept as NO_PRINT_ID, moved ones are counted
+ * through hoisted.
+ */
+static int opt_hoist_loop(ilist_t *list, opt_licm_t *licm, int loop,
+                          unsigned long *hoisted)
+{
+   int begin = licm->loops[loop].begin;
+   int end = licm->loops[loop].end;
+   bool calls = false;
+
+   /* Writes in the loop make the variables variant.  */
+   for(int i = begin; i != end; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+      int write = opt_write_operand(code->operation_type);
+
+      if(code->operation_type == CALL_INS_ID)
+         calls = true;
+      if(write < 0)
+         continue;
+
+      opt_var_t *var = opt_find_var(licm, opt_var_name(code, write));
+      if(var->loop != loop)
+      {
+         var->loop = loop;
+         var->loop_writes = 0;
+      }
+      var->loop_writes++;
+   }
+
+   /* Instructions are moved in their order, which keeps dependencies.  */
+   ilist_set_active(list, begin);
+   licm->passed_count = 0;
+   licm->pending_count = 0;
+   if(opt_follow_jumps(licm, ilist_at(begin), end) != OPT_SUCCESS)
+      return OPT_FAILURE;
+
+   for(int i = ilist_index_next(begin); i != end; i = ilist_index_next(i))
+   {
+      code_t *code = ilist_at(i);
+      int operation = code->operation_type;
+
+      if(opt_follow_jumps(licm, code, end) != OPT_SUCCESS)
+         return OPT_FAILURE;
+
+      if(licm->pending_count > 0 ||
+         !opt_is_invariant(licm, code, loop, calls))
+      {
+         /* Results read here cannot be moved in front of the loop.  */
+         for(int j = 0; j < OPT_OPERANDS; j++)
+         {
+            char *name = opt_var_name(code, j);
+
+            if(name != NULL && opt_role(operation, j) == OPT_ROLE_READ)
+               opt_find_var(licm, name)->read_loop = loop;
+         }
+         continue;
+      }
+
+      if(ilist_pre_insert(list, code) != ILIST_INSERT_SUCCESS)
+         return OPT_FAILURE;
+
+      opt_find_var(licm, opt_var_name(code,
+                   opt_write_operand(code->operation_type)))->loop_writes--;
+      code->operation_type = NO_PRINT_ID;
+      (*hoisted)++;
+   }
+
+   return OPT_SUCCESS;
+}
+
+int opt_hoist_invariants(ilist_t *list, FILE *report)
+{
+   opt_licm_t licm = {0};
+   unsigned long hoisted = 0;
+   int status = OPT_SUCCESS;
+
+   if(opt_collect_vars(list, &licm) || opt_find_loops(list, &licm))
+      status = OPT_FAILURE;
+
+   for(int i = 0; status == OPT_SUCCESS && i < licm.loops_count; i++)
+      status = opt_hoist_loop(list, &licm, i, &hoisted);
+
+   if(report != NULL)
+   {
+      fprintf(report, "Loop-invariant code motion:\n");
+      fprintf(report, "   %-16s %d\n", "loops", licm.loops_count);
+      fprintf(report, "   %-16s %lu\n", "hoisted", hoisted);
+   }
+
+   sfree(licm.pos);
+   sfree(licm.refs);
+   sfree(licm.vars);
+   sfree(licm.loops);
+   sfree(licm.open);
+   sfree(licm.passed);
+   sfree(licm.pending);
+
+   return status;
+}
+
+void opt_print_stats(FILE *stream, opt_stats_t *stats)
+{
+   unsigned long total = 0;
+
+   fprintf(stream, "Peephole optimizer (%lu passes):\n", stats->passes);
+
+   for(int i = 0; i < OPT_RULE_COUNT; i++)
+   {
+      fprintf(stream, "   %-16s %lu\n", rule_names[i], stats->hits[i]);
+      total += stats->hits[i];
+   }
+
+   fprintf(stream, "   %-16s %lu\n", "total", total);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file optimizer.h
+ * @brief Optimizer of generated code for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module optimizes generated IFJcode17 instruction list before it is
+ * printed.  Small functions are inlined at their call sites.  Dead code
+ * elimination removes unreachable code and unread variables.  Peephole
+ * optimizer rewrites short redundant sequences of instructions produced by
+ * the generator.  Removed instructions are not unlinked from the list, they
+ * are marked by NO_PRINT_ID the same way as hoisted definitions in
+ * order_ilist().  Invariant computations are moved out of loops.
+ * Temporaries with disjoint live ranges are renamed to share a single
+ * variable of the function frame.  Reports of the passes are printed only
+ * to the stream given by the caller, main.c passes stderr for option -r.
+ */
+
+#ifndef OPTIMIZER_H_INCLUDED
+#define OPTIMIZER_H_INCLUDED
+
+#include "ifj17_api.h"
+#include <stdio.h>
+
+/** @brief Optimizer success identifier.  */
+#define OPT_SUCCESS 0
+
+/** @brief Optimizer failure identifier.  */
+#define OPT_FAILURE 1
+
+/** @brief PUSHS <symb> followed by POPS <var> becomes MOVE <var> <symb>. */
+#define OPT_RULE_PUSH_POP 0
+
+/** @brief JUMP to the label right after the jump is removed.  */
+#define OPT_RULE_JUMP_NEXT 1
+
+/** @brief Result stored to a temporary only to be moved on is stored
+ *         directly to the target of the MOVE.  */
+#define OPT_RULE_TMP_MOVE 2
+
+/** @brief INT2FLOAT of a temporary holding integer constant becomes MOVE
+ *         of a float constant.  */
+#define OPT_RULE_INT2FLOAT_CONST 3
+
+/** @brief DEFVAR of a temporary which is not used anymore is removed.  */
+#define OPT_RULE_DEAD_DEFVAR 4
+
+/** @brief Number of peephole rules.  */
+#define OPT_RULE_COUNT 5
+
+/** @brief Maximal number of peephole passes over the instruction list.  */
+#define OPT_MAX_PASSES 8
+
+/** @brief Default maximal size of inlined function bodies.  */
+#define OPT_INLINE_SIZE 16
+
+/** @brief Operand of the instruction is not used.  */
+#define OPT_ROLE_NONE 0
+
+/** @brief Operand is read, variable or constant.  */
+#define OPT_ROLE_READ 1
+
+/** @brief Operand is a variable written to.  */
+#define OPT_ROLE_WRITE 2
+
+/** @brief Operand is a label.  */
+#define OPT_ROLE_LABEL 3
+
+/** @brief Operand is a variable being defined.  */
+#define OPT_ROLE_DEFINE 4
+
+/** @brief Statistics of the optimizer.  */
+typedef struct opt_stats
+{
+   unsigned long hits[OPT_RULE_COUNT];     ///< Number of hits of every rule.
+   unsigned long passes;                   ///< Number of peephole passes.
+} opt_stats_t;
+
+/** @brief Statistics of the dead code elimination.  */
+typedef struct opt_dead_stats
+{
+   unsigned long functions;      ///< Number of removed functions.
+   unsigned long unreached;      ///< Number of unreachable instructions.
+   unsigned long defvars;        ///< Number of definitions of unread variables.
+   unsigned long writes;         ///< Number of writes to unread variables.
+} opt_dead_stats_t;
+
+/**
+ * @brief Returns the role of the operand of the instruction.  Roles follow
+ *        the order in which instruction_print() prints the operands.
+ *
+ * @param operation Operation type of the instruction.
+ * @param operand Index of the operand, 0 - first, 1 - second, 2 - third.
+ * @return One of OPT_ROLE_ identifiers.
+ */
+int opt_role(int operation, int operand);
+
+/**
+ * @brief Runs peephole optimizer over the instruction list.  Rules are
+ *        applied until the list does not change or the OPT_MAX_PASSES limit
+ *        is reached.
+ *
+ * @param *list Instruction list to be optimized.
+ * @param *stats Statistics to be updated, can be NULL.
+ * @return OPT_SUCCESS if the optimization was done, OPT_FAILURE if it could
+ *         not be done due to allocation error.  List stays valid anyway.
+ */
+int opt_peephole(ilist_t *list, opt_stats_t *stats);
+
+/**
+ * @brief Inlines small functions.  Call of a function, which calls nothing
+ *        and has at most max_size instructions apart from definitions, is
+ *        replaced by a copy of its body.  Arguments and variables of the
+ *        function are renamed into the local frame of the caller and defined
+ *        right after its PUSHFRAME.  Functions which are not called anymore
+ *        are left for opt_dead_code().
+ *
+ * @param *list Instruction list to be optimized.
+ * @param max_size Maximal size of inlined bodies, 0 disables the inlining.
+ * @param *report Stream for the number of inlined calls, can be NULL.
+ * @return OPT_SUCCESS if the inlining was done, OPT_FAILURE on allocation
+ *         error.
+ */
+int opt_inline(ilist_t *list, int max_size, FILE *report);
+
+/**
+ * @brief Removes dead code.  Instructions not reachable from $$MAIN through
+ *        jumps and calls are removed, including whole functions which are
+ *        never called.  Then definitions of variables which are never read
+ *        are removed together with instructions writing to them, as long as
+ *        the instructions have no other effect.
+ *
+ * @param *list Instruction list to be optimized.
+ * @param *report Stream for the summary of removed code, can be NULL.
+ * @return OPT_SUCCESS if the elimination was done, OPT_FAILURE on
+ *         allocation error.
+ */
+int opt_dead_code(ilist_t *list, FILE *report);
+
+/**
+ * @brief Moves loop-invariant code in front of loops.  Loops are found by
+ *        their LOOP_BEGIN_ID and LOOP_END_ID labels, inner loops are
+ *        processed first, so the code can move out of the whole nest.  Pure
+ *        instruction is moved if none of its operands is written in the loop
+ *        and its result is written only by it and read only in the loop.
+ *
+ * @param *list Instruction list to be optimized.
+ * @param *report Stream for the number of moved instructions, can be NULL.
+ * @return OPT_SUCCESS if the code motion was done, OPT_FAILURE on
+ *         allocation error.
+ */
+int opt_hoist_invariants(ilist_t *list, FILE *report);
+
+/**
+ * @brief Reuses temporaries within functions.  Live range of every temporary
+ *        is computed from its uses, ranges which can be entered by a jump are
+ *        extended over the loops they overlap.  Temporaries with disjoint
+ *        ranges are renamed to the same variable, which is defined once right
+ *        after PUSHFRAME of the function.
+ *
+ * @param *list Instruction list to be optimized.
+ * @param *report Stream for DEFVAR counts of functions before and after the
+ *        reuse, can be NULL.
+ * @return OPT_SUCCESS if the reuse was done, OPT_FAILURE on allocation
+ *         error.
+ */
+int opt_reuse_temps(ilist_t *list, FILE *report);
+
+/**
+ * @brief Prints rule hit counts of the optimizer.
+ *
+ * @param *stream Output stream.
+ * @param *stats Statistics to be printed.
+ * @return void.
+ */
+void opt_print_stats(FILE *stream, opt_stats_t *stats);
+
+#endif
@@ -53,7 +53,7 @@ bool cycle_type_list();
 bool cycle_type();
 bool empty_statement();
 
-void pop_block_vars(symtab_t *table, int depth);
+void pop_block_vars(symtab_t *table, stab_mark_t mark);
 bool all_functions_defined(symtab_t *table);
 
 /* Global variables/Global variables struct? */
@@ -74,6 +74,15 @@ bool parse()
    return program();
 }
 
+void parser_reinit()
+{
+   current_function_name = NULL;
+   block_depth = 0;
+   context = 0;
+   cycle_depth = 0;
+   code_structure = 0;
+}
+
 /*    Functions definitions section  */
 /**
  * Possible rules:
@@ -119,6 +128,7 @@ bool program()
       }
 
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       GET_TOKEN(token);
 
@@ -126,7 +136,7 @@ bool program()
 
       /* At the end of a scope block, variables declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
       
       block_depth--;
 
@@ -414,6 +424,9 @@ bool func_def()
       /* <func_def> -> Function id ( <param_list> ) As <type> EOL <stat_list> 
          End Function EOL simulation */
 
+      /* Function is read ahead and looked up in the function cache */
+      fcache_function_start();
+
       GET_TOKEN(token);
       if(token.id != ID_ID)
       {
@@ -657,6 +670,9 @@ bool func_def()
       code_structure = CODE_STRUCTURE_LINEAR;
       block_depth++;
 
+      /* Cached body is spliced, the statement list is empty then */
+      fcache_function_body();
+
       if(!stat_list()) HANDLE_ERROR(SYNT_ERR, success);
 
       block_depth--;
@@ -676,6 +692,8 @@ bool func_def()
          HANDLE_ERROR(SYNT_ERR, success);
       }
 
+      fcache_function_end();
+
       GET_TOKEN(token);
       if(token.id != EOL_ID)
       {
@@ -1001,6 +1019,14 @@ bool var_decl()
       vdstack_push(&(symbol_to_use->s.var_stack), &var);
    }
 
+   /* Local variables are removed again at the end of their block */
+   if(context != CONTEXT_DECL_LIST && 
+      stab_scope_log(&local_table, name_token.a.str))
+   {
+      internal_error_msg("Failed to allocate memory!\n");
+      HANDLE_ERROR(INTERNAL_ERR, success);
+   }
+
    return success;
 }
 
@@ -1786,6 +1812,7 @@ bool scope_statement()
       }
 
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       GET_TOKEN(token);
 
@@ -1793,7 +1820,7 @@ bool scope_statement()
 
       /* At the end of a scope block, variables declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
       
       block_depth--;
 
@@ -1879,15 +1906,18 @@ bool selection_statement()
 
       GET_TOKEN(token);
 
+      /* Branch is entered with the values known before it, unless it is
+         nested in a loop */
       int previous_structure = code_structure;
-      code_structure = CODE_STRUCTURE_JUMP;
+      code_structure = BRANCH_STRUCTURE(previous_structure);
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       if(!stat_list()) HANDLE_ERROR(SYNT_ERR, success);
 
       /* After exiting the blocks, variable declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
 
       block_depth--;
       code_structure = previous_structure;
@@ -1985,14 +2015,15 @@ bool alternative_statement()
       GET_TOKEN(token);
 
       int previous_structure = code_structure;
-      code_structure = CODE_STRUCTURE_JUMP;
+      code_structure = BRANCH_STRUCTURE(previous_structure);
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       if(!stat_list()) HANDLE_ERROR(SYNT_ERR, success);
 
       /* After exiting the blocks, variable declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
 
       block_depth--;
       code_structure = previous_structure;
@@ -2018,14 +2049,15 @@ bool alternative_statement()
       generate(&instr_stack, ELSE_ID);
 
       int previous_structure = code_structure;
-      code_structure = CODE_STRUCTURE_JUMP;
+      code_structure = BRANCH_STRUCTURE(previous_structure);
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       if(!stat_list()) HANDLE_ERROR(SYNT_ERR, success);
 
       /* After exiting the blocks, variable declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
 
       block_depth--;
       code_structure = previous_structure;
@@ -2070,6 +2102,7 @@ bool iteration_statement()
       cycle_depth++;
 
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       /* Generate internal labels for cycle structure */
       generate(&instr_stack, FOR_ID);
@@ -2149,6 +2182,12 @@ bool iteration_statement()
          it_var.used = false;
          vdstack_push(&(symbol_to_use->s.var_stack), &it_var);
          var = vdstack_top(&(symbol_to_use->s.var_stack));
+
+         if(stab_scope_log(&local_table, name.a.str))
+         {
+            internal_error_msg("Failed to allocate memory!\n");
+            HANDLE_ERROR(INTERNAL_ERR, success);
+         }
       }
 
       if(token.id != EQUALS_ID)
@@ -2301,7 +2340,7 @@ bool iteration_statement()
 
       /* After exiting the blocks, variable declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
 
 
       block_depth--;
@@ -2505,13 +2544,14 @@ bool do_cycle()
       /* <do_cycle> -> EOL <stat_list> Loop <opt_cond> simulation */
 
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       GET_TOKEN(token);
       if(!stat_list()) HANDLE_ERROR(SYNT_ERR, success);
 
       /* After exiting the blocks, variable declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
 
       block_depth--;
 
@@ -2587,6 +2627,7 @@ bool do_cycle()
       generate(&instr_stack, MAKE_LOOP_ID);
 
       block_depth++;
+      stab_mark_t block_mark = stab_scope_mark(&local_table);
 
       GET_TOKEN(token);
       if(!stat_list()) HANDLE_ERROR(SYNT_ERR, success);
@@ -2602,7 +2643,7 @@ bool do_cycle()
 
       /* After exiting the blocks, variable declared in it
          should become invalid */
-      pop_block_vars(&local_table, block_depth);
+      pop_block_vars(&local_table, block_mark);
 
       block_depth--;
 
@@ -3070,29 +3111,16 @@ bool empty_statement()
    return success;
 }
 
-void pop_block_vars(symtab_t *table, int depth)
+void pop_block_vars(symtab_t *table, stab_mark_t mark)
 {
-   stab_iterator_t it;
-   stab_iterate_set(table, &it);
-   symbol_t *to_remove = NULL;
-   while(it.item != NULL)
+   symbol_t *to_remove;
+
+   /* Only the variables declared in the block are visited */
+   while((to_remove = stab_scope_rollback(table, mark)) != NULL)
    {
-      if(it.item->data.type == SYMB_VAR)
-      {
-         struct var_info *var = vdstack_top(&(it.item->data.s.var_stack));
-         if(var->depth == depth)
-            vdstack_pop(&(it.item->data.s.var_stack));
-         if(vdstack_top(&(it.item->data.s.var_stack)) == NULL)
-         {
-            to_remove = &(it.item->data);
-         }
-      }
-      stab_iterate_next(table, &it);
-      if(to_remove != NULL)
-      {
+      vdstack_pop(&(to_remove->s.var_stack));
+      if(vdstack_empty(&(to_remove->s.var_stack)))
          stab_delete_symbol(table, to_remove->id);
-         to_remove = NULL;
-      }
    }
 }
 
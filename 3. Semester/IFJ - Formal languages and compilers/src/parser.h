@@ -12,7 +12,9 @@
 #define PARSER_H_INCLUDED
 
 /*		Includes section	*/
+#include "fcache.h"
 #include "scanner.h"
+#include "stats.h"
 #include "symtable.h"
 #include "tokenstack.h"
 #include "vdstack.h"
@@ -25,6 +27,9 @@
 #define HANDLE_ERROR(err,success) do { if(status == 0) {RegisterError(err); /* fprintf(stderr,"We failed\n"); */} success = false; return false;} while(0)
 #define SAFE_PUSH(stack, token) do { if(tstack_push(&stack, &token)) { HANDLE_ERROR(INTERNAL_ERR, success); \
                                 internal_error_msg("Failed to allocate memory!\n"); } } while(0)
+/* Code structure of a branch body, loops stay jump structures */
+#define BRANCH_STRUCTURE(previous) ((previous) == CODE_STRUCTURE_JUMP ? \
+                                    CODE_STRUCTURE_JUMP : CODE_STRUCTURE_BRANCH)
 
 #define SYMB_VAR 1
 #define SYMB_FUNC 2
@@ -58,6 +63,15 @@ extern int code_structure;
  */
 
  bool parse();
+
+/**
+ * @brief Resets the state of the parser kept between the rules, so another
+ *        program can be parsed by the same process (batch mode).  Tables
+ *        and stacks are initialized separately by their modules.
+ *
+ * @return void.
+ */
+ void parser_reinit();
  bool integrate_builtin();
  char *token_to_string(int id);
 
@@ -65,7 +79,10 @@ extern int code_structure;
 
 static inline bool getToken(token_t *token)
 {
-    int result = get_next_token(token);
+    STATS_START(STATS_PHASE_SCANNER);
+    int result = fcache_next_token(token);
+    STATS_STOP(STATS_PHASE_SCANNER);
+    STATS_COUNT(STATS_TOKENS, 1);
     if(result == LEX_ERR)
     {
         fprintf(stderr, "Unrecognized token %s\n", token->a.str);
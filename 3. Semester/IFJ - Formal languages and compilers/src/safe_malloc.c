@@ -10,16 +10,219 @@
  *
  * Module is internally implemented as an array, which holds pointers to all
  * allocated memory that has been done though memory management module
- * functions.  Upon a free, address gets searched, freed, removed from the
- * array and last element is placed to this array index to keep array
- * proper array consistency. 
+ * functions.  Every block is prefixed with a hidden header, which stores the
+ * index of the block in this array.  Upon a free, the index is read from the
+ * header, so no search is needed.  The block is freed, removed from the array
+ * and last element is placed to this array index (its header index gets
+ * updated) to keep array proper array consistency. 
+ *
+ * If the module is compiled with MEMMAN_ARENA defined, memory is instead
+ * carved from large chunks by bumping a pointer (arena mode).  Single blocks
+ * are then released only when they are the last block of the current chunk,
+ * all other memory lives until memman_clear().
+ *
+ * If IFJ_STATS is defined, calls, bytes of live blocks and their peak are
+ * counted.  Arena mode counts bytes handed out from the chunks including
+ * headers, heap mode counts sizes requested by the user.
  */
 
 #include "safe_malloc.h"
+#include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
 static memman_data mem_data;
+static memman_stats_t mem_stats;
+
+#ifdef IFJ_STATS
+
+/*
+ * Adds count to the live bytes and updates their peak.
+ */
+static void memman_add_bytes(size_t count)
+{
+   mem_stats.bytes += count;
+   if(mem_stats.bytes > mem_stats.peak_bytes)
+      mem_stats.peak_bytes = mem_stats.bytes;
+}
+
+#define MEMMAN_COUNT(counter) (mem_stats.counter++)
+#define MEMMAN_ADD_BYTES(count) memman_add_bytes(count)
+#define MEMMAN_SUB_BYTES(count) (mem_stats.bytes -= (count))
+
+#else
+
+#define MEMMAN_COUNT(counter) ((void) 0)
+#define MEMMAN_ADD_BYTES(count) ((void) 0)
+#define MEMMAN_SUB_BYTES(count) ((void) 0)
+
+#endif
+
+#ifdef MEMMAN_ARENA
+
+/*
+ * Rounds size up to the multiple of header size, which keeps every block
+ * header aligned.
+ */
+static size_t memman_align(size_t size)
+{
+   return (size + sizeof(memman_header) - 1) / sizeof(memman_header) * 
+          sizeof(memman_header);
+}
+
+/*
+ * Starts new chunk able to hold at least size bytes including block header.
+ */
+static int memman_new_chunk(size_t size)
+{
+   size_t chunk_siz = MEMMAN_ARENA_CHUNK_SIZ;
+
+   /* Oversized blocks get a chunk of their own.   */
+   if(size > chunk_siz)
+      chunk_siz = size;
+
+   memman_chunk *newc = malloc(sizeof(memman_chunk) + chunk_siz);
+
+   if(newc == NULL)
+      return MEMMAN_FAILURE;
+
+   MEMMAN_COUNT(sys_allocs);
+   newc->prev = mem_data.chunk;
+   newc->size = chunk_siz;
+   newc->used = 0;
+   mem_data.chunk = newc;
+
+   return MEMMAN_SUCCESS;
+}
+
+/*
+ * Returns true if the block starting with header is the last block bumped
+ * from the current chunk.
+ */
+static int memman_is_last(memman_header *header)
+{
+   memman_chunk *chunk = mem_data.chunk;
+
+   return chunk != NULL && (char *)(header + 1) + header->block.size == 
+          (char *)chunk->data + chunk->used;
+}
+
+int memman_init()
+{
+   mem_data.chunk = NULL;
+
+   return MEMMAN_SUCCESS;
+}
+
+void memman_clear()
+{
+   MEMMAN_SUB_BYTES(mem_stats.bytes);
+
+   /* Free the whole chain of chunks.  */
+   while(mem_data.chunk != NULL)
+   {
+      memman_chunk *prev = mem_data.chunk->prev;
+
+      free(mem_data.chunk);
+      mem_data.chunk = prev;
+   }
+
+   return;
+}
+
+void memman_free_all()
+{
+   memman_clear();
+
+   return;
+}
+
+void sfree(void *addr)
+{
+   if(addr == NULL)
+      return;
+
+   memman_header *header = (memman_header *)addr - 1;
+
+   MEMMAN_COUNT(frees);
+
+   /* Only the last block can be given back, others wait for clear.  */
+   if(memman_is_last(header))
+   {
+      MEMMAN_SUB_BYTES(sizeof(memman_header) + header->block.size);
+      mem_data.chunk->used -= sizeof(memman_header) + header->block.size;
+   }
+}
+
+void * smalloc(size_t size)
+{
+   MEMMAN_COUNT(requests);
+
+   /* Check for the overflow of the block size.  */
+   if(size > (size_t)-1 / 2)
+      return NULL;
+
+   size_t block_siz = sizeof(memman_header) + memman_align(size);
+   memman_chunk *chunk = mem_data.chunk;
+
+   /* Start new chunk if the current one has not enough space left.  */
+   if(chunk == NULL || chunk->size - chunk->used < block_siz)
+   {
+      if(memman_new_chunk(block_siz) == MEMMAN_FAILURE)
+         return NULL;
+
+      chunk = mem_data.chunk;
+   }
+
+   /* Bump the pointer.  */
+   memman_header *header = (memman_header *)((char *)chunk->data + 
+                                             chunk->used);
+
+   header->block.size = memman_align(size);
+   chunk->used += block_siz;
+   MEMMAN_ADD_BYTES(block_siz);
+
+   return header + 1;
+}
+
+void * srealloc(void *addr, size_t size)
+{
+   /* If input pointer is NULL, new block is allocated.  */
+   if(addr == NULL)
+      return smalloc(size);
+
+   memman_header *header = (memman_header *)addr - 1;
+   memman_chunk *chunk = mem_data.chunk;
+
+   /* Block fits already, nothing has to be done.   */
+   if(size <= header->block.size)
+   {
+      MEMMAN_COUNT(requests);
+      return addr;
+   }
+
+   /* The last block of the chunk can be grown in place.  */
+   if(memman_is_last(header) && size <= (size_t)-1 / 2 &&
+      chunk->size - chunk->used >= memman_align(size) - header->block.size)
+   {
+      MEMMAN_COUNT(requests);
+      MEMMAN_ADD_BYTES(memman_align(size) - header->block.size);
+      chunk->used += memman_align(size) - header->block.size;
+      header->block.size = memman_align(size);
+
+      return addr;
+   }
+
+   /* Otherwise copy the block to the new place.   */
+   void *newptr = smalloc(size);
+
+   if(newptr != NULL)
+      memcpy(newptr, addr, header->block.size);
+
+   return newptr;
+}
+
+#else
 
 /*
  * Expands memory management data structure by MEMMAN_CHUNK_SIZ number of
@@ -28,8 +231,8 @@ static memman_data mem_data;
 static int memman_expand()
 {
    /* Expand current size by MEMMAN_CHUNK_SIZ + error checking. */
-   void **newm = realloc(mem_data.ptrs, (mem_data.allocated + MEMMAN_CHUNK_SIZ)
-                                       * sizeof(void *));
+   memman_header **newm = realloc(mem_data.ptrs, (mem_data.allocated + 
+                                  MEMMAN_CHUNK_SIZ) * sizeof(memman_header *));
 
    if(newm == NULL)
       return MEMMAN_FAILURE;
@@ -41,10 +244,23 @@ static int memman_expand()
    return MEMMAN_SUCCESS;
 }
 
+/*
+ * Saves header to the end of the pointer array and returns address of the
+ * user part of the block.  Space in the array has to be ensured by caller.
+ */
+static void *memman_track(memman_header *header)
+{
+   header->block.index = mem_data.size;
+   mem_data.ptrs[mem_data.size] = header;
+   mem_data.size++;
+
+   return header + 1;
+}
+
 int memman_init()
 {
    /* Alloc memory for initial number of elements + error checking.  */
-   mem_data.ptrs = calloc(MEMMAN_INIT_SIZ, sizeof(void *));
+   mem_data.ptrs = calloc(MEMMAN_INIT_SIZ, sizeof(memman_header *));
 
    if(mem_data.ptrs == NULL)
       return MEMMAN_FAILURE;
@@ -57,13 +273,15 @@ int memman_init()
 
 void memman_clear()
 {
+   MEMMAN_SUB_BYTES(mem_stats.bytes);
+
    /* Iterate through whole array sequentially and free approached items.  */
    for(unsigned i = 0; i < mem_data.size; i++)
       free(mem_data.ptrs[i]);
 
    /* Set size of array of pointers to 0 and all pointers to NULL.   */
    mem_data.size = 0;
-   memset(mem_data.ptrs, 0, mem_data.allocated);
+   memset(mem_data.ptrs, 0, mem_data.allocated * sizeof(memman_header *));
 
    return;
 }
@@ -78,45 +296,23 @@ void memman_free_all()
    return;
 }
 
-void * scalloc(size_t num, size_t size)
-{
-   int outcode = 0;;               // Output code of memman_expend function
-
-   /* Check if metadata array has enough space for the new item.   */
-   if(mem_data.size + 1 > mem_data.allocated)
-      outcode = memman_expand();
-
-   /* Check if the reallocation has not failed. */
-   if(outcode == MEMMAN_FAILURE)
-      return NULL;
-
-   /* Allocate space for the new element + check.  */
-   void *newptr = calloc(num, size);
-
-   if(newptr == NULL)
-      return NULL;
-
-   /* Allocation was OK - save pointer to the array and increment size.  */
-   mem_data.ptrs[mem_data.size] = newptr;
-   mem_data.size++;
-
-   return newptr;
-}
-
 void sfree(void *addr)
 {
-   /* Search for the desired address.  */
-   unsigned i = 0;                // Index of the address in the pointer array.
-
-   for(; addr != mem_data.ptrs[i] && i < mem_data.size; i++);
-
-   if(i != mem_data.size)
+   if(addr != NULL)
    {
-      /* When i != size of the array - memory address was found.  */
-      free(addr);
+      /* Move the last item to the place of the freed block.  */
+      memman_header *header = (memman_header *)addr - 1;
+      unsigned i = header->block.index;
+
+      /* Untracked or freed block would damage the entry moved here.  */
+      assert(i < mem_data.size && mem_data.ptrs[i] == header);
+      MEMMAN_COUNT(frees);
+      MEMMAN_SUB_BYTES(header->block.size);
       mem_data.ptrs[i] = mem_data.ptrs[mem_data.size - 1];
+      mem_data.ptrs[i]->block.index = i;
       mem_data.ptrs[mem_data.size - 1] = NULL;
       mem_data.size--;
+      free(header);
    }
 }
 
@@ -124,6 +320,8 @@ void * smalloc(size_t size)
 {
    int outcode = 0;               // Output code of memman_expend function
 
+   MEMMAN_COUNT(requests);
+
    /* Check if metadata array has enough space for the new item.   */
    if(mem_data.size + 1 > mem_data.allocated)
       outcode = memman_expand();
@@ -132,44 +330,77 @@ void * smalloc(size_t size)
    if(outcode == MEMMAN_FAILURE)
       return NULL;
 
-   /* Allocate space for the new element + check.  */
-   void *newptr = malloc(size);
+   /* Allocate space for the new element including its header + check.  */
+   if(size > (size_t)-1 - sizeof(memman_header))
+      return NULL;
+
+   memman_header *newptr = malloc(sizeof(memman_header) + size);
 
    if(newptr == NULL)
       return NULL;
 
    /* Allocation was OK - save pointer to the array and increment size.  */
-   mem_data.ptrs[mem_data.size] = newptr;
-   mem_data.size++;
+   MEMMAN_COUNT(sys_allocs);
+#ifdef IFJ_STATS
+   newptr->block.size = size;
+#endif
+   MEMMAN_ADD_BYTES(size);
 
-   return newptr;
+   return memman_track(newptr);
 }
 
 void * srealloc(void *addr, size_t size)
 {
-   /* Search for the desired address.  */
-   unsigned i = 0;                // Index of the address in the pointer array.
-   void *newptr = NULL;           // Pointer to the allocated memory
-
-   /* If input pointer is NULL.  */
+   /* If input pointer is NULL, new tracked block is allocated.  */
    if(addr == NULL)
-      return malloc(size);
+      return smalloc(size);
 
-   /* If the input address is not NULL, find the element and realloc.   */
-   for(; addr != mem_data.ptrs[i] && i < mem_data.size; i++);
+   MEMMAN_COUNT(requests);
 
-   /* If the element was found, realloc it, otherwise return NULL.   */
-   if(i != mem_data.size)
-   {
-      /* Make realloc + error checking.   */
-      newptr = realloc(addr, size);
+   /* If the input address is not NULL, take its header and realloc.   */
+   memman_header *header = (memman_header *)addr - 1;
 
-      if(newptr == NULL)
-         return NULL;
+   if(size > (size_t)-1 - sizeof(memman_header))
+      return NULL;
 
-      /* Change the pointer to the realloced one.  */
-      mem_data.ptrs[i] = newptr;
-   }
+   /* Make realloc + error checking.   */
+   unsigned i = header->block.index;
+   assert(i < mem_data.size && mem_data.ptrs[i] == header);
+   memman_header *newptr = realloc(header, sizeof(memman_header) + size);
+
+   if(newptr == NULL)
+      return NULL;
+
+   /* Change the pointer to the realloced one.  */
+   MEMMAN_COUNT(sys_allocs);
+#ifdef IFJ_STATS
+   MEMMAN_SUB_BYTES(newptr->block.size);
+   newptr->block.size = size;
+#endif
+   MEMMAN_ADD_BYTES(size);
+   mem_data.ptrs[i] = newptr;
    
-   return newptr;   
-}
\ No newline at end of file
+   return newptr + 1;   
+}
+
+#endif
+
+void memman_get_stats(memman_stats_t *stats)
+{
+   *stats = mem_stats;
+}
+
+void * scalloc(size_t num, size_t size)
+{
+   /* Check for the overflow of the total size.  */
+   if(size != 0 && num > ((size_t)-1 - sizeof(memman_header)) / size)
+      return NULL;
+
+   /* Allocate zeroed memory, header is rewritten by smalloc anyway.  */
+   void *newptr = smalloc(num * size);
+
+   if(newptr != NULL)
+      memset(newptr, 0, num * size);
+
+   return newptr;
+}
@@ -10,9 +10,20 @@
  *
  * Module is internally implemented as an array, which holds pointers to all
  * allocated memory that has been done though memory management module
- * functions.  Upon a free, address gets searched, freed, removed from the
- * array and last element is placed to this array index to keep array
- * proper array consistency. 
+ * functions.  Every block is prefixed with a hidden header, which stores the
+ * index of the block in this array.  Upon a free, the index is read from the
+ * header, so no search is needed.  The block is freed, removed from the array
+ * and last element is placed to this array index (its header index gets
+ * updated) to keep array proper array consistency. 
+ *
+ * If the module is compiled with MEMMAN_ARENA defined, memory is instead
+ * carved from large chunks by bumping a pointer (arena mode).  Single blocks
+ * are then released only when they are the last block of the current chunk,
+ * all other memory lives until memman_clear().  Arena mode is selected for
+ * the whole compiler by 'make arena'.
+ *
+ * If IFJ_STATS is defined, the module also counts calls, bytes of live blocks
+ * and their peak.  Heap mode headers then remember the size of the block.
  */
 
 #ifndef SAFE_MALLOC_H_INCLUDED
@@ -32,13 +43,63 @@
 /** @brief Extension memory array size during reallocation process.  */
 #define MEMMAN_CHUNK_SIZ 256
 
+/** @brief Size of a single arena chunk in arena mode.  */
+#define MEMMAN_ARENA_CHUNK_SIZ 65536
+
+/**
+ * @brief Header placed in front of every tracked block.  Union members
+ *        prefixed with align are never used, they only force the maximal
+ *        alignment, so the user part of the block stays aligned as if
+ *        returned by malloc.
+ */
+typedef union memory_management_header
+{
+   struct memory_management_block
+   {
+#ifdef MEMMAN_ARENA
+      size_t size;               ///< Size of the block in the arena
+#else
+      unsigned index;            ///< Index of the block in the pointer array
+#ifdef IFJ_STATS
+      size_t size;               ///< Size of the block for the statistics
+#endif
+#endif
+   } block;                      ///< Data of the header
+   long double align_ld;         ///< Alignment only
+   long long align_ll;           ///< Alignment only
+   void *align_ptr;              ///< Alignment only
+} memman_header;
+
+/** @brief Single chunk of the arena, blocks follow right after it.  */
+typedef struct memory_management_chunk
+{
+   struct memory_management_chunk *prev;  ///< Previously used chunk
+   size_t size;                           ///< Usable size of the chunk
+   size_t used;                           ///< Bytes already handed out
+   memman_header data[];                  ///< Aligned start of the blocks
+} memman_chunk;
+
 typedef struct memory_management_data
 {
    unsigned allocated;           ///< Size of the allocated array
    unsigned size;                ///< Current size of the array
-   void **ptrs;                  ///< Array of pointers
+   memman_header **ptrs;         ///< Array of pointers to block headers
+   memman_chunk *chunk;          ///< Current arena chunk (arena mode only)
 } memman_data;
 
+/**
+ * @brief Allocation statistics of the memory management module, counted only
+ *        if IFJ_STATS is defined.
+ */
+typedef struct memory_management_stats
+{
+   unsigned long requests;       ///< Number of smalloc/scalloc/srealloc calls
+   unsigned long sys_allocs;     ///< Number of malloc/realloc calls issued
+   unsigned long frees;          ///< Number of sfree calls with a block
+   size_t bytes;                 ///< Bytes of live blocks
+   size_t peak_bytes;            ///< Maximum of bytes
+} memman_stats_t;
+
 /**
  * @brief Initializes internal pointer array to the MEMMAN_INIT_SIZ value.
  *
@@ -62,6 +123,14 @@ void memman_clear();
  */
 void memman_free_all();
 
+/**
+ * @brief Copies allocation statistics collected since memman_init().
+ *
+ * @param stats Structure to be filled.
+ * @return void.
+ */
+void memman_get_stats(memman_stats_t *stats);
+
 /**
  * @brief Wrapper around calloc.  Acts literally the same for end the user but
  *        internally tracks allocated memory to the pointer array.
@@ -75,11 +144,13 @@ void *scalloc(size_t num, size_t size);
 
 /**
  * @brief Wrapper around free.  Acts literally the same for end the end user
- *        but internally tracks allocated memory to the pointer array.  If the
- *        sfree() function is called, whole pointer array is searched, if the
- *        desired address exists, it gets freed in the same way as if free()
- *        was called.  If the desired address is not allocated through
- *        memory management module, nothing happens.
+ *        but internally tracks allocated memory to the pointer array.  Index
+ *        of the address is taken from its block header in constant time and
+ *        memory gets freed in the same way as if free() was called.  Address
+ *        has to be NULL, in which case nothing happens, or a live block
+ *        returned by memory management module functions.  Freeing a block
+ *        twice or after memman_clear() is undefined, as with free(),
+ *        unless NDEBUG is defined an assertion stops such a call.
  *
  * @param addr Address to be freed.
  * @return void.
@@ -98,7 +169,8 @@ void * smalloc(size_t size);
 
 /**
  * @brief Wrapper around realloc.  Acts literally the same for end the user but
- *        internally tracks allocated memory to the pointer array.
+ *        internally tracks allocated memory to the pointer array.  If addr is
+ *        NULL, acts as smalloc(), so the new block is tracked as well.
  *
  * @param addr Address of the address to be realocated.
  * @param size Size of the new block size.
@@ -11,18 +11,29 @@
  * Its operation is done on per call basis, when parser calls get_next_token()
  * function and scanner returns new token (or LEX_ERR) every time.  Module
  * recognizes keywords from identifiers using is_keyword() function, which uses
- * pseudo-binary search tree to find out the keyword faster.
+ * a perfect hash table to find out the keyword in a single probe.
  *
  * Source file defines deterministic finite automaton, which recognizes tokens
  * based on the currently processed character based on the state in which the
  * automaton currently is.
+ *
+ * Whole input is loaded to the memory by set_source_file() using large block
+ * reads, so the automaton only moves a cursor over the buffer instead of
+ * calling fgetc() for every character.
+ *
+ * Identifiers and string literals, which do not need any escaping, are not
+ * copied.  Their attribute points directly to the loaded input, which gets
+ * lower-cased and terminated in place (the terminating character is always
+ * either consumed or already held in the pushback buffer).
  */
 
 #include "ifj17_api.h"
+#include "intern.h"
 #include "safe_malloc.h"
 #include "scanner.h"
 #include "str.h"
 #include <ctype.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,42 +41,139 @@
 /** @brief Input file used by get_next_token() function.   */
 FILE *source;
 
+/** @brief Contents of the input file loaded by set_source_file().  */
+static char *source_data = NULL;
+
+/** @brief Length of the loaded input.  */
+static size_t source_len = 0;
+
+/** @brief Position of the next character to be read from the input.  */
+static size_t source_pos = 0;
+
+/** @brief Character pushed back by the automaton until the next call.  */
+static int buffer = BUF_EMPTY;
+
+/*
+ * Returns true if str_add_char() would store the character c of a string
+ * literal differently than it is written in the source.
+ */
+static bool str_char_changes(int c)
+{
+   return c > SCHAR_MAX || iscntrl(c) || isspace(c) || c == '#';
+}
+
+/*
+ * Copies the part of a string literal, which was so far kept in the input,
+ * to the dynamic string, once the literal has to be rewritten.
+ */
+static void str_materialize(size_t start, size_t end)
+{
+   for(size_t i = start; i < end; i++)
+      str_add_char(&str, source_data[i]);
+}
+
+/*
+ * Terminates the input at position end and returns the token text starting
+ * at position start.
+ */
+static char *source_slice(size_t start, size_t end)
+{
+   source_data[end] = '\0';
+
+   return source_data + start;
+}
+
 /** @brief Line counter used for error reporting.  */
 int line_counter = 1;
 
 string_t str;
 
+/** @brief Keyword table entry.  */
+typedef struct keyword_entry
+{
+   const char *name;                ///< Keyword string
+   int len;                         ///< Length of the keyword
+   int id;                          ///< Token ID of the keyword
+} keyword_t;
+
+/*
+ * Perfect hash table of keywords.  Positions are computed at compile time by
+ * KEYWORD_HASH, which is collision-free for the keyword set (a collision would
+ * override an initializer and fail the build with -Wextra -Werror).  Unused
+ * positions have NULL name.
+ */
+static const keyword_t keywords[KEYWORD_HASH_SIZE] = {
+   [KEYWORD_HASH(3, 'a', 'd')] = {AND, sizeof(AND) - 1, AND_ID},
+   [KEYWORD_HASH(2, 'a', 's')] = {AS, sizeof(AS) - 1, AS_ID},
+   [KEYWORD_HASH(3, 'a', 'c')] = {ASC, sizeof(ASC) - 1, ASC_ID},
+   [KEYWORD_HASH(7, 'b', 'n')] = {BOOLEANN, sizeof(BOOLEANN) - 1, BOOLEAN_ID},
+   [KEYWORD_HASH(3, 'c', 'r')] = {CHR, sizeof(CHR) - 1, CHR_ID},
+   [KEYWORD_HASH(8, 'c', 'e')] = {CONTINUE, sizeof(CONTINUE) - 1, CONTINUE_ID},
+   [KEYWORD_HASH(7, 'd', 'e')] = {DECLARE, sizeof(DECLARE) - 1, DECLARE_ID},
+   [KEYWORD_HASH(3, 'd', 'm')] = {DIM, sizeof(DIM) - 1, DIM_ID},
+   [KEYWORD_HASH(2, 'd', 'o')] = {DO, sizeof(DO) - 1, DO_ID},
+   [KEYWORD_HASH(6, 'd', 'e')] = {DOUBLE, sizeof(DOUBLE) - 1, DOUBLE_ID},
+   [KEYWORD_HASH(4, 'e', 'e')] = {ELSE, sizeof(ELSE) - 1, ELSE_ID},
+   [KEYWORD_HASH(6, 'e', 'f')] = {ELSEIF, sizeof(ELSEIF) - 1, ELSEIF_ID},
+   [KEYWORD_HASH(3, 'e', 'd')] = {END, sizeof(END) - 1, END_ID},
+   [KEYWORD_HASH(4, 'e', 't')] = {EXIT, sizeof(EXIT) - 1, EXIT_ID},
+   [KEYWORD_HASH(5, 'f', 'e')] = {FALSEE, sizeof(FALSEE) - 1, FALSE_ID},
+   [KEYWORD_HASH(3, 'f', 'r')] = {FOR, sizeof(FOR) - 1, FOR_ID},
+   [KEYWORD_HASH(8, 'f', 'n')] = {FUNCTION, sizeof(FUNCTION) - 1, FUNCTION_ID},
+   [KEYWORD_HASH(2, 'i', 'f')] = {IF, sizeof(IF) - 1, IF_ID},
+   [KEYWORD_HASH(5, 'i', 't')] = {INPUT, sizeof(INPUT) - 1, INPUT_ID},
+   [KEYWORD_HASH(7, 'i', 'r')] = {INTEGER, sizeof(INTEGER) - 1, INTEGER_ID},
+   [KEYWORD_HASH(6, 'l', 'h')] = {LENGTH, sizeof(LENGTH) - 1, LENGTH_ID},
+   [KEYWORD_HASH(4, 'l', 'p')] = {LOOP, sizeof(LOOP) - 1, LOOP_ID},
+   [KEYWORD_HASH(4, 'n', 't')] = {NEXT, sizeof(NEXT) - 1, NEXT_ID},
+   [KEYWORD_HASH(3, 'n', 't')] = {NOT, sizeof(NOT) - 1, NOT_ID},
+   [KEYWORD_HASH(2, 'o', 'r')] = {OR, sizeof(OR) - 1, OR_ID},
+   [KEYWORD_HASH(5, 'p', 't')] = {PRINT, sizeof(PRINT) - 1, PRINT_ID},
+   [KEYWORD_HASH(6, 'r', 'n')] = {RETURN, sizeof(RETURN) - 1, RETURN_ID},
+   [KEYWORD_HASH(5, 's', 'e')] = {SCOPE, sizeof(SCOPE) - 1, SCOPE_ID},
+   [KEYWORD_HASH(6, 's', 'd')] = {SHARED, sizeof(SHARED) - 1, SHARED_ID},
+   [KEYWORD_HASH(6, 's', 'c')] = {STATIC, sizeof(STATIC) - 1, STATIC_ID},
+   [KEYWORD_HASH(4, 's', 'p')] = {STEP, sizeof(STEP) - 1, STEP_ID},
+   [KEYWORD_HASH(6, 's', 'g')] = {STRING, sizeof(STRING) - 1, STRING_ID},
+   [KEYWORD_HASH(6, 's', 'r')] = {SUBSTR, sizeof(SUBSTR) - 1, SUBSTR_ID},
+   [KEYWORD_HASH(4, 't', 'n')] = {THEN, sizeof(THEN) - 1, THEN_ID},
+   [KEYWORD_HASH(2, 't', 'o')] = {TO, sizeof(TO) - 1, TO_ID},
+   [KEYWORD_HASH(4, 't', 'e')] = {TRUEE, sizeof(TRUEE) - 1, TRUE_ID},
+   [KEYWORD_HASH(5, 'u', 'l')] = {UNTIL, sizeof(UNTIL) - 1, UNTIL_ID},
+   [KEYWORD_HASH(5, 'w', 'e')] = {WHILE, sizeof(WHILE) - 1, WHILE_ID},
+};
+
 /* 
  * Finds if the string is a FREEBasic language keyword. 
- * Keywords are ordered alphabetically and search works
- * using binary search tree for better performance.
+ * Identifier is hashed by its length, first and last character, which
+ * selects the only possible keyword, that is then compared with it.
  */
-static int is_keyword(string_t *str);
+static int is_keyword(const char *string_data, int len);
 
 int get_next_token(token_t *token)
 {
-   static int buffer = BUF_EMPTY;           // Buffer chars until next call
    int c = 0;                               // Loaded character
    int state = def;                         // State of the finite automaton
-   char *string_data;                       // Pointer to the dynamic str. data
    bool quit = false;                       // Function will return on true
+   size_t c_pos = 0;                        // Position of 'c' in the input
+   size_t token_start = 0;                  // Position of the token text
+   bool str_copied = false;                 // String literal is in 'str'
 
    /* Prepare dynamically sized-string.   */
    str_clear(&str);
    
    while(c != EOF)
    {
-
-      /* Update loaded string during the reading process.   */
-      string_data = str_get_data(&str);
-      
       /*
        * When the local buffer is empty, get the next character, otherwise pass
        * the character from the buffer to 'c'.
        */
       if(buffer == BUF_EMPTY)
       {
-         c = fgetc(source);
+         if(source_pos < source_len)
+            c = (unsigned char)source_data[source_pos++];
+         else
+            c = EOF;
       }
       else
       {
@@ -73,10 +181,17 @@ int get_next_token(token_t *token)
          buffer = BUF_EMPTY;
       }
 
-      /*  Lower characters if the FSA is not processing a string. */
-      if(state != str_inside && state != str_esc_seq_x && state != str_error &&
-         state != str_esc_seq_xy_any && state != str_esc_seq_xy_5max &&
-         state != str_esc_seq_xyz_any && state != str_esc_seq_xyz_5max)
+      /* 
+       * Pushed back character is always the last one read, so the position
+       * of 'c' is given by the cursor.
+       */
+      c_pos = (c == EOF) ? source_len : source_pos - 1;
+
+      /*
+       * Lower characters if the FSA is not processing a string.  String states
+       * form a continuous range from str_inside to str_error.
+       */
+      if(state < str_inside || state > str_error)
       {
          c = tolower(c);
       }
@@ -112,7 +227,9 @@ int get_next_token(token_t *token)
          /* Receive alpha-type character or '_' - switch to ID state.  */
          else if(isalpha(c) || c == '_')
          {
-            str_add_char(&str, c);
+            /* Identifier is lower-cased in place.   */
+            source_data[c_pos] = c;
+            token_start = c_pos;
             state = identifier;
          }
          /* Receive number - switch to number processing state.   */
@@ -250,20 +367,25 @@ int get_next_token(token_t *token)
          /* If received character is alphanumeric or '_', still in the id. */
          if(isalnum(c) || c == '_')
          {
-            str_add_char(&str, c);
+            source_data[c_pos] = c;
          }
          /* Received other character, end of the identifier was reached.   */
          else
          {
             /* Find out if read token is identifier or keyword.   */
-            int id = is_keyword(&str);
+            int id = is_keyword(source_data + token_start, c_pos - token_start);
             buffer = c;
 
             /* Check if the processed token is keyword or identifier.   */
             if(id == NO_KEYWORD_MATCHED)
             {
-               /* No keyword was found -> token is an identifier. */
-               token->a.str = str_copy_to_cstring(&str);
+               /* No keyword was found -> token is the interned identifier,
+                  the slice of the input is used if interning fails.  */
+               char *slice = source_slice(token_start, c_pos);
+
+               token->a.str = intern_cstring(slice);
+               if(token->a.str == NULL)
+                  token->a.str = slice;
                token->id = ID_ID;
             }
             else
@@ -306,7 +428,7 @@ int get_next_token(token_t *token)
          else
          {
             /* Did not receive expected value - end of the number reached. */
-            int value = strtol(string_data, NULL, 10);
+            int value = strtol(str_get_data(&str), NULL, 10);
 
             token->a.val_int = value;
             token->id = INTEGER_LITERAL_ID;
@@ -586,7 +708,7 @@ int get_next_token(token_t *token)
          else
          {
             /* Non-binary character received - return decimal value. */
-            int bin_val = strtol(string_data, NULL, 2);
+            int bin_val = strtol(str_get_data(&str), NULL, 2);
             token->a.val_int = bin_val;
             token->id = INTEGER_LITERAL_ID;
             buffer = c;
@@ -611,7 +733,7 @@ int get_next_token(token_t *token)
          else
          {
             /* Non-hex character received - return hexadecimal value. */
-            int hex_val = strtol(string_data, NULL, 16);
+            int hex_val = strtol(str_get_data(&str), NULL, 16);
             token->a.val_int = hex_val;
             token->id = INTEGER_LITERAL_ID;
             buffer = c;
@@ -635,7 +757,7 @@ int get_next_token(token_t *token)
          else
          {
             /* Non-octal character received - return octal value. */
-            int oct_val = strtol(string_data, NULL, 8);
+            int oct_val = strtol(str_get_data(&str), NULL, 8);
             token->a.val_int = oct_val;
             token->id = INTEGER_LITERAL_ID;
             buffer = c;
@@ -738,6 +860,9 @@ int get_next_token(token_t *token)
       case str_check_start:
          if(c == '"')
          {
+            /* String is kept in the input until it has to be rewritten.  */
+            token_start = c_pos + 1;
+            str_copied = false;
             state = str_inside;
          }
          else
@@ -764,11 +889,24 @@ int get_next_token(token_t *token)
        * IFJ17 language and are considered as an error.
        */
       case str_inside:
+         /* Anything else than plain character forces the copy of string.  */
+         if(!str_copied && c != '"' && 
+            (c == EOF || c == '\\' || str_char_changes(c)))
+         {
+            str_materialize(token_start, c_pos);
+            str_copied = true;
+         }
+
          if(c == '"')
          {
             /* End of the string is received.   */
             token->id = STRING_LITERAL_ID;
-            token->a.str = str_copy_to_cstring(&str);
+
+            if(str_copied)
+               token->a.str = str_copy_to_cstring(&str);
+            else
+               token->a.str = source_slice(token_start, c_pos);
+
             quit = true;
          }
          else if(c == '\\')
@@ -786,7 +924,7 @@ int get_next_token(token_t *token)
             str_append_cstring(&str, "\'UNPRINTAB\'");
             state = str_error;
          }
-         else
+         else if(str_copied)
             str_add_char(&str, c);
 
          break;
@@ -1102,137 +1240,81 @@ int get_next_token(token_t *token)
    }
 }
 
-static int is_keyword(string_t *str)
+static int is_keyword(const char *string_data, int len)
 {
-   /* Processing a string is based on the hard-coded pseudo-binary tree.  */
-   char *string_data = str_get_data(str);          // String to be processed
+   /* Keywords are from 2 to 8 characters long.   */
+   if(len < KEYWORD_MIN_LEN || len > KEYWORD_MAX_LEN)
+      return NO_KEYWORD_MATCHED;
 
-   if(string_data[0] < 'i')
-   {
-      if(string_data[0] < 'd')
-      {
-         if(string_data[0] < 'b')
-         {
-            if(!str_cmpsc(str, AS))
-              return AS_ID;
-            else if(!str_cmpsc(str, ASC))
-               return ASC_ID;
-            else if(!str_cmpsc(str, AND))
-               return AND_ID;
-         }
-         else
-         {
-            if(!str_cmpsc(str, BOOLEANN))
-               return BOOLEAN_ID;
-            else if(!str_cmpsc(str, CONTINUE))
-               return CONTINUE_ID;
-            else if(!str_cmpsc(str, CHR))
-               return CHR_ID;
-         }
-      }
-      else
-      {
-         if(string_data[0] == 'd')
-         {
-            if(!str_cmpsc(str, DECLARE))
-               return DECLARE_ID;
-            else if(!str_cmpsc(str, DIM))
-               return DIM_ID;
-            else if(!str_cmpsc(str, DO))
-               return DO_ID;
-            else if(!str_cmpsc(str, DOUBLE))
-               return DOUBLE_ID;
-         }
-         else if(string_data[0] == 'e')
-         {
-            if(!str_cmpsc(str, EXIT))
-               return EXIT_ID;
-            else if(!str_cmpsc(str, ELSE))
-               return ELSE_ID;
-            else if(!str_cmpsc(str, ELSEIF))
-               return ELSEIF_ID;
-            else if(!str_cmpsc(str, END))
-               return END_ID;
-         }
-         else
-         {
-            if(!str_cmpsc(str, FOR))
-               return FOR_ID;
-            else if(!str_cmpsc(str, FALSEE))
-               return FALSE_ID;
-            else if(!str_cmpsc(str, FUNCTION))
-               return FUNCTION_ID;
-         }
-      }
-   }
-   else
+   const keyword_t *kw = &keywords[KEYWORD_HASH(len, 
+                                   (unsigned char)string_data[0],
+                                   (unsigned char)string_data[len - 1])];
+
+   /* Single candidate is compared in full.  */
+   if(kw->name != NULL && kw->len == len && 
+      !memcmp(kw->name, string_data, len))
+      return kw->id;
+
+   return NO_KEYWORD_MATCHED;
+}
+
+int set_source_file(FILE *f)
+{
+   size_t allocated = SOURCE_BLOCK_SIZ;      // Size of the input buffer
+   size_t read_len = 0;                      // Bytes read by a single fread
+
+   source = f;
+   source_len = 0;
+   source_pos = 0;
+   buffer = BUF_EMPTY;
+   line_counter = 1;
+   source_data = smalloc(allocated);
+
+   if(source_data == NULL)
+      return SOURCE_FAILURE;
+
+   /* Read the input by blocks, doubling the buffer when it gets full.  */
+   while((read_len = fread(source_data + source_len, 1, allocated - source_len,
+                           f)) > 0)
    {
-      if(string_data[0] < 's')
-      {
-         if(string_data[0] < 'm')
-         {
-            if(!str_cmpsc(str, IF))
-               return IF_ID;
-            else if(!str_cmpsc(str, LOOP))
-               return LOOP_ID;
-            else if(!str_cmpsc(str, INTEGER))
-               return INTEGER_ID;
-            else if(!str_cmpsc(str, INPUT))
-               return INPUT_ID;
-            else if(!str_cmpsc(str, LENGTH))
-               return LENGTH_ID;
-         }
-         else
-         {
-            if(!str_cmpsc(str, OR))
-               return OR_ID;
-            else if(!str_cmpsc(str, NEXT))
-               return NEXT_ID;
-            else if(!str_cmpsc(str, NOT))
-               return NOT_ID;
-            else if(!str_cmpsc(str, PRINT))
-               return PRINT_ID;
-            else if(!str_cmpsc(str, RETURN))
-               return RETURN_ID;
-         }
-      }
-      else
+      source_len += read_len;
+
+      if(source_len == allocated)
       {
-         if(string_data[0] < 't')
-         {
-            if(!str_cmpsc(str, SUBSTR))
-               return SUBSTR_ID;
-            else if(!str_cmpsc(str, SHARED))
-               return SHARED_ID;
-            else if(!str_cmpsc(str, SCOPE))
-               return SCOPE_ID;
-            else if(!str_cmpsc(str, STATIC))
-               return STATIC_ID;
-            else if(!str_cmpsc(str, STRING))
-               return STRING_ID;
-            else if(!str_cmpsc(str, STEP))
-               return STEP_ID;
-         }
-         else
-         {
-            if(!str_cmpsc(str, TO))
-               return TO_ID;
-            else if(!str_cmpsc(str, TRUEE))
-               return TRUE_ID;
-            else if(!str_cmpsc(str, THEN))
-               return THEN_ID;
-            else if(!str_cmpsc(str, UNTIL))
-               return UNTIL_ID;
-            else if(!str_cmpsc(str, WHILE))
-               return WHILE_ID;
-         }
+         char *new_data = srealloc(source_data, 2 * allocated);
+
+         if(new_data == NULL)
+            return SOURCE_FAILURE;
+
+         source_data = new_data;
+         allocated *= 2;
       }
    }
 
-   return NO_KEYWORD_MATCHED;
+   if(ferror(f))
+      return SOURCE_FAILURE;
+
+   return SOURCE_SUCCESS;
 }
 
-void set_source_file(FILE *f)
+int set_source_data(char *data, size_t len)
 {
-   source = f;
+   source = NULL;
+   source_data = data;
+   source_len = len;
+   source_pos = 0;
+   buffer = BUF_EMPTY;
+   line_counter = 1;
+
+   return (data != NULL) ? SOURCE_SUCCESS : SOURCE_FAILURE;
+}
+
+void scanner_reinit()
+{
+   source = NULL;
+   source_data = NULL;
+   source_len = 0;
+   source_pos = 0;
+   buffer = BUF_EMPTY;
+   line_counter = 1;
 }
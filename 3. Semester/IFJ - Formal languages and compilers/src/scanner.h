@@ -10,7 +10,7 @@
  * Its operation is done on per call basis, when parser calls get_next_token()
  * function and scanner returns new token (or LEX_ERR) every time.  Module
  * recognizes keywords from identifiers using is_keyword() function, which uses
- * pseudo-binary search tree to find out the keyword faster.
+ * a perfect hash table to find out the keyword in a single probe.
  *
  * Header file provides definition of various keywords and deterministic finite
  * automaton states.  Every lexeme type has its own identifier (number), which
@@ -28,9 +28,31 @@
 /* Identifies an empty buffer.   */
 #define BUF_EMPTY -10 
 
+/* Size of a single block read from the source file.  */
+#define SOURCE_BLOCK_SIZ 65536
+
+/* Return values of set_source_file().  */
+#define SOURCE_SUCCESS 0
+#define SOURCE_FAILURE 1
+
 /*  Identifies function output no keyword is found.  */
 #define NO_KEYWORD_MATCHED 0
 
+/*  Size of the keyword perfect hash table.  */
+#define KEYWORD_HASH_SIZE 128
+
+/*  Length bounds of the keywords.  */
+#define KEYWORD_MIN_LEN 2
+#define KEYWORD_MAX_LEN 8
+
+/*
+ * Perfect hash of a keyword computed from its length, first and last
+ * character.  Multipliers were found by an exhaustive search as the smallest
+ * ones without any collision for the keywords below.
+ */
+#define KEYWORD_HASH(len, first, last) \
+   (((len) + 29 * (first) + 20 * (last)) % KEYWORD_HASH_SIZE)
+
 /*  Error value when LEX_ERR occurs.  */
 #define LEX_ERR_TOK_VAL -2
 
@@ -176,12 +198,34 @@ enum fsm_states {
 };
 
 /**
- * @brief Sets a source file for lexical analyzer functions.
+ * @brief Sets a source file for lexical analyzer functions.  Whole file is
+ *        read to the memory at once, get_next_token() then works over it.
  *
  * @param *f Pointer to the already opened source file.
+ * @return SOURCE_SUCCESS if the file was loaded, SOURCE_FAILURE if the
+ *         reading or memory allocation failed.
+ */
+int set_source_file(FILE *f);
+
+/**
+ * @brief Sets an input already loaded in the memory as the source for lexical
+ *        analyzer functions.  Scanner terminates lexemes in place, so the
+ *        data has to be writable and allocated at least len + 1 bytes long.
+ *
+ * @param *data Contents of the input, scanner takes it over.
+ * @param len Length of the input.
+ * @return SOURCE_SUCCESS, SOURCE_FAILURE if data is NULL.
+ */
+int set_source_data(char *data, size_t len);
+
+/**
+ * @brief Returns the scanner to the state of a freshly started program.
+ *        Used between inputs of the batch mode, after the memory of the
+ *        previous input was released by memman_clear().
+ *
  * @return void.
  */
-void set_source_file(FILE *f);
+void scanner_reinit();
 
 /**
  * @brief Finds the next token in a stream of characters in the source file
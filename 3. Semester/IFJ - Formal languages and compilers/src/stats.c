@@ -0,0 +1,114 @@
+/**
+ * @file stats.c
+ * @brief Compile statistics for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module measures phases of the compiler, see stats.h.  It is compiled only
+ * together with IFJ_STATS.
+ */
+
+/* clock_gettime() is POSIX, it is not declared in strict C99 mode.  */
+#define _POSIX_C_SOURCE 199309L
+
+#include "stats.h"
+#include "safe_malloc.h"
+#include <stdbool.h>
+#include <time.h>
+
+/** @brief Measured phase.  */
+typedef struct stats_phase
+{
+   unsigned long calls;       ///< Number of outermost starts.
+   int depth;                 ///< Number of nested starts.
+   double begin;              ///< Time of the outermost start.
+   double seconds;            ///< Total time of the phase.
+} stats_phase_t;
+
+/** @brief Names of the phases in the report.  */
+static const char *stats_phase_names[STATS_PHASE_COUNT] =
+{
+   "total", "scanner", "parser", "expr", "order_ilist", "optimizer",
+   "instruction_print"
+};
+
+/** @brief Names of the counters in the report.  */
+static const char *stats_counter_names[STATS_COUNTER_COUNT] =
+{
+   "tokens", "symbols", "instructions", "fcache_hits", "fcache_misses"
+};
+
+static bool stats_enabled = false;
+static stats_phase_t stats_phases[STATS_PHASE_COUNT];
+static unsigned long stats_counters[STATS_COUNTER_COUNT];
+
+/*
+ * Returns time of the monotonic clock in seconds.
+ */
+static double stats_now()
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+void stats_enable()
+{
+   stats_enabled = true;
+}
+
+void stats_start(int phase)
+{
+   if(!stats_enabled || stats_phases[phase].depth++ > 0)
+      return;
+
+   stats_phases[phase].calls++;
+   stats_phases[phase].begin = stats_now();
+}
+
+void stats_stop(int phase)
+{
+   if(!stats_enabled || stats_phases[phase].depth == 0 ||
+      --stats_phases[phase].depth > 0)
+      return;
+
+   stats_phases[phase].seconds += stats_now() - stats_phases[phase].begin;
+}
+
+void stats_count(int counter, unsigned long value)
+{
+   if(stats_enabled)
+      stats_counters[counter] += value;
+}
+
+void stats_report(FILE *stream)
+{
+   memman_stats_t memory;
+
+   if(!stats_enabled)
+      return;
+
+   memman_get_stats(&memory);
+
+   fprintf(stream, "{\"phases\": {");
+   for(int i = 0; i < STATS_PHASE_COUNT; i++)
+   {
+      fprintf(stream, "%s\"%s\": {\"calls\": %lu, \"seconds\": %.6f}",
+              (i > 0) ? ", " : "", stats_phase_names[i],
+              stats_phases[i].calls, stats_phases[i].seconds);
+   }
+
+   fprintf(stream, "}, \"counters\": {");
+   for(int i = 0; i < STATS_COUNTER_COUNT; i++)
+   {
+      fprintf(stream, "%s\"%s\": %lu", (i > 0) ? ", " : "",
+              stats_counter_names[i], stats_counters[i]);
+   }
+
+   fprintf(stream, "}, \"memory\": {\"requests\": %lu, \"sys_allocs\": %lu, "
+           "\"frees\": %lu, \"bytes\": %lu, \"peak_bytes\": %lu}}\n",
+           memory.requests, memory.sys_allocs, memory.frees,
+           (unsigned long) memory.bytes, (unsigned long) memory.peak_bytes);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file stats.h
+ * @brief Compile statistics for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module measures time spent in the phases of the compiler and counts
+ * processed tokens, symbols and instructions.  Phases are measured by a
+ * monotonic clock and they can nest, so time of the scanner is included in
+ * the time of the parser and expressions.  Report is written as JSON
+ * together with the statistics of the memory management module.
+ *
+ * Instrumentation exists only if the compiler is built with IFJ_STATS
+ * defined ('make stats').  Otherwise all STATS_ macros expand to nothing.
+ */
+
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+#include <stdio.h>
+
+/** @brief Whole run of the compiler.  */
+#define STATS_PHASE_TOTAL 0
+
+/** @brief Scanner, get_next_token() calls.  */
+#define STATS_PHASE_SCANNER 1
+
+/** @brief Parser, parse() including expressions and scanner.  */
+#define STATS_PHASE_PARSER 2
+
+/** @brief Precedence analysis of expressions, expr() calls.  */
+#define STATS_PHASE_EXPR 3
+
+/** @brief Ordering of the instruction list, order_ilist().  */
+#define STATS_PHASE_ORDER 4
+
+/** @brief Optimizer passes enabled by -O.  */
+#define STATS_PHASE_OPTIMIZER 5
+
+/** @brief Printing of the code, instruction_print().  */
+#define STATS_PHASE_PRINT 6
+
+/** @brief Number of measured phases.  */
+#define STATS_PHASE_COUNT 7
+
+/** @brief Tokens returned by the scanner.  */
+#define STATS_TOKENS 0
+
+/** @brief Symbols inserted to symbol tables.  */
+#define STATS_SYMBOLS 1
+
+/** @brief Instructions of the generated list.  */
+#define STATS_INSTRUCTIONS 2
+
+/** @brief Function bodies spliced from the function cache.  */
+#define STATS_FCACHE_HITS 3
+
+/** @brief Function bodies looked up in the function cache and not found.  */
+#define STATS_FCACHE_MISSES 4
+
+/** @brief Number of counters.  */
+#define STATS_COUNTER_COUNT 5
+
+#ifdef IFJ_STATS
+
+/**
+ * @brief Enables measuring, calls before it are ignored.
+ *
+ * @return void.
+ */
+void stats_enable();
+
+/**
+ * @brief Starts measuring of the phase.  Nested starts of the same phase
+ *        are counted as one call.
+ *
+ * @param phase One of STATS_PHASE_ identifiers.
+ * @return void.
+ */
+void stats_start(int phase);
+
+/**
+ * @brief Stops measuring of the phase started by stats_start().
+ *
+ * @param phase One of STATS_PHASE_ identifiers.
+ * @return void.
+ */
+void stats_stop(int phase);
+
+/**
+ * @brief Adds to the counter.
+ *
+ * @param counter One of STATS_ counter identifiers.
+ * @param value Value to be added.
+ * @return void.
+ */
+void stats_count(int counter, unsigned long value);
+
+/**
+ * @brief Writes the report as a single JSON object, if measuring is enabled.
+ *
+ * @param *stream Output stream.
+ * @return void.
+ */
+void stats_report(FILE *stream);
+
+#define STATS_ENABLE() stats_enable()
+#define STATS_START(phase) stats_start(phase)
+#define STATS_STOP(phase) stats_stop(phase)
+#define STATS_COUNT(counter, value) stats_count((counter), (value))
+#define STATS_REPORT(stream) stats_report(stream)
+
+#else
+
+#define STATS_ENABLE() ((void) 0)
+#define STATS_START(phase) ((void) 0)
+#define STATS_STOP(phase) ((void) 0)
+#define STATS_COUNT(counter, value) ((void) 0)
+#define STATS_REPORT(stream) ((void) 0)
+
+#endif
+
+#endif
@@ -5,10 +5,12 @@
  *  @author Patrik Goldschmidt - xgolds00@stud.fit.vutbr.cz
  *
  *  Module provides library functions for symbol table implemented as a hash
- *  table.
+ *  table with open addressing.
  */
 
+#include "intern.h"
 #include "safe_malloc.h"
+#include "stats.h"
 #include "symtable.h"
 #include <string.h>
 #include <stdio.h>
@@ -29,67 +31,120 @@ unsigned int hash_fnv32(const char *key)
     return hash;
 }
 
-void stab_clear(symtab_t *tab)
+/*
+ * Returns index of the slot containing the interned key or index of the free
+ * slot, where the key belongs.  Table has to have slots allocated.
+ */
+static unsigned int stab_find_slot(symtab_t *tab, char *key)
+{
+   unsigned int mask = tab->size - 1;
+   unsigned int i = intern_hash(key) & mask;
+
+   /* Linear probing, interned keys are equal only if they are same pointer. */
+   while(tab->slots[i].id != NULL && tab->slots[i].id != key)
+      i = (i + 1) & mask;
+
+   return i;
+}
+
+/*
+ * Allocates twice as many slots (or initial slots) and moves all the items.
+ */
+static int stab_grow(symtab_t *tab)
 {
-   stab_item_t *item_tbd;            // Item to be deleted.
-   stab_item_t *item_next;           // Next item in the list.
+   unsigned int size = (tab->size) ? 2 * tab->size : SYMTAB_INIT_SIZE;
+   stab_slot_t *old_slots = tab->slots;
+   unsigned int old_size = tab->size;
+
+   tab->slots = scalloc(size, sizeof(stab_slot_t));
+
+   if(tab->slots == NULL)
+   {
+      tab->slots = old_slots;
+      return STAB_INSERT_FAIL;
+   }
+
+   tab->size = size;
 
-   /* Iterate through whole table and each linked list.  */
-   for(int i = 0; i < SYMTAB_SIZE; i++)
+   /* Reinsert all the items, keys are unique so no comparison is needed.  */
+   for(unsigned int i = 0; i < old_size; i++)
    {
-      /* If particular field is not empty already, clean it.   */
-      if((*tab)[i] != NULL)
+      if(old_slots[i].id != NULL)
       {
-         /* Load the first item in the list into the "next" pointer. */
-         item_next = (*tab)[i];
-
-         /* If next item exists, clean it.  */
-         while(item_next != NULL)
-         {
-            item_tbd = item_next;
-            item_next = item_tbd->item_next;
-            /*  sfree the string data.   */
-            sfree(item_tbd->data.id);
-            item_tbd->data.id = NULL;
-            sfree(item_tbd);
-         }
-
-         /* Set list root pointer to NULL after everything is sfreed. */
-         (*tab)[i] = NULL;
+         unsigned int j = intern_hash(old_slots[i].id) & (size - 1);
+
+         while(tab->slots[j].id != NULL)
+            j = (j + 1) & (size - 1);
+
+         tab->slots[j] = old_slots[i];
       }
    }
 
+   sfree(old_slots);
+
+   return STAB_INSERT_OK;
+}
+
+void stab_clear(symtab_t *tab)
+{
+   /* Free all items and set slots free.  */
+   for(unsigned int i = 0; i < tab->size && tab->count > 0; i++)
+   {
+      if(tab->slots[i].id != NULL)
+      {
+         /* String data are owned by the interning module.   */
+         sfree(tab->slots[i].item);
+         tab->slots[i].id = NULL;
+         tab->slots[i].item = NULL;
+         tab->count--;
+      }
+   }
+
+   tab->log_top = 0;
+
    return;
 }
 
 void stab_delete_symbol(symtab_t *tab, char *id)
 {
-   int index = hash_fnv32(id) % SYMTAB_SIZE;    // Index of the searched item
-   stab_item_t *item_tbd  = (*tab)[index];      // Item to be deleted
-   stab_item_t *item_prev = NULL;               // Item before the deleted one
+   char *key = intern_lookup(id);               // Interned identifier
 
-   /* Browse through the linked list and search for the key match. */
-   while(item_tbd != NULL && strcmp(item_tbd->data.id, id))
-   {
-      item_prev = item_tbd;
-      item_tbd  = item_tbd->item_next;
-   }
+   /* Identifier which has never been interned cannot be in the table.  */
+   if(key == NULL || tab->count == 0)
+      return;
+
+   unsigned int mask = tab->size - 1;
+   unsigned int i = stab_find_slot(tab, key);   // Slot to be freed
+   unsigned int j = i;                          // Currently examined slot
+
+   if(tab->slots[i].id == NULL)
+      return;
 
-   /* If the item was found - loop did not end on item_tbd == NULL.  */
-   if(item_tbd != NULL)
+   sfree(tab->slots[i].item);
+   tab->count--;
+
+   /* Shift following items of the cluster back, so no probe sequence gets
+      broken by the freed slot.  Item can fill the freed slot only if its
+      home slot does not lie cyclically between the freed and its slot.  */
+   while(1)
    {
-      /* If deleted item is 1st in the list - straightly change root ptr.  */
-      if(item_prev == NULL)
-         (*tab)[index] = item_tbd->item_next;
-      /* If deleted value is deeper in the list - change previous item link. */
-      else
-         item_prev->item_next = item_tbd->item_next;
-
-      sfree(item_tbd->data.id);
-      item_tbd->data.id = NULL;
-      sfree(item_tbd);
+      j = (j + 1) & mask;
+
+      if(tab->slots[j].id == NULL)
+         break;
+
+      unsigned int home = intern_hash(tab->slots[j].id) & mask;
+
+      if(((j - home) & mask) >= ((j - i) & mask))
+      {
+         tab->slots[i] = tab->slots[j];
+         i = j;
+      }
    }
 
+   tab->slots[i].id = NULL;
+   tab->slots[i].item = NULL;
+
    return;
 }
 
@@ -103,52 +158,57 @@ symbol_t * stab_get_data(symtab_t *tab, char *id)
 
 void stab_init(symtab_t *tab)
 {
-    memset(*tab, 0, SYMTAB_SIZE * sizeof(stab_item_t *));
+   memset(tab, 0, sizeof(symtab_t));
 
-    return;
+   return;
 }
 
 int stab_insert(symtab_t *tab, symbol_t *symbol)
 {
-    /*  Check if the symbol in the table already exists. */
-    stab_item_t *item = stab_search(tab, symbol->id);
+   /*  Check if the symbol in the table already exists. */
+   stab_item_t *item = stab_search(tab, symbol->id);
 
-    if(item != NULL)
-    {
-        /*  If the symbol in the table exists, update it.    */
-        /*  Back up old reference to the ID.    */
-        char *id_tmp = item->data.id;
+   if(item != NULL)
+   {
+      /*  If the symbol in the table exists, update it.    */
+      /*  Back up old reference to the ID.    */
+      char *id_tmp = item->data.id;
 
-        /*  Copy the contents of the input to update the one in the table.   */
-        memcpy(&item->data, symbol, sizeof(symbol_t));
-        item->data.id = id_tmp;
-    }
-    else
-    {
-        /*  If the symbol in the table does not exist, create one + check.  */
-        unsigned int index = hash_fnv32(symbol->id) % SYMTAB_SIZE;
-        /*  Create copy of the symbol identifier.   */
-        char *sym_id = smalloc(sizeof(char) * (strlen(symbol->id) + 1));
+      /*  Copy the contents of the input to update the one in the table.   */
+      memcpy(&item->data, symbol, sizeof(symbol_t));
+      item->data.id = id_tmp;
+   }
+   else
+   {
+      /*  Share the interned copy of the symbol identifier.   */
+      char *sym_id = intern_cstring(symbol->id);
 
-        if(sym_id == NULL)
-            return STAB_INSERT_FAIL;
+      if(sym_id == NULL)
+         return STAB_INSERT_FAIL;
 
-        item = smalloc(sizeof(stab_item_t));
+      /*  Grow the table if the maximal load would be exceeded.  */
+      if(100 * (tab->count + 1) > SYMTAB_MAX_LOAD * tab->size &&
+         stab_grow(tab) != STAB_INSERT_OK)
+         return STAB_INSERT_FAIL;
 
-        if(item == NULL)
-            return STAB_INSERT_FAIL;
+      item = smalloc(sizeof(stab_item_t));
 
-        strcpy(sym_id, symbol->id);
+      if(item == NULL)
+         return STAB_INSERT_FAIL;
 
-        /*  Update new item contents + insert item on the start of the list. */
-        memcpy(&item->data, symbol, sizeof(symbol_t));
-        item->data.id = sym_id;
-        item->item_next = (*tab)[index];
+      /*  Update new item contents + insert item to its free slot.  */
+      memcpy(&item->data, symbol, sizeof(symbol_t));
+      item->data.id = sym_id;
 
-        (*tab)[index] = item;
-    }
+      unsigned int i = stab_find_slot(tab, sym_id);
+
+      tab->slots[i].id = sym_id;
+      tab->slots[i].item = item;
+      tab->count++;
+      STATS_COUNT(STATS_SYMBOLS, 1);
+   }
 
-    return STAB_INSERT_OK;
+   return STAB_INSERT_OK;
 }
 
 symbol_t * stab_iterate_next(symtab_t *tab, stab_iterator_t *it)
@@ -157,29 +217,18 @@ symbol_t * stab_iterate_next(symtab_t *tab, stab_iterator_t *it)
    if(it->item == NULL)
       return NULL;
 
-   /* Otherwise, try to find next item in the current row.  */
-   if(it->item->item_next != NULL)
-   {
-      /* Next item in the current row exist. */
-      it->item = it->item->item_next;
+   /* Preemptively set item to NULL to facilitate unsuccessful search.  */
+   it->item = NULL;
 
-      return &it->item->data;
-   }
-   else
+   /* Row already points behind the current item.  */
+   for(; it->row < (int)tab->size && it->item == NULL; it->row++)
    {
-      /* There is no other item in the current row - search other rows. */
-      /* Preemptively set item to NULL to facilitate unsuccessful search.  */
-      it->item = NULL;
-      
-      for(; it->row < SYMTAB_SIZE && it->item == NULL; it->row++)
-      {
-         /* If item in the row is found -> assign it to the iterator.   */
-         if((*tab)[it->row] != NULL)
-            it->item = (*tab)[it->row];
-      }
-
-      return &it->item->data;
+      /* If item in the row is found -> assign it to the iterator.   */
+      if(tab->slots[it->row].id != NULL)
+         it->item = tab->slots[it->row].item;
    }
+
+   return (it->item) ? &it->item->data : NULL;
 }
 
 int stab_iterate_set(symtab_t *tab, stab_iterator_t *it)
@@ -189,11 +238,11 @@ int stab_iterate_set(symtab_t *tab, stab_iterator_t *it)
    it->row = 0;
 
    /* Search for the first element. */
-   for(; it->row < SYMTAB_SIZE && it->item == NULL; it->row++)
+   for(; it->row < (int)tab->size && it->item == NULL; it->row++)
    {
       /* If item in the row is found -> assign it to the iterator.   */
-      if((*tab)[it->row] != NULL)
-         it->item = (*tab)[it->row];
+      if(tab->slots[it->row].id != NULL)
+         it->item = tab->slots[it->row].item;
    }
 
    /* Check if the symtable is not empty and return based on it. */
@@ -205,16 +254,50 @@ int stab_iterate_set(symtab_t *tab, stab_iterator_t *it)
 
 stab_item_t * stab_search(symtab_t *tab, char *id)
 {
-   /* Calculate index for the searched symbol and assign value from array.   */
-   stab_item_t *item = (*tab)[hash_fnv32(id) % SYMTAB_SIZE];
+   /* Identifier which has never been interned cannot be in the table.  */
+   char *key = (tab->count) ? intern_lookup(id) : NULL;
 
-   /* Browse through the linked list and search for the match. */
-   for(; item != NULL; item = item->item_next)
+   if(key == NULL)
+      return NULL;
+
+   return tab->slots[stab_find_slot(tab, key)].item;
+}
+
+int stab_scope_log(symtab_t *tab, char *id)
+{
+   stab_item_t *item = stab_search(tab, id);
+
+   if(item == NULL)
+      return STAB_INSERT_FAIL;
+
+   /* Double the log if it is full.  */
+   if(tab->log_top == tab->log_size)
    {
-      /* If the id is matched (strcmp() == 0), break immediately.   */
-      if(!strcmp(item->data.id, id))
-         break;
+      unsigned int size = (tab->log_size) ? 2 * tab->log_size 
+                                          : SYMTAB_LOG_INIT_SIZE;
+      stab_item_t **log = srealloc(tab->log, size * sizeof(stab_item_t *));
+
+      if(log == NULL)
+         return STAB_INSERT_FAIL;
+
+      tab->log = log;
+      tab->log_size = size;
    }
 
-   return item;
+   tab->log[tab->log_top++] = item;
+
+   return STAB_INSERT_OK;
+}
+
+stab_mark_t stab_scope_mark(symtab_t *tab)
+{
+   return tab->log_top;
+}
+
+symbol_t * stab_scope_rollback(symtab_t *tab, stab_mark_t mark)
+{
+   if(tab->log_top <= mark)
+      return NULL;
+
+   return &tab->log[--tab->log_top]->data;
 }
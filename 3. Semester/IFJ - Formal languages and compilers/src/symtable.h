@@ -5,7 +5,9 @@
  *  @author Patrik Goldschmidt - xgolds00@stud.fit.vutbr.cz
  *
  *  Module provides library functions for symbol table implemented as a hash
- *  table.
+ *  table.  Identifiers are stored interned (see intern.h), therefore the
+ *  table compares keys by pointer and reuses hashes stored by the interning
+ *  module.  Module requires intern_init() to be called before its use.
  */
 
 #ifndef SYMTABLE_H_INCLUDED
@@ -36,13 +38,14 @@
  */
 #define SYMTAB_ITERATOR_NOT_SET 1
 
-/**
- *  @brief Defines symbol table size.
- *
- *  Symbol table size was chosen according to the hash algorithm performance
- *  and considering the actual symbol table and interpretation process needs.
- */
-#define SYMTAB_SIZE 300
+/** @brief Initial number of symbol table slots, has to be a power of 2.  */
+#define SYMTAB_INIT_SIZE 64
+
+/** @brief Maximal load of the symbol table in percent before it grows.  */
+#define SYMTAB_MAX_LOAD 50
+
+/** @brief Initial number of scope log entries.  */
+#define SYMTAB_LOG_INIT_SIZE 32
 
 /** @brief Defines symtab_insert() function outcodes.   */
 enum stab_insert_outcodes
@@ -52,15 +55,24 @@ enum stab_insert_outcodes
 };
 
 /*
- *  @brief Symbol table item structure.  Identifier of the symbol serves as a
- *         key to compute hashes.
+ *  @brief Symbol table item structure.  Items are allocated separately, so
+ *         pointers to their data stay valid when the table grows.
  */
 typedef struct symb_table_item
 {
    symbol_t data;                      ///< Data containing symbol_t
-   struct symb_table_item *item_next;  ///< Pointer to the next table item
 } stab_item_t;
 
+/*
+ *  @brief Symbol table slot.  Identifier of the symbol serves as a key and
+ *         is kept in the slot, so probing does not touch the items.
+ */
+typedef struct symb_table_slot
+{
+   char *id;                           ///< Interned identifier, NULL if free
+   stab_item_t *item;                  ///< Pointer to the item
+} stab_slot_t;
+
 typedef struct symb_table_iterator_handle
 {
    stab_item_t *item;                  ///< Pointer to the item to be returned
@@ -68,9 +80,26 @@ typedef struct symb_table_iterator_handle
 } stab_iterator_t;
 
 /**
- *  @brief Symbol table definition as a array of symbols.
+ *  @brief Symbol table definition as an open addressing hash table with
+ *         linear probing, which grows when SYMTAB_MAX_LOAD is exceeded.
+ *
+ *  Table also contains scope log - stack of symbols declared in the opened
+ *  blocks.  Block remembers log position by stab_scope_mark() when it is
+ *  entered and takes back its symbols by stab_scope_rollback() when it is
+ *  left, without traversing the whole table.
  */
-typedef stab_item_t *symtab_t[SYMTAB_SIZE];
+typedef struct symb_table
+{
+   stab_slot_t *slots;                 ///< Array of slots
+   unsigned int size;                  ///< Number of slots, power of 2
+   unsigned int count;                 ///< Number of stored symbols
+   stab_item_t **log;                  ///< Scope log
+   unsigned int log_top;               ///< Number of scope log entries
+   unsigned int log_size;              ///< Allocated scope log entries
+} symtab_t;
+
+/** @brief Scope log position returned by stab_scope_mark().   */
+typedef unsigned int stab_mark_t;
 
 /**
  *  @brief Calculates hash function based on FNV 32-bit algorithm.
@@ -85,7 +114,8 @@ unsigned int hash_fnv32(const char *key);
 
 /**
  *  @brief Clears the whole symbol table to its initial state correctly freeing
- *         all its elements and setting stab_item_t pointers to NULL.
+ *         all its elements and emptying the scope log.  Slots are kept for
+ *         the further use.
  *
  *  @param[in] *tab Pointer to the table of symbols.
  *  @return void.
@@ -114,7 +144,8 @@ void stab_delete_symbol(symtab_t *tab, char *id);
 symbol_t * stab_get_data(symtab_t *tab, char *id);
 
 /**
- *  @brief Initializes symbol table (Sets whole array to NULL).
+ *  @brief Initializes symbol table to an empty table.  Slots are allocated
+ *         lazily by the first insert.
  *
  *  @param[in] *tab Pointer to the symbol_t data type.
  *  @return void.
@@ -124,8 +155,8 @@ void stab_init(symtab_t *tab);
 /**
  *  @brief Inserts symbol to the symbol table.  If the symbol already exists,
  *         its content will get updated.  Function will allocate new
- *         stab_item_t data type and new C-string according to input parameter
- *         symbol.
+ *         stab_item_t data type and use interned copy of the symbol
+ *         identifier, which is shared by all tables.
  *
  *  @param[in] *tab Pointer to the table of symbols.
  *  @param[in] *symbol Pointer to allocated symbol structure.
@@ -141,6 +172,7 @@ int stab_insert(symtab_t *tab, symbol_t *symbol);
  *         though it and returning NULL at the end, when all items have been
  *         already iterated.  Function will then keep to return NULL, until
  *         reinitialized at the start of the table using stab_iterate_set().
+ *         Table must not be modified during the iteration.
  *
  * @param[in] *tab Pointer to the table of symbols.
  * @param[in] *it  Pointer to the symbol table iterator structure.
@@ -152,7 +184,7 @@ symbol_t * stab_iterate_next(symtab_t *tab, stab_iterator_t *it);
 
 /**
  *  @brief Sets the iterator on the first found item in the hash table.
- *         Searching starts at row 0 and carries on up to SYMTAB_SIZE-1.  If
+ *         Searching starts at row 0 and carries on up to the last slot.  If
  *         the desired symtable is empty, iterator structure will point to the
  *         NULL and non-0 value will be returned.  This function can also be
  *         used to reinitialize iterator after all items in the table using
@@ -176,4 +208,37 @@ int stab_iterate_set(symtab_t *tab, stab_iterator_t *it);
  */
 stab_item_t * stab_search(symtab_t *tab, char *id);
 
+/**
+ *  @brief Records declaration of the symbol in the currently opened block
+ *         into the scope log.  Symbol is returned by stab_scope_rollback()
+ *         when the block is left.  Symbol can be logged once per block.
+ *
+ *  @param[in] *tab Pointer to the table of symbols.
+ *  @param[in] *id Identifier of the already inserted symbol.
+ *  @return 0 if the operation was successful.  Not 0 if the symbol does not
+ *          exist or memory allocation fails.
+ */
+int stab_scope_log(symtab_t *tab, char *id);
+
+/**
+ *  @brief Returns the current position of the scope log, which is used as
+ *         a beginning of a newly opened block.
+ *
+ *  @param[in] *tab Pointer to the table of symbols.
+ *  @return Position of the scope log.
+ */
+stab_mark_t stab_scope_mark(symtab_t *tab);
+
+/**
+ *  @brief Removes the last symbol logged after the mark from the scope log.
+ *         Called repeatedly, it returns all symbols declared in the block in
+ *         the reverse order of their declarations.
+ *
+ *  @param[in] *tab Pointer to the table of symbols.
+ *  @param[in] mark Scope log position returned by stab_scope_mark().
+ *  @return Pointer to the symbol data or NULL if no symbol was logged after
+ *          the mark.
+ */
+symbol_t * stab_scope_rollback(symtab_t *tab, stab_mark_t mark);
+
 #endif // SYMTABLE_H_INCLUDED
\ No newline at end of file
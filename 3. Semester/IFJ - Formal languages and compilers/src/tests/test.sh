@@ -253,6 +253,19 @@ else
 echo -e ${RED}FAIL  - ${vstup} - typova konverzia !=0 =$A ${NC}
 fi
 
+vstup=code21.txt
+../prg < ./01_basic_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./01_basic_tests/code21.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} - viac ako 100 pomocnych premennych, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} - viac ako 100 pomocnych premennych, vystup !=0 =$A ${NC}
+fi
+
 
 echo ---02 Lex Testy---
 
@@ -1081,3 +1094,186 @@ echo -e ${GREEN}OK  - ${vstup} -  Chybne volanie funkcie =4${NC}
 else
 echo -e ${RED}FAIL  - ${vstup} -  Chybne volanie funkcie !=4 =$A ${NC}
 fi
+
+echo ---05 Perf Testy---
+
+vstup=code1.txt
+timeout 2 ../prg < ./05_perf_tests/${vstup} > output.code
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Hlboko vnorene cykly =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Hlboko vnorene cykly !=0 =$A ${NC}
+fi
+
+echo ---06 Optimalizacne Testy---
+
+vstup=code1.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Peephole optimalizacie =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Peephole optimalizacie !=0 =$A ${NC}
+fi
+
+vstup=code2.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Zdielanie docasnych premennych =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Zdielanie docasnych premennych !=0 =$A ${NC}
+fi
+
+vstup=code3.txt
+../prg < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Vyhodnotenie konstant =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Vyhodnotenie konstant !=0 =$A ${NC}
+fi
+
+vstup=code4.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Odstranenie mrtveho kodu =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Odstranenie mrtveho kodu !=0 =$A ${NC}
+fi
+
+vstup=code5.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Presun invariantov cyklu =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Presun invariantov cyklu !=0 =$A ${NC}
+fi
+
+vstup=code6.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Vkladanie funkcii =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Vkladanie funkcii !=0 =$A ${NC}
+fi
+
+vstup=code7.txt
+../prg -s < ./06_opt_tests/${vstup} > output.code 2> /dev/null
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Zasobnikovy backend vyrazov =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Zasobnikovy backend vyrazov !=0 =$A ${NC}
+fi
+
+vstup=code8.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code8.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Zdielanie docasnych premennych, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Zdielanie docasnych premennych, vystup !=0 =$A ${NC}
+fi
+
+vstup=code9.txt
+../prg < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code9.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Vyhodnotenie konstant, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Vyhodnotenie konstant, vystup !=0 =$A ${NC}
+fi
+
+vstup=code10.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code10.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Odstranenie mrtveho kodu, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Odstranenie mrtveho kodu, vystup !=0 =$A ${NC}
+fi
+
+vstup=code11.txt
+../prg -O < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code11.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Presun invariantov cyklu, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Presun invariantov cyklu, vystup !=0 =$A ${NC}
+fi
+
+vstup=code11.txt
+../prg -O -i 0 < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code11.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Presun invariantov cyklu bez vkladania, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Presun invariantov cyklu bez vkladania, vystup !=0 =$A ${NC}
+fi
+
+vstup=code12.txt
+../prg -O -i 32 < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code12.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Vkladanie funkcii, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Vkladanie funkcii, vystup !=0 =$A ${NC}
+fi
+
+vstup=code13.txt
+../prg -s < ./06_opt_tests/${vstup} > output.code 2> /dev/null &&
+../ifj17vm output.code < /dev/null 2> /dev/null |
+cmp -s - ./06_opt_tests/code13.out
+
+A=$?
+if [  $A = 0 ]
+then
+echo -e ${GREEN}OK  - ${vstup} -  Zasobnikovy backend vyrazov, vystup =0${NC}
+else
+echo -e ${RED}FAIL  - ${vstup} -  Zasobnikovy backend vyrazov, vystup !=0 =$A ${NC}
+fi
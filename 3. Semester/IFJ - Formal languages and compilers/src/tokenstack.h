@@ -1,13 +1,15 @@
 /**
  * @file tokenstack.h
  * @brief Specialized stack of tokens for IFJ Project 2017 AT vut.fit.vutbr.cz.
- * @date 17.11.2017, last rev. 6.12.2017
+ * @date 17.11.2017, last rev. 17.10.2026
  * @author Patrik Goldschmidt - xgolds00@stud.fit.vutbr.cz
  *
  * Module provides library functions for special stack adapted to the needs
  * of precedence syntactical analysis.  Stack is internally composed from
- * classic doubly-linked list and also provides special functions as
- * insert find top terminal or push after top terminal.
+ * a growable array of tokens and also provides special functions as
+ * insert find top terminal or push after top terminal.  Every item keeps
+ * index of the terminal closest to the top for the stack ending with it, so
+ * all operations except push after top terminal take constant time.
  */
 
 #ifndef TOKENSTACK_H_INCLUDED
@@ -30,25 +32,25 @@
 /** @brief Size of stack for preallocation.  */
 #define TSTACK_INIT_SIZ 100
 
-/** @brief Number of elements to be added to stack when it is full.  */
-#define TSTACK_MEM_CHUNK 30
+/** @brief Factor by which the stack grows when it is full.  */
+#define TSTACK_GROW_FACTOR 2
 
 typedef struct tstack_item
 {
    token_t data;
-   struct tstack_item *next;
-   struct tstack_item *prev;
+   int top_term;         ///< Index of terminal closest to this item (incl.).
 } titem;
 
 /**
- * @brief Implementation of a stack of tokens as a classic linked list.
- *        This stack implementation keeps pointer to the top terminal.
+ * @brief Implementation of a stack of tokens as a growable array.
+ *        This stack implementation keeps index of the top terminal.
  */
 typedef struct token_stack
 {
-   titem *bot;           ///< Bottom of the stack.  Always the sentinel token.
-   titem *top;           ///< Current element at the top of the stack.
-   titem *top_term;      ///< First terminal closest to the top.
+   titem *items;         ///< Stack items.  Item 0 is always the sentinel.
+   int top;              ///< Index of the element at the top of the stack.
+   int top_term;         ///< Index of the first terminal closest to the top.
+   int size;             ///< Number of allocated items.
 } tstack;
 
 /**
@@ -0,0 +1,1725 @@
+/**
+ * @file vm.c
+ * @brief IFJcode17 virtual machine for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module executes IFJcode17 produced by the compiler, see vm.h.
+ */
+
+#include "vm.h"
+#include "emit.h"
+#include "safe_malloc.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Operation codes, stack variants are shifted by VM_OP_STACK.  */
+#define VM_OP_HALT 0
+#define VM_OP_MOVE 1
+#define VM_OP_CREATEFRAME 2
+#define VM_OP_PUSHFRAME 3
+#define VM_OP_POPFRAME 4
+#define VM_OP_DEFVAR 5
+#define VM_OP_CALL 6
+#define VM_OP_RETURN 7
+#define VM_OP_PUSHS 8
+#define VM_OP_POPS 9
+#define VM_OP_CLEARS 10
+#define VM_OP_ADD 11
+#define VM_OP_SUB 12
+#define VM_OP_MUL 13
+#define VM_OP_DIV 14
+#define VM_OP_LT 15
+#define VM_OP_GT 16
+#define VM_OP_EQ 17
+#define VM_OP_AND 18
+#define VM_OP_OR 19
+#define VM_OP_NOT 20
+#define VM_OP_INT2FLOAT 21
+#define VM_OP_FLOAT2INT 22
+#define VM_OP_FLOAT2R2EINT 23
+#define VM_OP_FLOAT2R2OINT 24
+#define VM_OP_INT2CHAR 25
+#define VM_OP_STRI2INT 26
+#define VM_OP_READ 27
+#define VM_OP_WRITE 28
+#define VM_OP_CONCAT 29
+#define VM_OP_STRLEN 30
+#define VM_OP_GETCHAR 31
+#define VM_OP_SETCHAR 32
+#define VM_OP_TYPE 33
+#define VM_OP_LABEL 34
+#define VM_OP_JUMP 35
+#define VM_OP_JUMPIFEQ 36
+#define VM_OP_JUMPIFNEQ 37
+#define VM_OP_BREAK 38
+#define VM_OP_DPRINT 39
+
+/* Stack variant of an operation.  */
+#define VM_OP_STACK 64
+#define VM_OP_ADDS (VM_OP_STACK + VM_OP_ADD)
+#define VM_OP_SUBS (VM_OP_STACK + VM_OP_SUB)
+#define VM_OP_MULS (VM_OP_STACK + VM_OP_MUL)
+#define VM_OP_DIVS (VM_OP_STACK + VM_OP_DIV)
+#define VM_OP_LTS (VM_OP_STACK + VM_OP_LT)
+#define VM_OP_GTS (VM_OP_STACK + VM_OP_GT)
+#define VM_OP_EQS (VM_OP_STACK + VM_OP_EQ)
+#define VM_OP_ANDS (VM_OP_STACK + VM_OP_AND)
+#define VM_OP_ORS (VM_OP_STACK + VM_OP_OR)
+#define VM_OP_NOTS (VM_OP_STACK + VM_OP_NOT)
+#define VM_OP_INT2FLOATS (VM_OP_STACK + VM_OP_INT2FLOAT)
+#define VM_OP_FLOAT2INTS (VM_OP_STACK + VM_OP_FLOAT2INT)
+#define VM_OP_FLOAT2R2EINTS (VM_OP_STACK + VM_OP_FLOAT2R2EINT)
+#define VM_OP_FLOAT2R2OINTS (VM_OP_STACK + VM_OP_FLOAT2R2OINT)
+#define VM_OP_INT2CHARS (VM_OP_STACK + VM_OP_INT2CHAR)
+#define VM_OP_STRI2INTS (VM_OP_STACK + VM_OP_STRI2INT)
+#define VM_OP_JUMPIFEQS (VM_OP_STACK + VM_OP_JUMPIFEQ)
+#define VM_OP_JUMPIFNEQS (VM_OP_STACK + VM_OP_JUMPIFNEQ)
+
+/* Number of operation codes.  */
+#define VM_OP_COUNT (2 * VM_OP_STACK)
+
+/* Kinds of operands.  */
+#define VM_ARG_NONE 0
+#define VM_ARG_CONST 1
+#define VM_ARG_GF 2
+#define VM_ARG_LF 3
+#define VM_ARG_TF 4
+#define VM_ARG_LABEL 5
+#define VM_ARG_TYPE 6
+
+/* Operands expected by the operations.  */
+#define VM_PAT_NONE 0
+#define VM_PAT_VAR 1
+#define VM_PAT_SYMB 2
+#define VM_PAT_LABEL 3
+#define VM_PAT_TYPE 4
+
+/* Header of the program.  */
+#define VM_HEADER ".IFJcode17"
+
+/* Maximal number of words on a line, the operation and three operands.  */
+#define VM_MAX_WORDS 4
+
+/* Use computed goto, where the compiler supports it.  */
+#if defined(__GNUC__) && !defined(VM_NO_THREADING)
+#define VM_THREADED
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+/** @brief Operation with its textual name and operands.  */
+typedef struct vm_opcode
+{
+   const char *name;          ///< Name of the operation.
+   int args[3];               ///< Expected operands.
+} vm_opcode_t;
+
+/** @brief Run time state of the machine.  */
+typedef struct vm_state
+{
+   vm_value_t *stack;         ///< Data stack.
+   int stack_count;           ///< Number of values on the data stack.
+   int stack_size;            ///< Allocated size of the data stack.
+   int *calls;                ///< Call stack of return positions.
+   int calls_count;           ///< Number of positions on the call stack.
+   int calls_size;            ///< Allocated size of the call stack.
+   vm_value_t *globals;       ///< Global frame indexed by the slot.
+   bool *defined;             ///< Defined variables of the global frame.
+   int *live;                 ///< Number of frames defining every local name.
+   vm_frame_t *tf;            ///< Temporary frame.
+   vm_frame_t *lf;            ///< Top of the stack of local frames.
+   vm_frame_t *unused;        ///< Free list of frames.
+   FILE *input;               ///< Input of READ.
+   char *line;                ///< Buffer for the input line.
+   size_t line_size;          ///< Allocated size of the line buffer.
+   int error;                 ///< Error code of the failed instruction.
+} vm_state_t;
+
+/** @brief Names and operands of the operations.  */
+static const vm_opcode_t vm_opcodes[VM_OP_COUNT] =
+{
+   [VM_OP_MOVE] = {"MOVE", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_CREATEFRAME] = {"CREATEFRAME", {0}},
+   [VM_OP_PUSHFRAME] = {"PUSHFRAME", {0}},
+   [VM_OP_POPFRAME] = {"POPFRAME", {0}},
+   [VM_OP_DEFVAR] = {"DEFVAR", {VM_PAT_VAR}},
+   [VM_OP_CALL] = {"CALL", {VM_PAT_LABEL}},
+   [VM_OP_RETURN] = {"RETURN", {0}},
+   [VM_OP_PUSHS] = {"PUSHS", {VM_PAT_SYMB}},
+   [VM_OP_POPS] = {"POPS", {VM_PAT_VAR}},
+   [VM_OP_CLEARS] = {"CLEARS", {0}},
+   [VM_OP_ADD] = {"ADD", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_SUB] = {"SUB", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_MUL] = {"MUL", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_DIV] = {"DIV", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_LT] = {"LT", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_GT] = {"GT", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_EQ] = {"EQ", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_AND] = {"AND", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_OR] = {"OR", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_NOT] = {"NOT", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_INT2FLOAT] = {"INT2FLOAT", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_FLOAT2INT] = {"FLOAT2INT", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_FLOAT2R2EINT] = {"FLOAT2R2EINT", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_FLOAT2R2OINT] = {"FLOAT2R2OINT", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_INT2CHAR] = {"INT2CHAR", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_STRI2INT] = {"STRI2INT", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_READ] = {"READ", {VM_PAT_VAR, VM_PAT_TYPE}},
+   [VM_OP_WRITE] = {"WRITE", {VM_PAT_SYMB}},
+   [VM_OP_CONCAT] = {"CONCAT", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_STRLEN] = {"STRLEN", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_GETCHAR] = {"GETCHAR", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_SETCHAR] = {"SETCHAR", {VM_PAT_VAR, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_TYPE] = {"TYPE", {VM_PAT_VAR, VM_PAT_SYMB}},
+   [VM_OP_LABEL] = {"LABEL", {VM_PAT_LABEL}},
+   [VM_OP_JUMP] = {"JUMP", {VM_PAT_LABEL}},
+   [VM_OP_JUMPIFEQ] = {"JUMPIFEQ", {VM_PAT_LABEL, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_JUMPIFNEQ] = {"JUMPIFNEQ", {VM_PAT_LABEL, VM_PAT_SYMB, VM_PAT_SYMB}},
+   [VM_OP_BREAK] = {"BREAK", {0}},
+   [VM_OP_DPRINT] = {"DPRINT", {VM_PAT_SYMB}},
+   [VM_OP_ADDS] = {"ADDS", {0}},
+   [VM_OP_SUBS] = {"SUBS", {0}},
+   [VM_OP_MULS] = {"MULS", {0}},
+   [VM_OP_DIVS] = {"DIVS", {0}},
+   [VM_OP_LTS] = {"LTS", {0}},
+   [VM_OP_GTS] = {"GTS", {0}},
+   [VM_OP_EQS] = {"EQS", {0}},
+   [VM_OP_ANDS] = {"ANDS", {0}},
+   [VM_OP_ORS] = {"ORS", {0}},
+   [VM_OP_NOTS] = {"NOTS", {0}},
+   [VM_OP_INT2FLOATS] = {"INT2FLOATS", {0}},
+   [VM_OP_FLOAT2INTS] = {"FLOAT2INTS", {0}},
+   [VM_OP_FLOAT2R2EINTS] = {"FLOAT2R2EINTS", {0}},
+   [VM_OP_FLOAT2R2OINTS] = {"FLOAT2R2OINTS", {0}},
+   [VM_OP_INT2CHARS] = {"INT2CHARS", {0}},
+   [VM_OP_STRI2INTS] = {"STRI2INTS", {0}},
+   [VM_OP_JUMPIFEQS] = {"JUMPIFEQS", {VM_PAT_LABEL}},
+   [VM_OP_JUMPIFNEQS] = {"JUMPIFNEQS", {VM_PAT_LABEL}}
+};
+
+/** @brief Names of the types printed by TYPE, indexed by VM_TYPE_.  */
+static const char *vm_type_names[] = {"", "int", "float", "string", "bool"};
+
+/*
+ * Compares strings case insensitively.
+ */
+static bool vm_equal_nocase(const char *str1, const char *str2)
+{
+   while(*str1 != '\0' &&
+         tolower((unsigned char) *str1) == tolower((unsigned char) *str2))
+   {
+      str1++;
+      str2++;
+   }
+
+   return *str1 == '\0' && *str2 == '\0';
+}
+
+/*
+ * FNV-1a hash of the string.
+ */
+static unsigned vm_hash(const char *str)
+{
+   unsigned hash = 2166136261u;
+
+   while(*str != '\0')
+   {
+      hash ^= (unsigned char) *str++;
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+/*
+ * Returns number of the name, new names get the next free number.  Returns
+ * -1 on allocation error.
+ */
+static int vm_name_id(vm_names_t *names, const char *name)
+{
+   /* Table is kept at most half full.  */
+   if(2 * (names->count + 1) > names->size)
+   {
+      int size = (names->size == 0) ? VM_INIT_SIZ : 2 * names->size;
+      char **keys = scalloc(size, sizeof(char *));
+      int *ids = smalloc(size * sizeof(int));
+
+      if(keys == NULL || ids == NULL)
+      {
+         sfree(keys);
+         sfree(ids);
+         return -1;
+      }
+
+      for(int i = 0; i < names->size; i++)
+      {
+         if(names->keys[i] == NULL)
+            continue;
+
+         unsigned pos = vm_hash(names->keys[i]) & (size - 1);
+         while(keys[pos] != NULL)
+            pos = (pos + 1) & (size - 1);
+
+         keys[pos] = names->keys[i];
+         ids[pos] = names->ids[i];
+      }
+
+      sfree(names->keys);
+      sfree(names->ids);
+      names->keys = keys;
+      names->ids = ids;
+      names->size = size;
+   }
+
+   unsigned pos = vm_hash(name) & (names->size - 1);
+   while(names->keys[pos] != NULL)
+   {
+      if(!strcmp(names->keys[pos], name))
+         return names->ids[pos];
+
+      pos = (pos + 1) & (names->size - 1);
+   }
+
+   names->keys[pos] = smalloc(strlen(name) + 1);
+   if(names->keys[pos] == NULL)
+      return -1;
+
+   strcpy(names->keys[pos], name);
+   names->ids[pos] = names->count;
+
+   return names->count++;
+}
+
+/*
+ * Frees the table of names.
+ */
+static void vm_names_free(vm_names_t *names)
+{
+   for(int i = 0; i < names->size; i++)
+      sfree(names->keys[i]);
+
+   sfree(names->keys);
+   sfree(names->ids);
+   memset(names, 0, sizeof(vm_names_t));
+}
+
+/*
+ * Allocates string of the given length with one reference.
+ */
+static vm_string_t *vm_string_new(unsigned len)
+{
+   vm_string_t *str = smalloc(sizeof(vm_string_t) + len + 1);
+
+   if(str != NULL)
+   {
+      str->refs = 1;
+      str->len = len;
+      str->data[len] = '\0';
+   }
+
+   return str;
+}
+
+/*
+ * Takes a new reference to the value.
+ */
+static inline void vm_retain(vm_value_t *value)
+{
+   if(value->type == VM_TYPE_STRING)
+      value->v.s->refs++;
+}
+
+/*
+ * Drops the reference to the value.
+ */
+static inline void vm_release(vm_value_t *value)
+{
+   if(value->type == VM_TYPE_STRING && --value->v.s->refs == 0)
+      sfree(value->v.s);
+}
+
+/*
+ * Stores the value to the slot, the slot takes over the reference.
+ */
+static inline void vm_store(vm_value_t *slot, vm_value_t *value)
+{
+   vm_release(slot);
+   *slot = *value;
+}
+
+/*
+ * Decodes the string constant with \ddd escape sequences.
+ */
+static vm_string_t *vm_parse_string(const char *text)
+{
+   vm_string_t *str = vm_string_new(strlen(text));
+   unsigned len = 0;
+
+   if(str == NULL)
+      return NULL;
+
+   while(*text != '\0')
+   {
+      if(*text != '\\')
+      {
+         str->data[len++] = *text++;
+         continue;
+      }
+
+      if(!isdigit((unsigned char) text[1]) ||
+         !isdigit((unsigned char) text[2]) ||
+         !isdigit((unsigned char) text[3]))
+      {
+         sfree(str);
+         return NULL;
+      }
+
+      int code = (text[1] - '0') * 100 + (text[2] - '0') * 10 + text[3] - '0';
+      if(code > UCHAR_MAX)
+      {
+         sfree(str);
+         return NULL;
+      }
+
+      str->data[len++] = (char) code;
+      text += 4;
+   }
+
+   str->len = len;
+   str->data[len] = '\0';
+
+   return str;
+}
+
+/*
+ * Parses a constant operand.  Returns VM_SUCCESS or an error code.
+ */
+static int vm_parse_const(char *word, vm_value_t *value)
+{
+   char *end;
+
+   if(!strncmp(word, "int@", 4))
+   {
+      errno = 0;
+      long number = strtol(word + 4, &end, 10);
+      if(word[4] == '\0' || *end != '\0' || errno == ERANGE ||
+         number < INT_MIN || number > INT_MAX)
+         return VM_ERR_SYNTAX;
+
+      value->type = VM_TYPE_INT;
+      value->v.i = (int) number;
+   }
+   else if(!strncmp(word, "float@", 6))
+   {
+      value->v.f = strtod(word + 6, &end);
+      if(word[6] == '\0' || *end != '\0')
+         return VM_ERR_SYNTAX;
+
+      value->type = VM_TYPE_FLOAT;
+   }
+   else if(!strncmp(word, "bool@", 5))
+   {
+      if(strcmp(word + 5, "true") && strcmp(word + 5, "false"))
+         return VM_ERR_SYNTAX;
+
+      value->type = VM_TYPE_BOOL;
+      value->v.b = !strcmp(word + 5, "true");
+   }
+   else if(!strncmp(word, "string@", 7))
+   {
+      value->v.s = vm_parse_string(word + 7);
+      if(value->v.s == NULL)
+         return VM_ERR_SYNTAX;
+
+      value->type = VM_TYPE_STRING;
+   }
+   else
+      return VM_ERR_SYNTAX;
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Parses the operand expected by the pattern.  Returns VM_SUCCESS or an
+ * error code.
+ */
+static int vm_parse_arg(vm_program_t *program, char *word, int pattern,
+                        vm_arg_t *arg)
+{
+   if(pattern == VM_PAT_LABEL)
+   {
+      arg->kind = VM_ARG_LABEL;
+      arg->id = vm_name_id(&program->labels, word);
+      return (arg->id < 0) ? VM_ERR_INTERNAL : VM_SUCCESS;
+   }
+
+   if(pattern == VM_PAT_TYPE)
+   {
+      arg->kind = VM_ARG_TYPE;
+      for(arg->id = VM_TYPE_INT; arg->id <= VM_TYPE_BOOL; arg->id++)
+      {
+         if(!strcmp(word, vm_type_names[arg->id]))
+            return VM_SUCCESS;
+      }
+
+      return VM_ERR_SYNTAX;
+   }
+
+   /* Variable of one of the frames.  */
+   if((!strncmp(word, "GF@", 3) || !strncmp(word, "LF@", 3) ||
+       !strncmp(word, "TF@", 3)) && word[3] != '\0')
+   {
+      if(word[0] == 'G')
+      {
+         arg->kind = VM_ARG_GF;
+         arg->id = vm_name_id(&program->globals, word + 3);
+      }
+      else
+      {
+         arg->kind = (word[0] == 'L') ? VM_ARG_LF : VM_ARG_TF;
+         arg->id = vm_name_id(&program->locals, word + 3);
+      }
+
+      return (arg->id < 0) ? VM_ERR_INTERNAL : VM_SUCCESS;
+   }
+
+   if(pattern == VM_PAT_VAR)
+      return VM_ERR_SYNTAX;
+
+   arg->kind = VM_ARG_CONST;
+   return vm_parse_const(word, &arg->value);
+}
+
+/*
+ * Appends the instruction to the program.
+ */
+static int vm_append(vm_program_t *program, vm_instr_t *instr)
+{
+   if(program->count == program->size)
+   {
+      int size = (program->size == 0) ? VM_INIT_SIZ : 2 * program->size;
+      vm_instr_t *code = srealloc(program->code, size * sizeof(vm_instr_t));
+
+      if(code == NULL)
+         return VM_ERR_INTERNAL;
+
+      program->code = code;
+      program->size = size;
+   }
+
+   program->code[program->count++] = *instr;
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Defines the label on the position of the next instruction.
+ */
+static int vm_define_label(vm_program_t *program, int id)
+{
+   if(id >= program->targets_size)
+   {
+      int *targets = srealloc(program->targets,
+                              program->labels.size * sizeof(int));
+      if(targets == NULL)
+         return VM_ERR_INTERNAL;
+
+      for(int i = program->targets_size; i < program->labels.size; i++)
+         targets[i] = -1;
+      program->targets = targets;
+      program->targets_size = program->labels.size;
+   }
+
+   if(program->targets[id] >= 0)
+      return VM_ERR_SEMANTIC;
+
+   program->targets[id] = program->count;
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Parses one line of the program split into words.
+ */
+static int vm_parse_line(vm_program_t *program, char **words, int count,
+                         int line)
+{
+   vm_instr_t instr;
+   int op;
+
+   memset(&instr, 0, sizeof(vm_instr_t));
+   instr.line = line;
+
+   for(op = 1; op < VM_OP_COUNT; op++)
+   {
+      if(vm_opcodes[op].name != NULL &&
+         vm_equal_nocase(vm_opcodes[op].name, words[0]))
+         break;
+   }
+
+   if(op == VM_OP_COUNT)
+      return VM_ERR_SYNTAX;
+
+   instr.op = op;
+   for(int i = 0; i < 3; i++)
+   {
+      if((vm_opcodes[op].args[i] == VM_PAT_NONE) != (i + 1 >= count))
+         return VM_ERR_SYNTAX;
+
+      if(vm_opcodes[op].args[i] == VM_PAT_NONE)
+         continue;
+
+      int result = vm_parse_arg(program, words[i + 1],
+                                vm_opcodes[op].args[i], &instr.args[i]);
+      if(result != VM_SUCCESS)
+         return result;
+   }
+
+   /* Labels are not executed, they only mark the next instruction.  */
+   if(op == VM_OP_LABEL)
+      return vm_define_label(program, instr.args[0].id);
+
+   return vm_append(program, &instr);
+}
+
+/*
+ * Reads whole stream into a NUL terminated buffer.
+ */
+static char *vm_read_all(FILE *source)
+{
+   size_t size = VM_INIT_SIZ * 1024;
+   size_t len = 0;
+   char *text = smalloc(size);
+
+   while(text != NULL)
+   {
+      len += fread(text + len, 1, size - len - 1, source);
+      if(len < size - 1)
+         break;
+
+      char *bigger = srealloc(text, 2 * size);
+      if(bigger == NULL)
+         sfree(text);
+
+      text = bigger;
+      size *= 2;
+   }
+
+   if(text != NULL)
+      text[len] = '\0';
+
+   return text;
+}
+
+int vm_load(vm_program_t *program, FILE *source)
+{
+   int result = VM_SUCCESS;
+   bool header = false;
+   int line = 0;
+
+   memset(program, 0, sizeof(vm_program_t));
+
+   char *text = vm_read_all(source);
+   if(text == NULL)
+      return VM_ERR_INTERNAL;
+
+   for(char *pos = text; *pos != '\0' && result == VM_SUCCESS; )
+   {
+      char *words[VM_MAX_WORDS + 1];
+      int count = 0;
+      char *end = strchr(pos, '\n');
+      char *next = (end == NULL) ? pos + strlen(pos) : end + 1;
+
+      line++;
+      if(end != NULL)
+         *end = '\0';
+
+      char *comment = strchr(pos, '#');
+      if(comment != NULL)
+         *comment = '\0';
+
+      /* Split the line into words.  */
+      while(count <= VM_MAX_WORDS)
+      {
+         while(isspace((unsigned char) *pos))
+            pos++;
+         if(*pos == '\0')
+            break;
+
+         words[count++] = pos;
+         while(*pos != '\0' && !isspace((unsigned char) *pos))
+            pos++;
+         if(*pos != '\0')
+            *pos++ = '\0';
+      }
+      pos = next;
+
+      if(count == 0)
+         continue;
+
+      if(count > VM_MAX_WORDS)
+         result = VM_ERR_SYNTAX;
+      else if(!header)
+      {
+         header = true;
+         if(count != 1 || !vm_equal_nocase(VM_HEADER, words[0]))
+            result = VM_ERR_SYNTAX;
+      }
+      else
+         result = vm_parse_line(program, words, count, line);
+   }
+
+   sfree(text);
+
+   if(result == VM_SUCCESS && !header)
+      result = VM_ERR_SYNTAX;
+
+   /* Instruction after the last one stops the run.  */
+   if(result == VM_SUCCESS)
+   {
+      vm_instr_t halt;
+
+      memset(&halt, 0, sizeof(vm_instr_t));
+      halt.op = VM_OP_HALT;
+      halt.line = line;
+      result = vm_append(program, &halt);
+   }
+
+   /* Resolve labels to instruction indices.  */
+   for(int i = 0; i < program->count && result == VM_SUCCESS; i++)
+   {
+      vm_arg_t *arg = &program->code[i].args[0];
+
+      if(arg->kind != VM_ARG_LABEL)
+         continue;
+
+      if(arg->id >= program->targets_size || program->targets[arg->id] < 0)
+      {
+         result = VM_ERR_SEMANTIC;
+         line = program->code[i].line;
+      }
+      else
+         arg->id = program->targets[arg->id];
+   }
+
+   if(result != VM_SUCCESS)
+      program->error_line = line;
+
+   return result;
+}
+
+/*
+ * Takes a frame from the free list or allocates a new one.
+ */
+static vm_frame_t *vm_frame_new(vm_state_t *state)
+{
+   vm_frame_t *frame = state->unused;
+
+   if(frame != NULL)
+      state->unused = frame->next;
+   else
+   {
+      frame = scalloc(1, sizeof(vm_frame_t));
+      if(frame == NULL)
+         return NULL;
+   }
+
+   frame->count = 0;
+   frame->next = NULL;
+
+   return frame;
+}
+
+/*
+ * Releases variables of the frame and moves it to the free list.
+ */
+static void vm_frame_drop(vm_state_t *state, vm_frame_t *frame)
+{
+   if(frame == NULL)
+      return;
+
+   for(int i = 0; i < frame->count; i++)
+   {
+      vm_release(&frame->values[i]);
+      state->live[frame->ids[i]]--;
+   }
+
+   frame->next = state->unused;
+   state->unused = frame;
+}
+
+/*
+ * Frees the frames of the list.
+ */
+static void vm_frame_free(vm_frame_t *frame)
+{
+   while(frame != NULL)
+   {
+      vm_frame_t *next = frame->next;
+
+      sfree(frame->ids);
+      sfree(frame->values);
+      sfree(frame);
+      frame = next;
+   }
+}
+
+/*
+ * Finds variable of the operand in the frame, the position is tried first.
+ */
+static inline vm_value_t *vm_frame_find(vm_frame_t *frame, vm_arg_t *arg)
+{
+   if(arg->slot < frame->count && frame->ids[arg->slot] == arg->id)
+      return &frame->values[arg->slot];
+
+   for(int i = frame->count - 1; i >= 0; i--)
+   {
+      if(frame->ids[i] == arg->id)
+      {
+         arg->slot = i;
+         return &frame->values[i];
+      }
+   }
+
+   return NULL;
+}
+
+/*
+ * Returns frame of the operand or NULL.
+ */
+static inline vm_frame_t *vm_frame_of(vm_state_t *state, vm_arg_t *arg)
+{
+   return (arg->kind == VM_ARG_LF) ? state->lf : state->tf;
+}
+
+/*
+ * Returns slot of the variable, which can have no value yet.  Returns NULL
+ * and sets the error if the variable does not exist.
+ */
+static inline vm_value_t *vm_var(vm_state_t *state, vm_arg_t *arg)
+{
+   vm_value_t *value;
+
+   if(arg->kind == VM_ARG_GF)
+   {
+      if(!state->defined[arg->id])
+      {
+         state->error = VM_ERR_VARIABLE;
+         return NULL;
+      }
+
+      return &state->globals[arg->id];
+   }
+
+   vm_frame_t *frame = vm_frame_of(state, arg);
+   if(frame == NULL)
+   {
+      state->error = VM_ERR_FRAME;
+      return NULL;
+   }
+
+   value = vm_frame_find(frame, arg);
+   if(value == NULL)
+      state->error = VM_ERR_VARIABLE;
+
+   return value;
+}
+
+/*
+ * Returns value of the symbol.  Returns NULL and sets the error if the
+ * variable does not exist or has no value.
+ */
+static inline vm_value_t *vm_symb(vm_state_t *state, vm_arg_t *arg)
+{
+   if(arg->kind == VM_ARG_CONST)
+      return &arg->value;
+
+   vm_value_t *value = vm_var(state, arg);
+   if(value != NULL && value->type == VM_TYPE_NONE)
+   {
+      state->error = VM_ERR_VALUE;
+      return NULL;
+   }
+
+   return value;
+}
+
+/*
+ * Defines the variable of the operand.
+ */
+static int vm_defvar(vm_state_t *state, vm_arg_t *arg)
+{
+   if(arg->kind == VM_ARG_GF)
+   {
+      if(state->defined[arg->id])
+         return VM_ERR_SEMANTIC;
+
+      state->defined[arg->id] = true;
+      state->globals[arg->id].type = VM_TYPE_NONE;
+      return VM_SUCCESS;
+   }
+
+   vm_frame_t *frame = vm_frame_of(state, arg);
+   if(frame == NULL)
+      return VM_ERR_FRAME;
+
+   /* Name which is not defined in any frame needs no search.  */
+   if(state->live[arg->id] > 0 && vm_frame_find(frame, arg) != NULL)
+      return VM_ERR_SEMANTIC;
+
+   if(frame->count == frame->size)
+   {
+      int size = (frame->size == 0) ? VM_INIT_SIZ : 2 * frame->size;
+      int *ids = srealloc(frame->ids, size * sizeof(int));
+
+      if(ids == NULL)
+         return VM_ERR_INTERNAL;
+      frame->ids = ids;
+
+      vm_value_t *values = srealloc(frame->values, size * sizeof(vm_value_t));
+      if(values == NULL)
+         return VM_ERR_INTERNAL;
+      frame->values = values;
+
+      frame->size = size;
+   }
+
+   arg->slot = frame->count;
+   frame->ids[frame->count] = arg->id;
+   frame->values[frame->count].type = VM_TYPE_NONE;
+   frame->count++;
+   state->live[arg->id]++;
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Pushes the value to the data stack, the stack takes over the reference.
+ */
+static int vm_push(vm_state_t *state, vm_value_t *value)
+{
+   if(state->stack_count == state->stack_size)
+   {
+      int size = 2 * state->stack_size;
+      vm_value_t *stack = srealloc(state->stack, size * sizeof(vm_value_t));
+
+      if(stack == NULL)
+         return VM_ERR_INTERNAL;
+
+      state->stack = stack;
+      state->stack_size = size;
+   }
+
+   state->stack[state->stack_count++] = *value;
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Arithmetic operation, integers wrap around on overflow.
+ */
+static int vm_arith(int op, vm_value_t *a, vm_value_t *b, vm_value_t *result)
+{
+   if(a->type != b->type ||
+      (a->type != VM_TYPE_INT && a->type != VM_TYPE_FLOAT))
+      return VM_ERR_OPERAND;
+
+   result->type = a->type;
+   if(a->type == VM_TYPE_INT)
+   {
+      unsigned x = a->v.i;
+      unsigned y = b->v.i;
+
+      if(op == VM_OP_ADD)
+         result->v.i = (int) (x + y);
+      else if(op == VM_OP_SUB)
+         result->v.i = (int) (x - y);
+      else if(op == VM_OP_MUL)
+         result->v.i = (int) (x * y);
+      else
+         return VM_ERR_OPERAND;
+   }
+   else
+   {
+      if(op == VM_OP_ADD)
+         result->v.f = a->v.f + b->v.f;
+      else if(op == VM_OP_SUB)
+         result->v.f = a->v.f - b->v.f;
+      else if(op == VM_OP_MUL)
+         result->v.f = a->v.f * b->v.f;
+      else if(b->v.f == 0.0)
+         return VM_ERR_ZERO_DIV;
+      else
+         result->v.f = a->v.f / b->v.f;
+   }
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Compares values of the same type, returns negative, zero or positive
+ * number as strcmp().
+ */
+static int vm_compare(vm_value_t *a, vm_value_t *b)
+{
+   switch(a->type)
+   {
+      case VM_TYPE_INT:
+         return (a->v.i > b->v.i) - (a->v.i < b->v.i);
+      case VM_TYPE_FLOAT:
+         return (a->v.f > b->v.f) - (a->v.f < b->v.f);
+      case VM_TYPE_BOOL:
+         return a->v.b - b->v.b;
+      default:
+      {
+         unsigned len = (a->v.s->len < b->v.s->len) ? a->v.s->len :
+                                                      b->v.s->len;
+         int diff = memcmp(a->v.s->data, b->v.s->data, len);
+
+         if(diff != 0)
+            return diff;
+         return (a->v.s->len > b->v.s->len) - (a->v.s->len < b->v.s->len);
+      }
+   }
+}
+
+/*
+ * Relational operation LT, GT or EQ.
+ */
+static int vm_relation(int op, vm_value_t *a, vm_value_t *b,
+                       vm_value_t *result)
+{
+   if(a->type != b->type)
+      return VM_ERR_OPERAND;
+
+   int diff = vm_compare(a, b);
+
+   result->type = VM_TYPE_BOOL;
+   if(op == VM_OP_LT)
+      result->v.b = diff < 0;
+   else if(op == VM_OP_GT)
+      result->v.b = diff > 0;
+   else
+   {
+      /* NaN is not equal to itself.  */
+      result->v.b = (a->type == VM_TYPE_FLOAT) ? a->v.f == b->v.f : diff == 0;
+   }
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Logical operation AND or OR.
+ */
+static int vm_logic(int op, vm_value_t *a, vm_value_t *b, vm_value_t *result)
+{
+   if(a->type != VM_TYPE_BOOL || b->type != VM_TYPE_BOOL)
+      return VM_ERR_OPERAND;
+
+   result->type = VM_TYPE_BOOL;
+   result->v.b = (op == VM_OP_AND) ? (a->v.b && b->v.b) : (a->v.b || b->v.b);
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Unary operation NOT or one of the conversions.
+ */
+static int vm_unary(int op, vm_value_t *a, vm_value_t *result)
+{
+   double rounded;
+
+   switch(op)
+   {
+      case VM_OP_NOT:
+         if(a->type != VM_TYPE_BOOL)
+            return VM_ERR_OPERAND;
+
+         result->type = VM_TYPE_BOOL;
+         result->v.b = !a->v.b;
+         return VM_SUCCESS;
+      case VM_OP_INT2FLOAT:
+         if(a->type != VM_TYPE_INT)
+            return VM_ERR_OPERAND;
+
+         result->type = VM_TYPE_FLOAT;
+         result->v.f = a->v.i;
+         return VM_SUCCESS;
+      case VM_OP_INT2CHAR:
+         if(a->type != VM_TYPE_INT)
+            return VM_ERR_OPERAND;
+         if(a->v.i < 0 || a->v.i > UCHAR_MAX)
+            return VM_ERR_STRING;
+
+         result->type = VM_TYPE_STRING;
+         result->v.s = vm_string_new(1);
+         if(result->v.s == NULL)
+            return VM_ERR_INTERNAL;
+
+         result->v.s->data[0] = (char) a->v.i;
+         return VM_SUCCESS;
+      default:
+         break;
+   }
+
+   if(a->type != VM_TYPE_FLOAT)
+      return VM_ERR_OPERAND;
+
+   /* Default rounding mode of nearbyint() rounds half to even.  */
+   if(op == VM_OP_FLOAT2INT)
+      rounded = trunc(a->v.f);
+   else if(op == VM_OP_FLOAT2R2EINT)
+      rounded = nearbyint(a->v.f);
+   else
+      rounded = round(a->v.f);
+
+   if(!(rounded >= INT_MIN && rounded <= INT_MAX))
+      return VM_ERR_OPERAND;
+
+   result->type = VM_TYPE_INT;
+   result->v.i = (int) rounded;
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Returns code of the character of the string on the position.
+ */
+static int vm_stri2int(vm_value_t *a, vm_value_t *b, vm_value_t *result)
+{
+   if(a->type != VM_TYPE_STRING || b->type != VM_TYPE_INT)
+      return VM_ERR_OPERAND;
+   if(b->v.i < 0 || (unsigned) b->v.i >= a->v.s->len)
+      return VM_ERR_STRING;
+
+   result->type = VM_TYPE_INT;
+   result->v.i = (unsigned char) a->v.s->data[b->v.i];
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Binary operation of the stack variant of the operation.
+ */
+static int vm_binary(int op, vm_value_t *a, vm_value_t *b, vm_value_t *result)
+{
+   switch(op)
+   {
+      case VM_OP_ADD:
+      case VM_OP_SUB:
+      case VM_OP_MUL:
+      case VM_OP_DIV:
+         return vm_arith(op, a, b, result);
+      case VM_OP_LT:
+      case VM_OP_GT:
+      case VM_OP_EQ:
+         return vm_relation(op, a, b, result);
+      case VM_OP_AND:
+      case VM_OP_OR:
+         return vm_logic(op, a, b, result);
+      default:
+         return vm_stri2int(a, b, result);
+   }
+}
+
+/*
+ * Reads one line of the input without the line end into the state buffer.
+ * Returns length of the line or -1 on allocation error.
+ */
+static long vm_read_line(vm_state_t *state)
+{
+   size_t len = 0;
+   int c;
+
+   while((c = getc(state->input)) != EOF && c != '\n')
+   {
+      if(len + 1 >= state->line_size)
+      {
+         size_t size = (state->line_size == 0) ? VM_INIT_SIZ :
+                                                 2 * state->line_size;
+         char *line = srealloc(state->line, size);
+
+         if(line == NULL)
+            return -1;
+
+         state->line = line;
+         state->line_size = size;
+      }
+
+      state->line[len++] = (char) c;
+   }
+
+   if(state->line == NULL)
+   {
+      state->line = smalloc(VM_INIT_SIZ);
+      if(state->line == NULL)
+         return -1;
+      state->line_size = VM_INIT_SIZ;
+   }
+   state->line[len] = '\0';
+
+   return (long) len;
+}
+
+/*
+ * Determines if the rest of the string is only white space.
+ */
+static bool vm_only_space(const char *str)
+{
+   while(isspace((unsigned char) *str))
+      str++;
+
+   return *str == '\0';
+}
+
+/*
+ * READ instruction, invalid input gives the default value of the type.
+ */
+static int vm_read(vm_state_t *state, int type, vm_value_t *result)
+{
+   long len = vm_read_line(state);
+   char *line = state->line;
+   char *end;
+
+   if(len < 0)
+      return VM_ERR_INTERNAL;
+
+   result->type = type;
+   if(type == VM_TYPE_STRING)
+   {
+      result->v.s = vm_string_new(len);
+      if(result->v.s == NULL)
+         return VM_ERR_INTERNAL;
+
+      memcpy(result->v.s->data, line, len);
+      return VM_SUCCESS;
+   }
+
+   while(isspace((unsigned char) *line))
+      line++;
+
+   if(type == VM_TYPE_INT)
+   {
+      errno = 0;
+      long number = strtol(line, &end, 10);
+
+      result->v.i = (end != line && vm_only_space(end) && errno == 0 &&
+                     number >= INT_MIN && number <= INT_MAX) ? (int) number : 0;
+   }
+   else if(type == VM_TYPE_FLOAT)
+   {
+      double number = strtod(line, &end);
+
+      result->v.f = (end != line && vm_only_space(end)) ? number : 0.0;
+   }
+   else
+   {
+      end = line + strlen(line);
+      while(end > line && isspace((unsigned char) end[-1]))
+         *--end = '\0';
+
+      result->v.b = vm_equal_nocase("true", line);
+   }
+
+   return VM_SUCCESS;
+}
+
+/*
+ * Writes the value to the stream in the format of WRITE.
+ */
+static void vm_dprint(FILE *stream, vm_value_t *value)
+{
+   if(value->type == VM_TYPE_INT)
+      fprintf(stream, "%d", value->v.i);
+   else if(value->type == VM_TYPE_FLOAT)
+      fprintf(stream, "%g", value->v.f);
+   else if(value->type == VM_TYPE_BOOL)
+      fprintf(stream, "%s", value->v.b ? "true" : "false");
+   else
+      fwrite(value->v.s->data, 1, value->v.s->len, stream);
+}
+
+/*
+ * Frees run time state.
+ */
+static void vm_state_free(vm_state_t *state, int globals)
+{
+   for(int i = 0; i < state->stack_count; i++)
+      vm_release(&state->stack[i]);
+
+   for(int i = 0; i < globals && state->globals != NULL; i++)
+   {
+      if(state->defined[i])
+         vm_release(&state->globals[i]);
+   }
+
+   vm_frame_drop(state, state->tf);
+   while(state->lf != NULL)
+   {
+      vm_frame_t *next = state->lf->next;
+
+      vm_frame_drop(state, state->lf);
+      state->lf = next;
+   }
+   vm_frame_free(state->unused);
+
+   sfree(state->stack);
+   sfree(state->calls);
+   sfree(state->globals);
+   sfree(state->defined);
+   sfree(state->live);
+   sfree(state->line);
+}
+
+/* Stops the run with the error.  */
+#define VM_FAIL(code) do { state.error = (code); goto vm_error; } while(0)
+
+/* Checks result of a helper function.  */
+#define VM_CHECK(call) \
+   do { int vm_result = (call); if(vm_result) VM_FAIL(vm_result); } while(0)
+
+/* Gets slot of the variable of the operand.  */
+#define VM_VAR(slot, arg) \
+   do { if(((slot) = vm_var(&state, (arg))) == NULL) goto vm_error; } while(0)
+
+/* Gets value of the symbol of the operand.  */
+#define VM_SYMB(value, arg) \
+   do { if(((value) = vm_symb(&state, (arg))) == NULL) goto vm_error; } while(0)
+
+#ifdef VM_THREADED
+#define VM_OP(name) vm_op_##name:
+#define VM_NEXT() \
+   do { ins = &code[pc++]; steps_done++; goto *dispatch[ins->op]; } while(0)
+#else
+#define VM_OP(name) case VM_OP_##name:
+#define VM_NEXT() continue
+#endif
+
+int vm_run(vm_program_t *program, FILE *input, unsigned long *steps)
+{
+   vm_state_t state;
+   vm_instr_t *code = program->code;
+   vm_instr_t *ins = code;
+   vm_value_t *a, *b, *slot;
+   vm_value_t result;
+   unsigned long steps_done = 0;
+   int pc = 0;
+
+#ifdef VM_THREADED
+   static void *dispatch[VM_OP_COUNT] =
+   {
+      [VM_OP_HALT] = &&vm_op_HALT,
+      [VM_OP_MOVE] = &&vm_op_MOVE,
+      [VM_OP_CREATEFRAME] = &&vm_op_CREATEFRAME,
+      [VM_OP_PUSHFRAME] = &&vm_op_PUSHFRAME,
+      [VM_OP_POPFRAME] = &&vm_op_POPFRAME,
+      [VM_OP_DEFVAR] = &&vm_op_DEFVAR,
+      [VM_OP_CALL] = &&vm_op_CALL,
+      [VM_OP_RETURN] = &&vm_op_RETURN,
+      [VM_OP_PUSHS] = &&vm_op_PUSHS,
+      [VM_OP_POPS] = &&vm_op_POPS,
+      [VM_OP_CLEARS] = &&vm_op_CLEARS,
+      [VM_OP_ADD] = &&vm_op_ADD,
+      [VM_OP_SUB] = &&vm_op_SUB,
+      [VM_OP_MUL] = &&vm_op_MUL,
+      [VM_OP_DIV] = &&vm_op_DIV,
+      [VM_OP_LT] = &&vm_op_LT,
+      [VM_OP_GT] = &&vm_op_GT,
+      [VM_OP_EQ] = &&vm_op_EQ,
+      [VM_OP_AND] = &&vm_op_AND,
+      [VM_OP_OR] = &&vm_op_OR,
+      [VM_OP_NOT] = &&vm_op_NOT,
+      [VM_OP_INT2FLOAT] = &&vm_op_INT2FLOAT,
+      [VM_OP_FLOAT2INT] = &&vm_op_FLOAT2INT,
+      [VM_OP_FLOAT2R2EINT] = &&vm_op_FLOAT2R2EINT,
+      [VM_OP_FLOAT2R2OINT] = &&vm_op_FLOAT2R2OINT,
+      [VM_OP_INT2CHAR] = &&vm_op_INT2CHAR,
+      [VM_OP_STRI2INT] = &&vm_op_STRI2INT,
+      [VM_OP_READ] = &&vm_op_READ,
+      [VM_OP_WRITE] = &&vm_op_WRITE,
+      [VM_OP_CONCAT] = &&vm_op_CONCAT,
+      [VM_OP_STRLEN] = &&vm_op_STRLEN,
+      [VM_OP_GETCHAR] = &&vm_op_GETCHAR,
+      [VM_OP_SETCHAR] = &&vm_op_SETCHAR,
+      [VM_OP_TYPE] = &&vm_op_TYPE,
+      [VM_OP_JUMP] = &&vm_op_JUMP,
+      [VM_OP_JUMPIFEQ] = &&vm_op_JUMPIFEQ,
+      [VM_OP_JUMPIFNEQ] = &&vm_op_JUMPIFNEQ,
+      [VM_OP_BREAK] = &&vm_op_BREAK,
+      [VM_OP_DPRINT] = &&vm_op_DPRINT,
+      [VM_OP_ADDS] = &&vm_op_ADDS,
+      [VM_OP_SUBS] = &&vm_op_SUBS,
+      [VM_OP_MULS] = &&vm_op_MULS,
+      [VM_OP_DIVS] = &&vm_op_DIVS,
+      [VM_OP_LTS] = &&vm_op_LTS,
+      [VM_OP_GTS] = &&vm_op_GTS,
+      [VM_OP_EQS] = &&vm_op_EQS,
+      [VM_OP_ANDS] = &&vm_op_ANDS,
+      [VM_OP_ORS] = &&vm_op_ORS,
+      [VM_OP_NOTS] = &&vm_op_NOTS,
+      [VM_OP_INT2FLOATS] = &&vm_op_INT2FLOATS,
+      [VM_OP_FLOAT2INTS] = &&vm_op_FLOAT2INTS,
+      [VM_OP_FLOAT2R2EINTS] = &&vm_op_FLOAT2R2EINTS,
+      [VM_OP_FLOAT2R2OINTS] = &&vm_op_FLOAT2R2OINTS,
+      [VM_OP_INT2CHARS] = &&vm_op_INT2CHARS,
+      [VM_OP_STRI2INTS] = &&vm_op_STRI2INTS,
+      [VM_OP_JUMPIFEQS] = &&vm_op_JUMPIFEQS,
+      [VM_OP_JUMPIFNEQS] = &&vm_op_JUMPIFNEQS
+   };
+#endif
+
+   memset(&state, 0, sizeof(vm_state_t));
+   state.input = input;
+   state.error = VM_SUCCESS;
+   state.stack = smalloc(VM_INIT_SIZ * sizeof(vm_value_t));
+   state.stack_size = VM_INIT_SIZ;
+   state.calls = smalloc(VM_INIT_SIZ * sizeof(int));
+   state.calls_size = VM_INIT_SIZ;
+   state.globals = scalloc(program->globals.count + 1, sizeof(vm_value_t));
+   state.defined = scalloc(program->globals.count + 1, sizeof(bool));
+   state.live = scalloc(program->locals.count + 1, sizeof(int));
+
+   if(state.stack == NULL || state.calls == NULL || state.globals == NULL ||
+      state.defined == NULL || state.live == NULL)
+      VM_FAIL(VM_ERR_INTERNAL);
+
+#ifdef VM_THREADED
+   VM_NEXT();
+#else
+   for(;;)
+   {
+      ins = &code[pc++];
+      steps_done++;
+
+      switch(ins->op)
+      {
+#endif
+      VM_OP(MOVE)
+         VM_SYMB(a, &ins->args[1]);
+         VM_VAR(slot, &ins->args[0]);
+         vm_retain(a);
+         vm_store(slot, a);
+         VM_NEXT();
+
+      VM_OP(CREATEFRAME)
+         vm_frame_drop(&state, state.tf);
+         state.tf = vm_frame_new(&state);
+         if(state.tf == NULL)
+            VM_FAIL(VM_ERR_INTERNAL);
+         VM_NEXT();
+
+      VM_OP(PUSHFRAME)
+         if(state.tf == NULL)
+            VM_FAIL(VM_ERR_FRAME);
+
+         state.tf->next = state.lf;
+         state.lf = state.tf;
+         state.tf = NULL;
+         VM_NEXT();
+
+      VM_OP(POPFRAME)
+         if(state.lf == NULL)
+            VM_FAIL(VM_ERR_FRAME);
+
+         vm_frame_drop(&state, state.tf);
+         state.tf = state.lf;
+         state.lf = state.lf->next;
+         state.tf->next = NULL;
+         VM_NEXT();
+
+      VM_OP(DEFVAR)
+         VM_CHECK(vm_defvar(&state, &ins->args[0]));
+         VM_NEXT();
+
+      VM_OP(CALL)
+         if(state.calls_count == state.calls_size)
+         {
+            int *calls = srealloc(state.calls,
+                                  2 * state.calls_size * sizeof(int));
+            if(calls == NULL)
+               VM_FAIL(VM_ERR_INTERNAL);
+
+            state.calls = calls;
+            state.calls_size *= 2;
+         }
+
+         state.calls[state.calls_count++] = pc;
+         pc = ins->args[0].id;
+         VM_NEXT();
+
+      VM_OP(RETURN)
+         if(state.calls_count == 0)
+            VM_FAIL(VM_ERR_VALUE);
+
+         pc = state.calls[--state.calls_count];
+         VM_NEXT();
+
+      VM_OP(PUSHS)
+         VM_SYMB(a, &ins->args[0]);
+         vm_retain(a);
+         VM_CHECK(vm_push(&state, a));
+         VM_NEXT();
+
+      VM_OP(POPS)
+         if(state.stack_count == 0)
+            VM_FAIL(VM_ERR_VALUE);
+         VM_VAR(slot, &ins->args[0]);
+
+         vm_store(slot, &state.stack[--state.stack_count]);
+         VM_NEXT();
+
+      VM_OP(CLEARS)
+         while(state.stack_count > 0)
+            vm_release(&state.stack[--state.stack_count]);
+         VM_NEXT();
+
+      VM_OP(ADD)
+      VM_OP(SUB)
+      VM_OP(MUL)
+      VM_OP(DIV)
+      VM_OP(LT)
+      VM_OP(GT)
+      VM_OP(EQ)
+      VM_OP(AND)
+      VM_OP(OR)
+      VM_OP(STRI2INT)
+         VM_SYMB(a, &ins->args[1]);
+         VM_SYMB(b, &ins->args[2]);
+         VM_CHECK(vm_binary(ins->op, a, b, &result));
+         VM_VAR(slot, &ins->args[0]);
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(NOT)
+      VM_OP(INT2FLOAT)
+      VM_OP(FLOAT2INT)
+      VM_OP(FLOAT2R2EINT)
+      VM_OP(FLOAT2R2OINT)
+      VM_OP(INT2CHAR)
+         VM_SYMB(a, &ins->args[1]);
+         VM_CHECK(vm_unary(ins->op, a, &result));
+         VM_VAR(slot, &ins->args[0]);
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(READ)
+         VM_VAR(slot, &ins->args[0]);
+         emit_flush();
+         VM_CHECK(vm_read(&state, ins->args[1].id, &result));
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(WRITE)
+         VM_SYMB(a, &ins->args[0]);
+         if(a->type == VM_TYPE_INT)
+            emit_int(a->v.i);
+         else if(a->type == VM_TYPE_FLOAT)
+            emit_double(a->v.f);
+         else if(a->type == VM_TYPE_BOOL)
+            emit_string(a->v.b ? "true" : "false");
+         else
+            emit_data(a->v.s->data, a->v.s->len);
+         VM_NEXT();
+
+      VM_OP(CONCAT)
+         VM_SYMB(a, &ins->args[1]);
+         VM_SYMB(b, &ins->args[2]);
+         if(a->type != VM_TYPE_STRING || b->type != VM_TYPE_STRING)
+            VM_FAIL(VM_ERR_OPERAND);
+
+         result.type = VM_TYPE_STRING;
+         result.v.s = vm_string_new(a->v.s->len + b->v.s->len);
+         if(result.v.s == NULL)
+            VM_FAIL(VM_ERR_INTERNAL);
+
+         memcpy(result.v.s->data, a->v.s->data, a->v.s->len);
+         memcpy(result.v.s->data + a->v.s->len, b->v.s->data, b->v.s->len);
+         VM_VAR(slot, &ins->args[0]);
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(STRLEN)
+         VM_SYMB(a, &ins->args[1]);
+         if(a->type != VM_TYPE_STRING)
+            VM_FAIL(VM_ERR_OPERAND);
+
+         result.type = VM_TYPE_INT;
+         result.v.i = (int) a->v.s->len;
+         VM_VAR(slot, &ins->args[0]);
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(GETCHAR)
+         VM_SYMB(a, &ins->args[1]);
+         VM_SYMB(b, &ins->args[2]);
+         VM_CHECK(vm_stri2int(a, b, &result));
+
+         result.type = VM_TYPE_STRING;
+         result.v.s = vm_string_new(1);
+         if(result.v.s == NULL)
+            VM_FAIL(VM_ERR_INTERNAL);
+
+         result.v.s->data[0] = a->v.s->data[b->v.i];
+         VM_VAR(slot, &ins->args[0]);
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(SETCHAR)
+         VM_SYMB(slot, &ins->args[0]);
+         VM_SYMB(a, &ins->args[1]);
+         VM_SYMB(b, &ins->args[2]);
+         if(b->type != VM_TYPE_STRING)
+            VM_FAIL(VM_ERR_OPERAND);
+         VM_CHECK(vm_stri2int(slot, a, &result));
+         if(b->v.s->len == 0)
+            VM_FAIL(VM_ERR_STRING);
+
+         /* Shared string is copied before the change.  */
+         if(slot->v.s->refs > 1)
+         {
+            vm_string_t *copy = vm_string_new(slot->v.s->len);
+            if(copy == NULL)
+               VM_FAIL(VM_ERR_INTERNAL);
+
+            memcpy(copy->data, slot->v.s->data, slot->v.s->len);
+            slot->v.s->refs--;
+            slot->v.s = copy;
+         }
+
+         slot->v.s->data[a->v.i] = b->v.s->data[0];
+         VM_NEXT();
+
+      VM_OP(TYPE)
+         /* Variable without value has an empty type.  */
+         if(ins->args[1].kind == VM_ARG_CONST)
+            a = &ins->args[1].value;
+         else
+            VM_VAR(a, &ins->args[1]);
+
+         result.type = VM_TYPE_STRING;
+         result.v.s = vm_string_new(strlen(vm_type_names[a->type]));
+         if(result.v.s == NULL)
+            VM_FAIL(VM_ERR_INTERNAL);
+
+         strcpy(result.v.s->data, vm_type_names[a->type]);
+         VM_VAR(slot, &ins->args[0]);
+         vm_store(slot, &result);
+         VM_NEXT();
+
+      VM_OP(JUMP)
+         pc = ins->args[0].id;
+         VM_NEXT();
+
+      VM_OP(JUMPIFEQ)
+      VM_OP(JUMPIFNEQ)
+         VM_SYMB(a, &ins->args[1]);
+         VM_SYMB(b, &ins->args[2]);
+         VM_CHECK(vm_relation(VM_OP_EQ, a, b, &result));
+         if(result.v.b == (ins->op == VM_OP_JUMPIFEQ))
+            pc = ins->args[0].id;
+         VM_NEXT();
+
+      VM_OP(BREAK)
+         fprintf(stderr, "BREAK at line %d: %lu instructions executed, "
+                 "%d values on the data stack, %d calls\n", ins->line,
+                 steps_done, state.stack_count, state.calls_count);
+         VM_NEXT();
+
+      VM_OP(DPRINT)
+         VM_SYMB(a, &ins->args[0]);
+         vm_dprint(stderr, a);
+         VM_NEXT();
+
+      VM_OP(ADDS)
+      VM_OP(SUBS)
+      VM_OP(MULS)
+      VM_OP(DIVS)
+      VM_OP(LTS)
+      VM_OP(GTS)
+      VM_OP(EQS)
+      VM_OP(ANDS)
+      VM_OP(ORS)
+      VM_OP(STRI2INTS)
+         if(state.stack_count < 2)
+            VM_FAIL(VM_ERR_VALUE);
+
+         a = &state.stack[state.stack_count - 2];
+         b = &state.stack[state.stack_count - 1];
+         VM_CHECK(vm_binary(ins->op - VM_OP_STACK, a, b, &result));
+         vm_release(b);
+         vm_store(a, &result);
+         state.stack_count--;
+         VM_NEXT();
+
+      VM_OP(NOTS)
+      VM_OP(INT2FLOATS)
+      VM_OP(FLOAT2INTS)
+      VM_OP(FLOAT2R2EINTS)
+      VM_OP(FLOAT2R2OINTS)
+      VM_OP(INT2CHARS)
+         if(state.stack_count < 1)
+            VM_FAIL(VM_ERR_VALUE);
+
+         a = &state.stack[state.stack_count - 1];
+         VM_CHECK(vm_unary(ins->op - VM_OP_STACK, a, &result));
+         vm_store(a, &result);
+         VM_NEXT();
+
+      VM_OP(JUMPIFEQS)
+      VM_OP(JUMPIFNEQS)
+         if(state.stack_count < 2)
+            VM_FAIL(VM_ERR_VALUE);
+
+         a = &state.stack[state.stack_count - 2];
+         b = &state.stack[state.stack_count - 1];
+         VM_CHECK(vm_relation(VM_OP_EQ, a, b, &result));
+         vm_release(a);
+         vm_release(b);
+         state.stack_count -= 2;
+         if(result.v.b == (ins->op == VM_OP_JUMPIFEQS))
+            pc = ins->args[0].id;
+         VM_NEXT();
+
+      VM_OP(HALT)
+         /* The stopping instruction is not a part of the program.  */
+         steps_done--;
+         goto vm_end;
+#ifndef VM_THREADED
+      }
+   }
+#endif
+
+vm_error:
+   program->error_line = ins->line;
+
+vm_end:
+   if(steps != NULL)
+      *steps = steps_done;
+
+   vm_state_free(&state, program->globals.count);
+
+   return state.error;
+}
+
+void vm_free(vm_program_t *program)
+{
+   for(int i = 0; i < program->count; i++)
+   {
+      for(int j = 0; j < 3; j++)
+      {
+         if(program->code[i].args[j].kind == VM_ARG_CONST)
+            vm_release(&program->code[i].args[j].value);
+      }
+   }
+
+   sfree(program->code);
+   sfree(program->targets);
+   vm_names_free(&program->labels);
+   vm_names_free(&program->globals);
+   vm_names_free(&program->locals);
+   memset(program, 0, sizeof(vm_program_t));
+}
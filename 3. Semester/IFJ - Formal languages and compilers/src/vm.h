@@ -0,0 +1,181 @@
+/**
+ * @file vm.h
+ * @brief IFJcode17 virtual machine for IFJ Project 2017 AT vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Module executes IFJcode17 produced by the compiler.  Text of the program is
+ * parsed only once into an array of instructions with decoded operands.
+ * Labels are resolved to instruction indices and global variables to slots
+ * of the global frame before the execution.  Variables of local and
+ * temporary frames are identified by numbers of their names.  Every operand
+ * remembers the position, where its variable was found in the last frame,
+ * so the search is done only when the layout of the frame differs.
+ *
+ * Values are typed slots, strings are shared by reference counting and
+ * copied only when SETCHAR changes a shared one.  Instructions are executed
+ * by a threaded dispatch (computed goto) when compiled by GCC, by a switch
+ * otherwise.  Output of WRITE goes through the emit module.
+ */
+
+#ifndef VM_H_INCLUDED
+#define VM_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/** @brief Program was executed successfully.  */
+#define VM_SUCCESS 0
+
+/** @brief Wrong parameters of the virtual machine.  */
+#define VM_ERR_PARAMS 50
+
+/** @brief Lexical or syntax error of the IFJcode17 program.  */
+#define VM_ERR_SYNTAX 51
+
+/** @brief Semantic error of the program (labels, redefinitions).  */
+#define VM_ERR_SEMANTIC 52
+
+/** @brief Wrong types of operands.  */
+#define VM_ERR_OPERAND 53
+
+/** @brief Access to a variable which is not defined in its frame.  */
+#define VM_ERR_VARIABLE 54
+
+/** @brief Frame does not exist.  */
+#define VM_ERR_FRAME 55
+
+/** @brief Missing value (variable, data stack or call stack).  */
+#define VM_ERR_VALUE 56
+
+/** @brief Division by zero.  */
+#define VM_ERR_ZERO_DIV 57
+
+/** @brief Wrong work with a string.  */
+#define VM_ERR_STRING 58
+
+/** @brief Internal error of the virtual machine (allocation).  */
+#define VM_ERR_INTERNAL 60
+
+/** @brief Variable is defined, but it has no value yet.  */
+#define VM_TYPE_NONE 0
+
+/** @brief Integer value.  */
+#define VM_TYPE_INT 1
+
+/** @brief Floating point value.  */
+#define VM_TYPE_FLOAT 2
+
+/** @brief String value.  */
+#define VM_TYPE_STRING 3
+
+/** @brief Boolean value.  */
+#define VM_TYPE_BOOL 4
+
+/** @brief Initial size of the data stack, call stack and frames.  */
+#define VM_INIT_SIZ 64
+
+/** @brief Reference counted string, data are NUL terminated.  */
+typedef struct vm_string
+{
+   unsigned refs;             ///< Number of values sharing the string.
+   unsigned len;              ///< Length of the string.
+   char data[];               ///< Characters of the string.
+} vm_string_t;
+
+/** @brief Typed value slot.  */
+typedef struct vm_value
+{
+   int type;                  ///< One of VM_TYPE_ identifiers.
+   union vm_data
+   {
+      int i;                  ///< Integer value.
+      double f;               ///< Floating point value.
+      bool b;                 ///< Boolean value.
+      vm_string_t *s;         ///< String value.
+   } v;
+} vm_value_t;
+
+/** @brief Decoded operand of an instruction.  */
+typedef struct vm_arg
+{
+   int kind;                  ///< Constant, variable of a frame, label, type.
+   int id;                    ///< Name number, global slot, target or type.
+   int slot;                  ///< Position of the variable in the last frame.
+   vm_value_t value;          ///< Value of a constant.
+} vm_arg_t;
+
+/** @brief Decoded instruction.  */
+typedef struct vm_instr
+{
+   int op;                    ///< Operation code.
+   int line;                  ///< Line of the instruction in the source.
+   vm_arg_t args[3];          ///< Operands.
+} vm_instr_t;
+
+/** @brief Table of names, which gives every distinct name its number.  */
+typedef struct vm_names
+{
+   char **keys;               ///< Open addressing table of names.
+   int *ids;                  ///< Numbers of the names in keys.
+   int size;                  ///< Number of slots, power of 2.
+   int count;                 ///< Number of stored names.
+} vm_names_t;
+
+/** @brief Frame of variables.  */
+typedef struct vm_frame
+{
+   int *ids;                  ///< Name numbers of the defined variables.
+   vm_value_t *values;        ///< Values of the variables.
+   int count;                 ///< Number of defined variables.
+   int size;                  ///< Allocated size of ids and values.
+   struct vm_frame *next;     ///< Frame below in the stack or free list.
+} vm_frame_t;
+
+/** @brief Loaded program.  */
+typedef struct vm_program
+{
+   vm_instr_t *code;          ///< Instructions, the last one stops the run.
+   int count;                 ///< Number of instructions.
+   int size;                  ///< Allocated size of code.
+   vm_names_t labels;         ///< Names of labels.
+   vm_names_t globals;        ///< Names of variables of the global frame.
+   vm_names_t locals;         ///< Names of variables of other frames.
+   int *targets;              ///< Instruction index of every label or -1.
+   int targets_size;          ///< Allocated size of targets.
+   int error_line;            ///< Line of the last error, 0 if unknown.
+} vm_program_t;
+
+/**
+ * @brief Loads IFJcode17 program.  Program has to start with the .IFJcode17
+ *        header, every instruction is on its own line, # starts a comment.
+ *
+ * @param *program Program to be initialized.
+ * @param *source Stream with the text of the program.
+ * @return VM_SUCCESS, VM_ERR_SYNTAX for malformed lines, VM_ERR_SEMANTIC for
+ *         undefined or redefined labels or VM_ERR_INTERNAL.  Line of the
+ *         error is stored to program->error_line.
+ */
+int vm_load(vm_program_t *program, FILE *source);
+
+/**
+ * @brief Executes loaded program.  Output is written by the emit module,
+ *        which has to be opened by the caller.
+ *
+ * @param *program Program loaded by vm_load().
+ * @param *input Stream read by READ instructions.
+ * @param *steps Number of executed instructions is stored here, can be NULL.
+ * @return VM_SUCCESS or the error code of the run.  Line of the failed
+ *         instruction is stored to program->error_line.
+ */
+int vm_run(vm_program_t *program, FILE *input, unsigned long *steps);
+
+/**
+ * @brief Frees the program.
+ *
+ * @param *program Program loaded by vm_load().
+ * @return void.
+ */
+void vm_free(vm_program_t *program);
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file vm_main.c
+ * @brief Main file of IFJcode17 virtual machine for IFJ Project 2017 AT
+ *        vut.fit.vutbr.cz.
+ * @date 17.10.2026
+ * @author Goldschmidt Patrik - xgolds00@stud.fit.vutbr.cz
+ *
+ * Program loads IFJcode17 produced by the compiler and executes it.  Input of
+ * the executed program is read from stdin, its output is written to stdout.
+ * Exit code of the virtual machine is the error code of the run.
+ */
+
+/*    Includes section   */
+#include "emit.h"
+#include "safe_malloc.h"
+#include "vm.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/**   @brief Defines option printing the number of executed instructions.   */
+#define ARG_COUNT "-c"
+
+/**   @brief Defines info/error message on incorrect params run.  */
+#define USAGE \
+"./ifj17vm - IFJcode17 virtual machine. Program loads IFJcode17 from the \
+           given file and executes it, input of the program is read from \
+           stdin.  Option -c prints the number of executed instructions \
+           to stderr. \
+Example run: \
+./ifj17vm -c output.ifjc < input.txt\n"
+
+int main(int argc, char **argv)
+{
+   vm_program_t program;
+   unsigned long steps = 0;
+   bool count = false;
+   char *path = NULL;
+   int result;
+
+   /* Check correct program run. */
+   for(int i = 1; i < argc; i++)
+   {
+      if(!strcmp(argv[i], ARG_COUNT))
+         count = true;
+      else if(path == NULL)
+         path = argv[i];
+      else
+         path = "";
+   }
+
+   if(path == NULL || *path == '\0')
+   {
+      fprintf(stderr, USAGE);
+      return VM_ERR_PARAMS;
+   }
+
+   FILE *source = fopen(path, "r");
+   if(source == NULL)
+   {
+      fprintf(stderr, "ifj17vm: cannot open %s\n", path);
+      return VM_ERR_PARAMS;
+   }
+
+   memman_init();
+   result = vm_load(&program, source);
+   fclose(source);
+
+   if(result == VM_SUCCESS)
+   {
+      if(emit_open(NULL) != EMIT_SUCCESS)
+         result = VM_ERR_INTERNAL;
+      else
+      {
+         result = vm_run(&program, stdin, &steps);
+         if(emit_close() != EMIT_SUCCESS && result == VM_SUCCESS)
+            result = VM_ERR_INTERNAL;
+      }
+   }
+
+   if(result != VM_SUCCESS)
+      fprintf(stderr, "ifj17vm: error %d at line %d\n", result,
+              program.error_line);
+   if(count)
+      fprintf(stderr, "steps %lu\n", steps);
+
+   vm_free(&program);
+   memman_free_all();
+
+   return result;
+}